@@ -3,7 +3,11 @@ require 'mxx_ru/cpp'
 
 MxxRu::Cpp::composite_target( MxxRu::BUILD_ROOT ) {
 
-	toolset.force_cpp17
+	if 'cpp20' == ENV.fetch( 'SO5EXTRA_CPP_STD', 'cpp17' )
+		toolset.force_cpp20
+	else
+		toolset.force_cpp17
+	end
 	global_include_path "."
 
 	if 'gcc' == toolset.name
@@ -0,0 +1,967 @@
+/*!
+ * \file
+ * \brief C++20 coroutines support for agents.
+ *
+ * \note
+ * This module requires C++20 with coroutines support. The rest of
+ * so5extra still requires C++17 only.
+ *
+ * \since v.1.7.0
+ */
+
+#pragma once
+
+#if !defined(__cpp_impl_coroutine) || __cpp_impl_coroutine < 201902L
+	#error "so_5_extra/coroutines/pub.hpp requires C++20 with coroutines support"
+#endif
+
+#include <so_5_extra/sync/async_ask.hpp>
+
+#include <so_5_extra/async_op/time_limited.hpp>
+
+#include <so_5/details/rollback_on_exception.hpp>
+
+#include <so_5/agent.hpp>
+
+#include <array>
+#include <chrono>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace so_5 {
+
+namespace extra {
+
+namespace coroutines {
+
+class frame_pool_t;
+
+namespace details {
+
+class frame_pool_impl_t;
+
+//
+// frame_header_t
+//
+/*!
+ * \brief A header that precedes every coroutine frame.
+ *
+ * It allows to return the frame to the right pool (if any).
+ *
+ * \since v.1.7.0
+ */
+struct alignas(__STDCPP_DEFAULT_NEW_ALIGNMENT__) frame_header_t
+	{
+		//! The pool for the frame.
+		/*!
+		 * It is nullptr if the frame is allocated in the heap.
+		 */
+		frame_pool_impl_t * m_pool;
+
+		//! Index of size class of the frame.
+		std::size_t m_size_class;
+	};
+
+//! Granularity of sizes of blocks in the frame pool.
+constexpr std::size_t frame_block_granularity = 64u;
+
+//! Max size of a block (including the header) to be held in the frame pool.
+/*!
+ * Bigger frames are allocated in the heap.
+ */
+constexpr std::size_t max_pooled_block_size = 4096u;
+
+//! Count of size classes in the frame pool.
+constexpr std::size_t frame_size_classes =
+		max_pooled_block_size / frame_block_granularity;
+
+//
+// frame_pool_impl_t
+//
+/*!
+ * \brief Actual implementation of the frame pool.
+ *
+ * Released blocks are kept in free lists (one list for every size class)
+ * and are reused by subsequent coroutines of the same agent.
+ *
+ * The implementation is protected by a mutex because a suspended coroutine
+ * can be destroyed outside of the agent's working context (for example
+ * during the deregistration of the agent). But the mutex is almost always
+ * uncontended.
+ *
+ * The object is destroyed when the owner is destroyed and there is no
+ * more live frames.
+ *
+ * \since v.1.7.0
+ */
+class frame_pool_impl_t
+	{
+		//! An item of a free list.
+		struct free_block_t
+			{
+				free_block_t * m_next;
+			};
+
+		//! Lock for the pool.
+		std::mutex m_lock;
+
+		//! Heads of free lists.
+		std::array< free_block_t *, frame_size_classes > m_free_lists{};
+
+		//! Count of frames those are not returned to the pool yet.
+		std::size_t m_live_frames{ 0u };
+
+		//! Is the owner of the pool still alive?
+		bool m_owner_alive{ true };
+
+		~frame_pool_impl_t() noexcept
+			{
+				for( auto * head : m_free_lists )
+					while( head )
+						{
+							auto * next = head->m_next;
+							::operator delete( head );
+							head = next;
+						}
+			}
+
+		//! Should the pool be destroyed?
+		/*!
+		 * \attention
+		 * Should be called when m_lock is acquired.
+		 */
+		[[nodiscard]]
+		bool
+		is_unused() const noexcept
+			{
+				return !m_owner_alive && 0u == m_live_frames;
+			}
+
+	public :
+		frame_pool_impl_t() = default;
+
+		frame_pool_impl_t( const frame_pool_impl_t & ) = delete;
+		frame_pool_impl_t & operator=( const frame_pool_impl_t & ) = delete;
+
+		//! Get a block of the size class.
+		[[nodiscard]]
+		void *
+		allocate( std::size_t size_class )
+			{
+				{
+					std::lock_guard< std::mutex > lock{ m_lock };
+					auto *& head = m_free_lists[ size_class ];
+					if( head )
+						{
+							auto * block = head;
+							head = block->m_next;
+							++m_live_frames;
+							return block;
+						}
+				}
+
+				void * block = ::operator new(
+						(size_class + 1u) * frame_block_granularity );
+
+				std::lock_guard< std::mutex > lock{ m_lock };
+				++m_live_frames;
+				return block;
+			}
+
+		//! Return a block to the pool.
+		/*!
+		 * The pool can be destroyed inside this call.
+		 */
+		static void
+		deallocate(
+			frame_pool_impl_t * pool,
+			void * block,
+			std::size_t size_class ) noexcept
+			{
+				bool should_be_destroyed;
+				{
+					std::lock_guard< std::mutex > lock{ pool->m_lock };
+					auto *& head = pool->m_free_lists[ size_class ];
+					head = ::new( block ) free_block_t{ head };
+					--(pool->m_live_frames);
+					should_be_destroyed = pool->is_unused();
+				}
+
+				if( should_be_destroyed )
+					delete pool;
+			}
+
+		//! Inform the pool that its owner is destroyed.
+		/*!
+		 * The pool can be destroyed inside this call.
+		 */
+		static void
+		owner_destroyed( frame_pool_impl_t * pool ) noexcept
+			{
+				bool should_be_destroyed;
+				{
+					std::lock_guard< std::mutex > lock{ pool->m_lock };
+					pool->m_owner_alive = false;
+					should_be_destroyed = pool->is_unused();
+				}
+
+				if( should_be_destroyed )
+					delete pool;
+			}
+	};
+
+//
+// allocate_frame
+//
+/*!
+ * \brief Allocate memory for a coroutine frame.
+ *
+ * The frame is allocated from \a pool if \a pool is not nullptr and
+ * the frame is not too big. Otherwise the frame is allocated in the heap.
+ *
+ * \since v.1.7.0
+ */
+[[nodiscard]]
+inline void *
+allocate_frame( frame_pool_impl_t * pool, std::size_t size )
+	{
+		const std::size_t total = sizeof( frame_header_t ) + size;
+
+		void * block;
+		std::size_t size_class = 0u;
+		if( pool && total <= max_pooled_block_size )
+			{
+				size_class = (total - 1u) / frame_block_granularity;
+				block = pool->allocate( size_class );
+			}
+		else
+			{
+				pool = nullptr;
+				block = ::operator new( total );
+			}
+
+		auto * header = ::new( block ) frame_header_t{ pool, size_class };
+		return header + 1;
+	}
+
+//
+// deallocate_frame
+//
+/*!
+ * \brief Release memory of a coroutine frame.
+ *
+ * \since v.1.7.0
+ */
+inline void
+deallocate_frame( void * frame ) noexcept
+	{
+		auto * header = static_cast< frame_header_t * >( frame ) - 1;
+		auto * pool = header->m_pool;
+		const auto size_class = header->m_size_class;
+		header->~frame_header_t();
+
+		if( pool )
+			frame_pool_impl_t::deallocate( pool, header, size_class );
+		else
+			::operator delete( header );
+	}
+
+//
+// frame_pool_accessor_t
+//
+/*!
+ * \brief A helper for access to the implementation of frame_pool_t.
+ *
+ * \since v.1.7.0
+ */
+struct frame_pool_accessor_t
+	{
+		[[nodiscard]]
+		static frame_pool_impl_t *
+		impl( frame_pool_t & pool ) noexcept;
+	};
+
+} /* namespace details */
+
+//
+// frame_pool_t
+//
+/*!
+ * \brief A pool for frames of agent's coroutines.
+ *
+ * An agent should be derived from frame_pool_t (as a public base) to
+ * have a frame pool. A frame for a coroutine is taken from the pool if
+ * the first argument of the coroutine is a reference to such an agent
+ * (it is always true for coroutines those are non-static methods of
+ * the agent):
+ * \code
+ * class my_agent final
+ * 	: public so_5::agent_t
+ * 	, public so_5::extra::coroutines::frame_pool_t
+ * {
+ * 	...
+ * 	// The frame is allocated from the agent's frame pool.
+ * 	so_5::extra::coroutines::task_t handle_login(login cmd) {...}
+ * };
+ * \endcode
+ *
+ * Frames of finished coroutines are returned to the pool and are reused
+ * by subsequent coroutines. So there is no heap allocation for a coroutine
+ * frame after a warm-up. Frames bigger than 4KiB are allocated in the heap.
+ *
+ * Memory of the pool is released when the agent is destroyed and all
+ * frames are returned to the pool.
+ *
+ * \since v.1.7.0
+ */
+class frame_pool_t
+	{
+		friend struct details::frame_pool_accessor_t;
+
+		//! The actual pool.
+		details::frame_pool_impl_t * m_impl;
+
+	public :
+		frame_pool_t()
+			:	m_impl{ new details::frame_pool_impl_t{} }
+			{}
+
+		frame_pool_t( const frame_pool_t & ) = delete;
+		frame_pool_t & operator=( const frame_pool_t & ) = delete;
+
+		~frame_pool_t() noexcept
+			{
+				details::frame_pool_impl_t::owner_destroyed( m_impl );
+			}
+	};
+
+namespace details {
+
+inline frame_pool_impl_t *
+frame_pool_accessor_t::impl( frame_pool_t & pool ) noexcept
+	{
+		return pool.m_impl;
+	}
+
+} /* namespace details */
+
+//
+// task_t
+//
+/*!
+ * \brief Type of agent's coroutine.
+ *
+ * A coroutine that returns task_t is not started automatically, it has
+ * to be started by so_5::extra::coroutines::start(). Because of that
+ * a coroutine is usually started from an event handler of an agent:
+ * \code
+ * namespace coro_ns = so_5::extra::coroutines;
+ *
+ * class frontend final
+ * 	: public so_5::agent_t
+ * 	, public coro_ns::frame_pool_t
+ * {
+ * 	...
+ * 	void on_login(mhood_t<login> cmd) {
+ * 		coro_ns::start( handle_login( *cmd ) );
+ * 	}
+ *
+ * 	coro_ns::task_t handle_login(login cmd) {
+ * 		auto r = co_await coro_ns::ask<check_user_request, check_user_result>(
+ * 				*this, users_service_mbox_, 5s, cmd.m_user, cmd.m_password );
+ * 		if(!r) {
+ * 			... // There is no reply.
+ * 			co_return;
+ * 		}
+ * 		auto profile = co_await coro_ns::receive<user_profile>(
+ * 				*this, profiles_mbox_, 1s );
+ * 		...
+ * 	}
+ * };
+ * \endcode
+ *
+ * A coroutine is resumed from event handlers of the agent only. It means
+ * that the body of the coroutine is always executed on the agent's working
+ * context and doesn't need any synchronization with other event handlers.
+ *
+ * An exception from the coroutine body is thrown out of the event handler
+ * that resumed the coroutine (or out of start()). So it is handled
+ * by the agent's exception reaction.
+ *
+ * If a suspended coroutine can't be resumed anymore (for example if
+ * the agent is deregistered) then the coroutine is destroyed.
+ *
+ * \attention
+ * A task_t can't be co_await-ed. Only awaitables from
+ * so_5::extra::coroutines can be used inside task_t coroutines.
+ *
+ * \since v.1.7.0
+ */
+class task_t
+	{
+	public :
+		class promise_type
+			{
+				friend class task_t;
+
+				//! An exception from the coroutine body.
+				std::exception_ptr m_exception;
+
+			public :
+				//! Allocation of the frame from the agent's pool.
+				template< typename First, typename... Rest >
+				[[nodiscard]]
+				static void *
+				operator new( std::size_t size, First & first, Rest & ... )
+					{
+						if constexpr( std::is_base_of_v<
+								frame_pool_t, std::remove_cv_t< First > > )
+							return details::allocate_frame(
+									details::frame_pool_accessor_t::impl(
+											const_cast< frame_pool_t & >(
+													static_cast< const frame_pool_t & >( first ) ) ),
+									size );
+						else
+							return details::allocate_frame( nullptr, size );
+					}
+
+				//! Allocation of the frame for a coroutine without arguments.
+				[[nodiscard]]
+				static void *
+				operator new( std::size_t size )
+					{
+						return details::allocate_frame( nullptr, size );
+					}
+
+				static void
+				operator delete( void * frame ) noexcept
+					{
+						details::deallocate_frame( frame );
+					}
+
+				[[nodiscard]]
+				task_t
+				get_return_object() noexcept
+					{
+						return task_t{
+								std::coroutine_handle< promise_type >::from_promise( *this )
+							};
+					}
+
+				[[nodiscard]]
+				std::suspend_always
+				initial_suspend() const noexcept { return {}; }
+
+				[[nodiscard]]
+				std::suspend_always
+				final_suspend() const noexcept { return {}; }
+
+				void
+				return_void() const noexcept {}
+
+				void
+				unhandled_exception() noexcept
+					{
+						m_exception = std::current_exception();
+					}
+			};
+
+		//! Type of handle for task_t coroutine.
+		using handle_t = std::coroutine_handle< promise_type >;
+
+		task_t( const task_t & ) = delete;
+		task_t & operator=( const task_t & ) = delete;
+
+		task_t( task_t && other ) noexcept
+			:	m_handle{ std::exchange( other.m_handle, handle_t{} ) }
+			{}
+
+		task_t &
+		operator=( task_t && other ) noexcept
+			{
+				task_t tmp{ std::move(other) };
+				std::swap( m_handle, tmp.m_handle );
+				return *this;
+			}
+
+		//! The coroutine is destroyed if it isn't started.
+		~task_t() noexcept
+			{
+				if( m_handle )
+					m_handle.destroy();
+			}
+
+		//! Run the coroutine until the next suspension point.
+		/*!
+		 * The coroutine is destroyed if it is finished. An exception from
+		 * the coroutine body is rethrown in that case.
+		 */
+		static void
+		resume( handle_t handle )
+			{
+				handle.resume();
+				if( handle.done() )
+					{
+						auto ex = std::move( handle.promise().m_exception );
+						handle.destroy();
+						if( ex )
+							std::rethrow_exception( ex );
+					}
+			}
+
+		//! Take the ownership of the coroutine.
+		[[nodiscard]]
+		handle_t
+		release() noexcept
+			{
+				return std::exchange( m_handle, handle_t{} );
+			}
+
+	private :
+		//! The coroutine.
+		handle_t m_handle;
+
+		explicit task_t( handle_t handle ) noexcept
+			:	m_handle{ handle }
+			{}
+	};
+
+//
+// start
+//
+/*!
+ * \brief Start a coroutine.
+ *
+ * The coroutine is executed until the first suspension point inside
+ * this call.
+ *
+ * \since v.1.7.0
+ */
+inline void
+start( task_t task )
+	{
+		task_t::resume( task.release() );
+	}
+
+namespace details {
+
+//
+// resume_point_t
+//
+/*!
+ * \brief A place for the result of co_await and the suspended coroutine.
+ *
+ * An instance is shared between handlers of an async operation. The
+ * coroutine is resumed when one of handlers is called. If the instance is
+ * destroyed without resumption of the coroutine (the async operation will
+ * never be finished) then the coroutine is destroyed.
+ *
+ * \since v.1.7.0
+ */
+template< typename Result >
+class resume_point_t
+	{
+		//! The suspended coroutine.
+		task_t::handle_t m_handle;
+
+		//! The result of co_await.
+		std::optional< Result > m_result;
+
+	public :
+		explicit resume_point_t( task_t::handle_t handle ) noexcept
+			:	m_handle{ handle }
+			{}
+
+		resume_point_t( const resume_point_t & ) = delete;
+		resume_point_t & operator=( const resume_point_t & ) = delete;
+
+		~resume_point_t() noexcept
+			{
+				if( m_handle )
+					m_handle.destroy();
+			}
+
+		//! The coroutine won't be resumed nor destroyed by this object.
+		void
+		disarm() noexcept
+			{
+				m_handle = task_t::handle_t{};
+			}
+
+		//! Store the result and resume the coroutine.
+		static void
+		resume(
+			const std::shared_ptr< resume_point_t > & point,
+			std::optional< Result > result )
+			{
+				// The point should live until the coroutine takes the result
+				// even if handlers of the async operation are destroyed.
+				const auto self = point;
+				if( !self->m_handle )
+					return;
+
+				self->m_result = std::move(result);
+				task_t::resume( std::exchange( self->m_handle, task_t::handle_t{} ) );
+			}
+
+		//! Get the result of co_await.
+		[[nodiscard]]
+		std::optional< Result >
+		take_result() noexcept( std::is_nothrow_move_constructible_v< Result > )
+			{
+				return std::move(m_result);
+			}
+	};
+
+//
+// receive_timeout_t
+//
+/*!
+ * \brief A signal to be used as timeout signal for receive.
+ *
+ * \since v.1.7.0
+ */
+struct receive_timeout_t final : public so_5::signal_t {};
+
+} /* namespace details */
+
+//
+// ask_awaitable_t
+//
+/*!
+ * \brief An awaitable for a request to be sent by so_5::extra::sync::async_ask.
+ *
+ * Instances of this type are created by so_5::extra::coroutines::ask().
+ *
+ * \since v.1.7.0
+ */
+template<
+	typename Request, typename Reply,
+	typename Target, typename... Args >
+class ask_awaitable_t
+	{
+		using reply_t = typename so_5::extra::sync::request_reply_t<
+				Request, Reply >::reply_t;
+
+		using resume_point_type = details::resume_point_t< reply_t >;
+
+		agent_t & m_owner;
+		const state_t & m_state;
+		const Target m_target;
+		const std::chrono::steady_clock::duration m_timeout;
+
+		//! Arguments for the construction of Request.
+		std::tuple< Args... > m_args;
+
+		//! The place for the reply.
+		/*!
+		 * It is alive while the coroutine is being resumed.
+		 */
+		resume_point_type * m_resume_point{ nullptr };
+
+	public :
+		template< typename... Actual_Args >
+		ask_awaitable_t(
+			agent_t & owner,
+			const state_t & state,
+			Target target,
+			std::chrono::steady_clock::duration timeout,
+			Actual_Args && ...args )
+			:	m_owner{ owner }
+			,	m_state{ state }
+			,	m_target{ std::move(target) }
+			,	m_timeout{ timeout }
+			,	m_args{ std::forward< Actual_Args >( args )... }
+			{}
+
+		[[nodiscard]]
+		bool
+		await_ready() const noexcept { return false; }
+
+		void
+		await_suspend( task_t::handle_t handle )
+			{
+				auto point = std::make_shared< resume_point_type >( handle );
+
+				so_5::details::do_with_rollback_on_exception(
+						[&] {
+							std::apply(
+									[&]( auto & ...args ) {
+										so_5::extra::sync::async_ask< Request, Reply >(
+												m_owner,
+												m_state,
+												m_target,
+												m_timeout,
+												[point]( std::optional< reply_t > reply ) {
+													resume_point_type::resume(
+															point, std::move(reply) );
+												},
+												std::move(args)... );
+									},
+									m_args );
+						},
+						// The coroutine will be resumed with an exception.
+						[&point] { point->disarm(); } );
+
+				m_resume_point = point.get();
+			}
+
+		[[nodiscard]]
+		std::optional< reply_t >
+		await_resume()
+			{
+				return m_resume_point->take_result();
+			}
+	};
+
+//
+// ask
+//
+/*!
+ * \brief Issue a request and wait for the reply inside a coroutine.
+ *
+ * The request is sent by so_5::extra::sync::async_ask(). The coroutine
+ * is resumed when the reply arrives (or the \a timeout elapses) by an event
+ * handler of \a owner in the \a state.
+ *
+ * The result of co_await is std::optional<Reply>. It is empty if there is
+ * no reply.
+ *
+ * Usage example:
+ * \code
+ * std::optional<check_user_result> r =
+ * 	co_await so_5::extra::coroutines::ask<check_user_request, check_user_result>(
+ * 		*this, so_default_state(), users_service_mbox_, 5s, user, password );
+ * \endcode
+ *
+ * \attention
+ * The \a owner should stay in the \a state while the coroutine is
+ * suspended. Otherwise the coroutine won't be resumed.
+ *
+ * \since v.1.7.0
+ */
+template<
+	typename Request, typename Reply,
+	typename Target, typename... Args >
+[[nodiscard]]
+auto
+ask(
+	//! The agent that runs the coroutine.
+	agent_t & owner,
+	//! The state in that the reply should be handled.
+	const state_t & state,
+	//! The destination for the request.
+	Target && target,
+	//! Max time to wait for the reply.
+	std::chrono::steady_clock::duration timeout,
+	//! Arguments for the construction of Request.
+	Args && ...args )
+	{
+		return ask_awaitable_t<
+						Request, Reply,
+						std::decay_t< Target >,
+						std::decay_t< Args >... >{
+				owner,
+				state,
+				std::forward< Target >( target ),
+				timeout,
+				std::forward< Args >( args )... };
+	}
+
+//
+// ask
+//
+/*!
+ * \brief Issue a request and wait for the reply inside a coroutine
+ * in the default state of the agent.
+ *
+ * The same as ask(owner, owner.so_default_state(), target, ...).
+ *
+ * \since v.1.7.0
+ */
+template<
+	typename Request, typename Reply,
+	typename Target, typename... Args >
+[[nodiscard]]
+auto
+ask(
+	//! The agent that runs the coroutine.
+	agent_t & owner,
+	//! The destination for the request.
+	Target && target,
+	//! Max time to wait for the reply.
+	std::chrono::steady_clock::duration timeout,
+	//! Arguments for the construction of Request.
+	Args && ...args )
+	{
+		return ask< Request, Reply >(
+				owner,
+				owner.so_default_state(),
+				std::forward< Target >( target ),
+				timeout,
+				std::forward< Args >( args )... );
+	}
+
+//
+// receive_awaitable_t
+//
+/*!
+ * \brief An awaitable for a message to be received by a time-limited
+ * async operation.
+ *
+ * Instances of this type are created by so_5::extra::coroutines::receive().
+ *
+ * \since v.1.7.0
+ */
+template< typename Msg >
+class receive_awaitable_t
+	{
+		using resume_point_type = details::resume_point_t< mhood_t< Msg > >;
+
+		agent_t & m_owner;
+		const state_t & m_state;
+		const mbox_t m_from;
+		const std::chrono::steady_clock::duration m_timeout;
+
+		//! The place for the message.
+		/*!
+		 * It is alive while the coroutine is being resumed.
+		 */
+		resume_point_type * m_resume_point{ nullptr };
+
+	public :
+		receive_awaitable_t(
+			agent_t & owner,
+			const state_t & state,
+			mbox_t from,
+			std::chrono::steady_clock::duration timeout )
+			:	m_owner{ owner }
+			,	m_state{ state }
+			,	m_from{ std::move(from) }
+			,	m_timeout{ timeout }
+			{}
+
+		[[nodiscard]]
+		bool
+		await_ready() const noexcept { return false; }
+
+		void
+		await_suspend( task_t::handle_t handle )
+			{
+				auto point = std::make_shared< resume_point_type >( handle );
+
+				so_5::details::do_with_rollback_on_exception(
+						[&] {
+							so_5::extra::async_op::time_limited::make<
+											details::receive_timeout_t >( m_owner )
+									.completed_on( m_from, m_state,
+										[point]( mhood_t< Msg > cmd ) {
+											resume_point_type::resume( point, std::move(cmd) );
+										} )
+									.timeout_handler( m_state,
+										[point]( mhood_t< details::receive_timeout_t > ) {
+											resume_point_type::resume( point, std::nullopt );
+										} )
+									.activate( m_timeout );
+						},
+						// The coroutine will be resumed with an exception.
+						[&point] { point->disarm(); } );
+
+				m_resume_point = point.get();
+			}
+
+		[[nodiscard]]
+		std::optional< mhood_t< Msg > >
+		await_resume()
+			{
+				return m_resume_point->take_result();
+			}
+	};
+
+//
+// receive
+//
+/*!
+ * \brief Wait for a message inside a coroutine.
+ *
+ * The waiting is performed by so_5::extra::async_op::time_limited
+ * operation. The coroutine is resumed when a message of type Msg arrives
+ * to \a from (or the \a timeout elapses) by an event handler of \a owner
+ * in the \a state.
+ *
+ * The result of co_await is std::optional<mhood_t<Msg>>. It is empty
+ * if there is no message.
+ *
+ * Usage example:
+ * \code
+ * auto ack = co_await so_5::extra::coroutines::receive<transfer_ack>(
+ * 		*this, so_default_state(), so_direct_mbox(), 1s );
+ * if(ack) {
+ * 	... // Handle (*ack)->m_transfer_id
+ * }
+ * \endcode
+ *
+ * \attention
+ * The \a owner should stay in the \a state while the coroutine is
+ * suspended. Otherwise the coroutine won't be resumed.
+ *
+ * \attention
+ * The owner can't have another subscription for Msg from \a from in
+ * the \a state while the coroutine is suspended.
+ *
+ * \since v.1.7.0
+ */
+template< typename Msg >
+[[nodiscard]]
+receive_awaitable_t< Msg >
+receive(
+	//! The agent that runs the coroutine.
+	agent_t & owner,
+	//! The state in that the message should be handled.
+	const state_t & state,
+	//! The source of the message.
+	mbox_t from,
+	//! Max time to wait for the message.
+	std::chrono::steady_clock::duration timeout )
+	{
+		return { owner, state, std::move(from), timeout };
+	}
+
+//
+// receive
+//
+/*!
+ * \brief Wait for a message inside a coroutine in the default state
+ * of the agent.
+ *
+ * The same as receive(owner, owner.so_default_state(), from, timeout).
+ *
+ * \since v.1.7.0
+ */
+template< typename Msg >
+[[nodiscard]]
+receive_awaitable_t< Msg >
+receive(
+	//! The agent that runs the coroutine.
+	agent_t & owner,
+	//! The source of the message.
+	mbox_t from,
+	//! Max time to wait for the message.
+	std::chrono::steady_clock::duration timeout )
+	{
+		return { owner, owner.so_default_state(), std::move(from), timeout };
+	}
+
+} /* namespace coroutines */
+
+} /* namespace extra */
+
+} /* namespace so_5 */
@@ -0,0 +1,76 @@
+/*!
+ * \file
+ * \brief A helper for getting the actual payload from an enveloped message.
+ *
+ * \since v.1.7.0
+ */
+
+#pragma once
+
+#include <so_5/enveloped_msg.hpp>
+
+namespace so_5 {
+
+namespace extra {
+
+namespace enveloped_msg {
+
+namespace impl {
+
+/*!
+ * \brief Helper for getting the actual payload from an enveloped message.
+ *
+ * \since v.1.7.0
+ */
+class payload_extractor_t final
+	: public ::so_5::enveloped_msg::handler_invoker_t
+	{
+		//! Extracted payload.
+		/*!
+		 * Will be empty if payload is not available.
+		 */
+		message_ref_t m_payload;
+
+	public:
+		void
+		invoke( const ::so_5::enveloped_msg::payload_info_t & payload )
+			noexcept override
+			{
+				m_payload = payload.message();
+			}
+
+		/*!
+		 * \brief Get the actual payload of a message.
+		 *
+		 * Nested envelopes are handled too.
+		 *
+		 * \return nullptr if the payload isn't available (for example,
+		 * if the message is revoked).
+		 */
+		[[nodiscard]]
+		static message_ref_t
+		extract( message_ref_t msg )
+			{
+				while( msg &&
+						message_t::kind_t::enveloped_msg == message_kind( msg ) )
+					{
+						payload_extractor_t extractor;
+						static_cast< ::so_5::enveloped_msg::envelope_t & >( *msg )
+							.access_hook(
+									::so_5::enveloped_msg::access_context_t::inspection,
+									extractor );
+
+						msg = std::move(extractor.m_payload);
+					}
+
+				return msg;
+			}
+	};
+
+} /* namespace impl */
+
+} /* namespace enveloped_msg */
+
+} /* namespace extra */
+
+} /* namespace so_5 */
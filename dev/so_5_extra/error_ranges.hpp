@@ -116,6 +116,48 @@ const int mboxes_inflight_limit_errors = 21500;
  */
 const int msg_hierarchy_errors = 21600;
 
+//! Starting point for errors of mboxes::content_router submodule.
+/*!
+ * \since v.1.7.0
+ */
+const int mboxes_content_router_errors = 21700;
+
+//! Starting point for errors of mboxes::sampling_tracer submodule.
+/*!
+ * \since v.1.7.0
+ */
+const int mboxes_sampling_tracer_errors = 21800;
+
+//! Starting point for errors of mchains::asio_eventfd submodule.
+/*!
+ * \since v.1.7.0
+ */
+const int mchains_asio_eventfd_errors = 21900;
+
+//! Starting point for errors of mchains::shared_memory submodule.
+/*!
+ * \since v.1.7.0
+ */
+const int mchains_shared_memory_errors = 22000;
+
+//! Starting point for errors of mchains::priority submodule.
+/*!
+ * \since v.1.7.0
+ */
+const int mchains_priority_errors = 22100;
+
+//! Starting point for errors of mchains::lock_free submodule.
+/*!
+ * \since v.1.7.0
+ */
+const int mchains_lock_free_errors = 22200;
+
+//! Starting point for errors of mchains::conflating submodule.
+/*!
+ * \since v.1.7.0
+ */
+const int mchains_conflating_errors = 22300;
+
 } /* namespace errors */
 
 } /* namespace extra */
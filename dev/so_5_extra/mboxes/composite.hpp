@@ -8,14 +8,20 @@
 #pragma once
 
 #include <so_5_extra/error_ranges.hpp>
+#include <so_5_extra/mboxes/impl/delivery_snapshot_holder.hpp>
 
 #include <so_5/impl/msg_tracing_helpers.hpp>
 
+#include <so_5/details/rollback_on_exception.hpp>
+
 #include <so_5/environment.hpp>
 #include <so_5/mbox.hpp>
 
 #include <algorithm>
+#include <atomic>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <variant>
 #include <vector>
 
@@ -71,6 +77,18 @@ const int rc_mpmc_sink_can_be_used_with_mpsc_composite =
 const int rc_null_as_default_destination_mbox =
 		so_5::extra::errors::mboxes_composite_errors + 3;
 
+/*!
+ * \brief An attempt to replace routes of hot-swappable composite mbox
+ * by routes prepared for a different mbox type.
+ *
+ * New routes for hot-swappable composite mbox have to be prepared by
+ * a builder with the same mbox type (MPMC or MPSC) as the mbox itself.
+ *
+ * \since v.1.7.0
+ */
+const int rc_different_mbox_type_for_new_routes =
+		so_5::extra::errors::mboxes_composite_errors + 4;
+
 } /* namespace errors */
 
 /*!
@@ -263,6 +281,34 @@ inline const auto target_compare =
 			return target.m_msg_type < msg_type;
 		};
 
+/*!
+ * \brief Attempt to find a target for specified message type.
+ *
+ * \attention
+ * \a targets has to be sorted by message type.
+ *
+ * \return empty std::optional if \a msg_type is unknown.
+ *
+ * \since v.1.7.0
+ */
+[[nodiscard]]
+inline std::optional< const target_t * >
+try_find_target(
+	const target_container_t & targets,
+	const std::type_index & msg_type ) noexcept
+	{
+		const auto last = end( targets );
+		const auto it = std::lower_bound(
+				begin( targets ), last,
+				msg_type,
+				target_compare );
+
+		if( !( it == last ) && msg_type == it->m_msg_type )
+			return { std::addressof( *it ) };
+		else
+			return std::nullopt;
+	}
+
 namespace unknown_msg_type_handlers
 {
 
@@ -767,16 +813,7 @@ class actual_mbox_t final
 		std::optional< const target_t * >
 		try_find_target_for_msg_type( const std::type_index & msg_type ) const noexcept
 			{
-				const auto last = end( m_data.m_targets );
-				const auto it = std::lower_bound(
-						begin( m_data.m_targets ), last,
-						msg_type,
-						target_compare );
-
-				if( !( it == last ) && msg_type == it->m_msg_type )
-					return { std::addressof( *it ) };
-				else
-					return std::nullopt;
+				return try_find_target( m_data.m_targets, msg_type );
 			}
 
 		/*!
@@ -801,8 +838,602 @@ class actual_mbox_t final
 			}
 	};
 
+/*!
+ * \brief Routing table for hot-swappable composite mbox.
+ *
+ * \note
+ * An instance of that type isn't changed after publication.
+ *
+ * \since v.1.7.0
+ */
+struct routing_table_t
+	{
+		//! What to do with messages of unknown type.
+		type_not_found_reaction_t m_unknown_type_reaction;
+
+		//! Registered targets.
+		/*!
+		 * \attention
+		 * It's expected to be sorted by message type.
+		 */
+		target_container_t m_targets;
+
+		routing_table_t(
+			type_not_found_reaction_t unknown_type_reaction,
+			target_container_t targets )
+			:	m_unknown_type_reaction{ std::move(unknown_type_reaction) }
+			,	m_targets{ std::move(targets) }
+			{}
+
+		/*!
+		 * \brief Find an actual destination for a message type.
+		 *
+		 * Takes into the account redirect_to_if_not_found reaction.
+		 *
+		 * \return nullptr if there is no destination for \a msg_type.
+		 * In that case m_unknown_type_reaction has to be used.
+		 */
+		[[nodiscard]]
+		const mbox_t *
+		try_find_destination( const std::type_index & msg_type ) const noexcept
+			{
+				const auto opt_target = try_find_target( m_targets, msg_type );
+				if( opt_target )
+					return std::addressof( (*opt_target)->m_dest );
+
+				if( const auto * redirect =
+						std::get_if< redirect_to_if_not_found_case_t >(
+								&m_unknown_type_reaction ) )
+					return std::addressof( redirect->dest() );
+
+				return nullptr;
+			}
+	};
+
+/*!
+ * \brief Type of unique pointer to routing table.
+ *
+ * \since v.1.7.0
+ */
+using routing_table_unique_ptr_t = std::unique_ptr< const routing_table_t >;
+
+/*!
+ * \brief Storage for routing tables of hot-swappable composite mbox.
+ *
+ * The current routing table is held by delivery_snapshot_holder_t.
+ * Senders don't acquire any locks, they just register themselves as
+ * readers and work with the table that was actual at the moment of
+ * the registration.
+ *
+ * A table replaced by a new one is destroyed by replace() as soon as all
+ * senders that could see it complete their deliveries. Destination mboxes
+ * from the old table are released at the same moment. replace() blocks
+ * the caller for that time, so hot-swappable composite mbox is intended
+ * for relatively rare changes of routes (like reconfigurations during
+ * a deployment), not for changing routes on every message.
+ *
+ * The storage also holds info about subscriptions and delivery filters
+ * made via hot-swappable mbox. A subscription (or delivery filter) stays
+ * on the destination mbox that was actual at the moment of subscription
+ * even if the route for the message type is changed later. Because of that
+ * unsubscription has to be done on the same destination mbox.
+ *
+ * \since v.1.7.0
+ */
+class routes_storage_t
+	{
+		//! Key for info about subscriptions and delivery filters.
+		using subscription_key_t =
+				std::pair< std::type_index, abstract_message_sink_t * >;
+
+		//! Type of map for subscriptions and delivery filters.
+		/*!
+		 * Value is the destination mbox that holds the subscription
+		 * (or the delivery filter).
+		 */
+		using subscriptions_map_t = std::map< subscription_key_t, mbox_t >;
+
+		//! Type of this mbox (MPMC or MPSC).
+		const mbox_type_t m_mbox_type;
+
+		//! Lock for changing of routes and subscription info.
+		std::mutex m_lock;
+
+		//! The current routing table.
+		::so_5::extra::mboxes::impl::delivery_snapshot_holder_t<
+						routing_table_t >
+				m_table;
+
+		//! Info about subscriptions made.
+		subscriptions_map_t m_subscriptions;
+
+		//! Info about delivery filters set.
+		subscriptions_map_t m_delivery_filters;
+
+		template< typename Action >
+		void
+		add_to_and_call(
+			subscriptions_map_t & where,
+			const std::type_index & msg_type,
+			abstract_message_sink_t & subscriber,
+			const mbox_t & dest,
+			Action && action )
+			{
+				auto [it, inserted] = where.emplace(
+						subscription_key_t{ msg_type, std::addressof(subscriber) },
+						dest );
+
+				// If the record already exists then the old destination
+				// has to be used.
+				::so_5::details::do_with_rollback_on_exception(
+						[&] { action( *(it->second) ); },
+						[&] {
+							if( inserted )
+								where.erase( it );
+						} );
+			}
+
+		template< typename Action >
+		void
+		remove_from_and_call(
+			subscriptions_map_t & where,
+			const std::type_index & msg_type,
+			abstract_message_sink_t & subscriber,
+			Action && action ) noexcept
+			{
+				auto it = where.find(
+						subscription_key_t{ msg_type, std::addressof(subscriber) } );
+				if( it != where.end() )
+					{
+						action( *(it->second) );
+						where.erase( it );
+					}
+			}
+
+	public:
+		routes_storage_t(
+			mbox_type_t mbox_type,
+			routing_table_unique_ptr_t initial_table )
+			:	m_mbox_type{ mbox_type }
+			,	m_table{ std::move(initial_table) }
+			{}
+
+		routes_storage_t( const routes_storage_t & ) = delete;
+		routes_storage_t( routes_storage_t && ) = delete;
+
+		[[nodiscard]]
+		mbox_type_t
+		mbox_type() const noexcept { return m_mbox_type; }
+
+		//! Type of guard for reading access to the current routing table.
+		using table_reader_t = ::so_5::extra::mboxes::impl::
+				delivery_snapshot_holder_t< routing_table_t >::reader_t;
+
+		//! Get the reading access to the current routing table.
+		/*!
+		 * The table stays alive while the returned object exists.
+		 *
+		 * \note
+		 * This method doesn't acquire any locks.
+		 */
+		[[nodiscard]]
+		table_reader_t
+		current() const noexcept
+			{
+				return m_table.acquire();
+			}
+
+		//! Publish a new routing table and destroy the old one.
+		/*!
+		 * \note
+		 * This method blocks the caller until all senders that use
+		 * the old table complete their deliveries.
+		 */
+		void
+		replace( routing_table_unique_ptr_t new_table ) noexcept
+			{
+				std::lock_guard< std::mutex > lock{ m_lock };
+
+				m_table.replace( std::move(new_table) );
+			}
+
+		//! Make a subscription via the current routing table.
+		void
+		subscribe_event_handler(
+			const std::type_index & msg_type,
+			abstract_message_sink_t & subscriber )
+			{
+				std::lock_guard< std::mutex > lock{ m_lock };
+
+				// NOTE: the table can't be replaced while m_lock is held.
+				const auto reader = current();
+				const auto & table = reader.value();
+				const auto * dest = table.try_find_destination( msg_type );
+				if( dest )
+					add_to_and_call( m_subscriptions, msg_type, subscriber, *dest,
+							[&]( abstract_message_box_t & mbox ) {
+								mbox.subscribe_event_handler( msg_type, subscriber );
+							} );
+				else
+					std::visit(
+							unknown_msg_type_handlers::subscribe_event_t{
+									msg_type,
+									subscriber },
+							table.m_unknown_type_reaction );
+			}
+
+		//! Remove a subscription from the mbox where it was made.
+		void
+		unsubscribe_event_handler(
+			const std::type_index & msg_type,
+			abstract_message_sink_t & subscriber ) noexcept
+			{
+				std::lock_guard< std::mutex > lock{ m_lock };
+
+				remove_from_and_call( m_subscriptions, msg_type, subscriber,
+						[&]( abstract_message_box_t & mbox ) noexcept {
+							mbox.unsubscribe_event_handler( msg_type, subscriber );
+						} );
+			}
+
+		//! Set a delivery filter via the current routing table.
+		void
+		set_delivery_filter(
+			const std::type_index & msg_type,
+			const delivery_filter_t & filter,
+			abstract_message_sink_t & subscriber )
+			{
+				std::lock_guard< std::mutex > lock{ m_lock };
+
+				// NOTE: the table can't be replaced while m_lock is held.
+				const auto reader = current();
+				const auto & table = reader.value();
+				const auto * dest = table.try_find_destination( msg_type );
+				if( dest )
+					add_to_and_call( m_delivery_filters, msg_type, subscriber, *dest,
+							[&]( abstract_message_box_t & mbox ) {
+								mbox.set_delivery_filter( msg_type, filter, subscriber );
+							} );
+				else
+					std::visit(
+							unknown_msg_type_handlers::set_delivery_filter_t{
+									msg_type,
+									filter,
+									subscriber },
+							table.m_unknown_type_reaction );
+			}
+
+		//! Remove a delivery filter from the mbox where it was set.
+		void
+		drop_delivery_filter(
+			const std::type_index & msg_type,
+			abstract_message_sink_t & subscriber ) noexcept
+			{
+				std::lock_guard< std::mutex > lock{ m_lock };
+
+				remove_from_and_call( m_delivery_filters, msg_type, subscriber,
+						[&]( abstract_message_box_t & mbox ) noexcept {
+							mbox.drop_delivery_filter( msg_type, subscriber );
+						} );
+			}
+	};
+
+/*!
+ * \brief Actual implementation of hot-swappable composite mbox.
+ *
+ * Unlike actual_mbox_t this mbox allows replacement of the whole routing
+ * table at run-time. Delivery of messages is performed without any locks:
+ * the current routing table is loaded via atomic pointer.
+ *
+ * \since v.1.7.0
+ */
+template< typename Tracing_Base >
+class actual_hot_swappable_mbox_t final
+	:	public abstract_message_box_t
+	,	private Tracing_Base
+	{
+	public:
+		/*!
+		 * \brief Initializing constructor.
+		 *
+		 * \tparam Tracing_Args parameters for Tracing_Base constructor
+		 * (can be empty list if Tracing_Base have only the default constructor).
+		 */
+		template< typename... Tracing_Args >
+		actual_hot_swappable_mbox_t(
+			//! SObjectizer Environment to work in.
+			environment_t & env,
+			//! ID of this mbox.
+			mbox_id_t id,
+			//! Type of this mbox.
+			mbox_type_t mbox_type,
+			//! The initial routing table.
+			routing_table_unique_ptr_t initial_table,
+			Tracing_Args &&... tracing_args )
+			:	Tracing_Base{ std::forward<Tracing_Args>(tracing_args)... }
+			,	m_env{ env }
+			,	m_id{ id }
+			,	m_routes{ mbox_type, std::move(initial_table) }
+			{}
+
+		~actual_hot_swappable_mbox_t() override = default;
+
+		mbox_id_t
+		id() const override
+			{
+				return this->m_id;
+			}
+
+		void
+		subscribe_event_handler(
+			const std::type_index & msg_type,
+			abstract_message_sink_t & subscriber ) override
+			{
+				this->m_routes.subscribe_event_handler( msg_type, subscriber );
+			}
+
+		void
+		unsubscribe_event_handler(
+			const std::type_index & msg_type,
+			abstract_message_sink_t & subscriber ) noexcept override
+			{
+				this->m_routes.unsubscribe_event_handler( msg_type, subscriber );
+			}
+
+		std::string
+		query_name() const override
+			{
+				std::ostringstream s;
+				s << "<mbox:type=COMPOSITE_HOT_SWAPPABLE";
+
+				switch( this->m_routes.mbox_type() )
+					{
+					case mbox_type_t::multi_producer_multi_consumer:
+						s << "(MPMC)";
+					break;
+
+					case mbox_type_t::multi_producer_single_consumer:
+						s << "(MPSC)";
+					break;
+					}
+
+				s << ":id=" << this->m_id << ">";
+
+				return s.str();
+			}
+
+		mbox_type_t
+		type() const override
+			{
+				return this->m_routes.mbox_type();
+			}
+
+		void
+		do_deliver_message(
+			message_delivery_mode_t delivery_mode,
+			const std::type_index & msg_type,
+			const message_ref_t & message,
+			unsigned int redirection_deep ) override
+			{
+				ensure_immutable_message( msg_type, message );
+
+				typename Tracing_Base::deliver_op_tracer tracer{
+						*this, // as Tracing_base
+						*this, // as abstract_message_box_t
+						"deliver_message",
+						delivery_mode,
+						msg_type, message, redirection_deep };
+
+				// NOTE: the table is acquired only once, so the whole delivery
+				// operation works with the same view of routes even if
+				// routes are being replaced right now. The table won't be
+				// destroyed until the end of the delivery.
+				const auto reader = this->m_routes.current();
+				const auto & table = reader.value();
+
+				const auto opt_target = try_find_target( table.m_targets, msg_type );
+				if( opt_target )
+					{
+						using namespace ::so_5::impl::msg_tracing_helpers::details;
+
+						tracer.make_trace(
+								"redirect_to_destination",
+								mbox_as_msg_destination{ *( (*opt_target)->m_dest ) } );
+
+						(*opt_target)->m_dest->do_deliver_message(
+								delivery_mode,
+								msg_type,
+								message,
+								redirection_deep );
+					}
+				else
+					{
+						using handler_t = unknown_msg_type_handlers::deliver_message_t<
+								typename Tracing_Base::deliver_op_tracer >;
+
+						std::visit(
+								handler_t{
+										tracer,
+										delivery_mode,
+										msg_type,
+										message,
+										redirection_deep },
+								table.m_unknown_type_reaction );
+					}
+			}
+
+		void
+		set_delivery_filter(
+			const std::type_index & msg_type,
+			const delivery_filter_t & filter,
+			abstract_message_sink_t & subscriber ) override
+			{
+				this->m_routes.set_delivery_filter( msg_type, filter, subscriber );
+			}
+
+		void
+		drop_delivery_filter(
+			const std::type_index & msg_type,
+			abstract_message_sink_t & subscriber ) noexcept override
+			{
+				this->m_routes.drop_delivery_filter( msg_type, subscriber );
+			}
+
+		so_5::environment_t &
+		environment() const noexcept override
+			{
+				return this->m_env;
+			}
+
+		//! Access to routes storage.
+		[[nodiscard]]
+		routes_storage_t &
+		routes() noexcept
+			{
+				return this->m_routes;
+			}
+
+	private:
+		//! SObjectizer Environment to work in.
+		environment_t & m_env;
+
+		//! ID of this mbox.
+		const mbox_id_t m_id;
+
+		//! Routing tables.
+		routes_storage_t m_routes;
+
+		/*!
+		 * \brief Ensures that message is an immutable message.
+		 *
+		 * Checks mutability flag and throws an exception if message is
+		 * a mutable one.
+		 */
+		void
+		ensure_immutable_message(
+			const std::type_index & msg_type,
+			const message_ref_t & what ) const
+			{
+				if( (mbox_type_t::multi_producer_multi_consumer ==
+						this->m_routes.mbox_type()) &&
+						(message_mutability_t::immutable_message !=
+								message_mutability( what )) )
+					SO_5_THROW_EXCEPTION(
+							so_5::rc_mutable_msg_cannot_be_delivered_via_mpmc_mbox,
+							"an attempt to deliver mutable message via MPMC mbox"
+							", msg_type=" + std::string(msg_type.name()) );
+			}
+	};
+
 } /* namespace impl */
 
+/*!
+ * \brief A handle for hot-swappable composite mbox.
+ *
+ * Hot-swappable composite mbox works just like an ordinary composite mbox,
+ * but the routing table of it can be replaced at run-time. For example,
+ * messages of some type can be redirected to a new handler pool
+ * without recreation of the mbox itself (so there is no need to pass
+ * a new mbox to every producer).
+ *
+ * An instance of hot_swappable_mbox_t is created by
+ * mbox_builder_t::make_hot_swappable() method:
+ * \code
+ * using namespace so_5::extra::mboxes::composite;
+ *
+ * auto router = single_consumer_builder(throw_if_not_found())
+ * 	.add<msg_first>(first_mbox)
+ * 	.add<msg_second>(second_mbox)
+ * 	.make_hot_swappable(env);
+ *
+ * // Mbox to be passed to producers.
+ * const so_5::mbox_t dest = router.as_mbox();
+ * ...
+ * // Now msg_second has to be redirected to another mbox.
+ * router.replace_routes(single_consumer_builder(throw_if_not_found())
+ * 	.add<msg_first>(first_mbox)
+ * 	.add<msg_second>(new_second_mbox));
+ * \endcode
+ *
+ * Delivery of a message via hot-swappable composite mbox doesn't acquire
+ * any locks: the current routing table is published via an atomic pointer.
+ * A sender that started a delivery before replace_routes() call completes
+ * that delivery with the old routes. replace_routes() waits for the
+ * completion of such deliveries and then destroys the old routing table.
+ *
+ * \note
+ * Subscriptions and delivery filters made via hot-swappable composite mbox
+ * stay on the destination mbox that was actual at the moment of the
+ * subscription (or setting the delivery filter). Replacement of routes
+ * doesn't move them to new destinations.
+ *
+ * \note
+ * A destination mbox that is used by a subscription or a delivery filter
+ * is held by hot-swappable mbox until the unsubscription (or dropping of
+ * the delivery filter) even if it's not in the current routes anymore.
+ *
+ * \attention
+ * replace_routes() can't be called from a delivery of a message via
+ * the same hot-swappable mbox (for example, from a custom destination
+ * mbox or a delivery filter): it would wait for the completion of
+ * that delivery forever.
+ *
+ * \note
+ * This class is Copyable and Moveable. All copies refer to the same mbox.
+ * It's safe to call replace_routes() from different threads.
+ *
+ * \since v.1.7.0
+ */
+class hot_swappable_mbox_t
+	{
+		friend class mbox_builder_t;
+
+		//! The mbox itself.
+		mbox_t m_mbox;
+
+		//! Routing tables of the mbox.
+		/*!
+		 * \note
+		 * It's a part of m_mbox and can be used while m_mbox is alive.
+		 */
+		impl::routes_storage_t * m_routes;
+
+		//! Initializing constructor.
+		hot_swappable_mbox_t(
+			mbox_t mbox,
+			impl::routes_storage_t & routes ) noexcept
+			:	m_mbox{ std::move(mbox) }
+			,	m_routes{ std::addressof(routes) }
+			{}
+
+	public:
+		//! Get the mbox to be used for sending messages.
+		[[nodiscard]]
+		const mbox_t &
+		as_mbox() const noexcept { return m_mbox; }
+
+		/*!
+		 * \brief Replace the routing table of the mbox.
+		 *
+		 * The new routing table is taken from \a routes.
+		 *
+		 * \attention
+		 * \a routes has to be created for the same mbox type as the
+		 * hot-swappable mbox. An exception will be thrown otherwise.
+		 *
+		 * \note
+		 * \a routes has the same limitations as for mbox_builder_t::make():
+		 * it isn't guaranteed that \a routes will hold its value after
+		 * the return from replace_routes().
+		 *
+		 * \note
+		 * The old routing table is destroyed before the return. The call
+		 * blocks until all deliveries that use the old table complete.
+		 */
+		void
+		replace_routes( mbox_builder_t && routes );
+	};
+
 /*!
  * \brief Factory class for building an instance of composite mbox.
  *
@@ -874,6 +1505,8 @@ class mbox_builder_t
 			mbox_type_t mbox_type,
 			type_not_found_reaction_t unknown_type_reaction );
 
+		friend class hot_swappable_mbox_t;
+
 		//! Initializing constructor.
 		mbox_builder_t(
 			//! Type of mbox to be created.
@@ -1103,6 +1736,81 @@ class mbox_builder_t
 						} );
 			}
 
+		/*!
+		 * \brief Make a hot-swappable composite mbox.
+		 *
+		 * The created mbox will use information added to builder
+		 * before calling make_hot_swappable() method as the initial
+		 * routing table. This table can be replaced later via
+		 * hot_swappable_mbox_t::replace_routes().
+		 *
+		 * Usage example:
+		 * \code
+		 * using namespace so_5::extra::mboxes::composite;
+		 *
+		 * auto router = multi_consumer_builder(drop_if_not_found())
+		 * 	.add<msg_first>(first_mbox)
+		 * 	.add<msg_second>(second_mbox)
+		 * 	.make_hot_swappable(env);
+		 * \endcode
+		 *
+		 * The state of the builder after the return from
+		 * make_hot_swappable() is the same as after the return from make().
+		 *
+		 * \since v.1.7.0
+		 */
+		[[nodiscard]]
+		hot_swappable_mbox_t
+		make_hot_swappable( environment_t & env )
+			{
+				impl::routes_storage_t * routes{ nullptr };
+
+				auto mbox = env.make_custom_mbox(
+						[this, &routes]( const mbox_creation_data_t & data )
+						{
+							auto table = make_routing_table();
+							mbox_t result;
+
+							if( data.m_tracer.get().is_msg_tracing_enabled() )
+								{
+									using ::so_5::impl::msg_tracing_helpers::
+											tracing_enabled_base;
+									using T = impl::actual_hot_swappable_mbox_t<
+											tracing_enabled_base >;
+
+									auto * actual = new T{
+											data.m_env.get(),
+											data.m_id,
+											m_mbox_type,
+											std::move(table),
+											data.m_tracer
+										};
+									result = mbox_t{ actual };
+									routes = std::addressof( actual->routes() );
+								}
+							else
+								{
+									using ::so_5::impl::msg_tracing_helpers::
+											tracing_disabled_base;
+									using T = impl::actual_hot_swappable_mbox_t<
+											tracing_disabled_base >;
+
+									auto * actual = new T{
+											data.m_env.get(),
+											data.m_id,
+											m_mbox_type,
+											std::move(table)
+										};
+									result = mbox_t{ actual };
+									routes = std::addressof( actual->routes() );
+								}
+
+							return result;
+						} );
+
+				return { std::move(mbox), *routes };
+			}
+
 	private:
 		/*!
 		 * \brief Type of container for holding targets.
@@ -1139,8 +1847,33 @@ class mbox_builder_t
 
 				return result;
 			}
+
+		/*!
+		 * \return A new routing table for hot-swappable composite mbox.
+		 *
+		 * \since v.1.7.0
+		 */
+		[[nodiscard]]
+		impl::routing_table_unique_ptr_t
+		make_routing_table()
+			{
+				return std::make_unique< impl::routing_table_t >(
+						std::move(m_unknown_type_reaction),
+						targets_to_vector() );
+			}
 	};
 
+inline void
+hot_swappable_mbox_t::replace_routes( mbox_builder_t && routes )
+	{
+		if( routes.m_mbox_type != m_routes->mbox_type() )
+			SO_5_THROW_EXCEPTION(
+					errors::rc_different_mbox_type_for_new_routes,
+					"new routes are prepared for a different mbox type" );
+
+		m_routes->replace( routes.make_routing_table() );
+	}
+
 /*!
  * \brief Factory function for making mbox_builder.
  *
@@ -0,0 +1,1122 @@
+/*!
+ * \file
+ * \brief Implementation of content-based routing mbox.
+ *
+ * \since v.1.7.0
+ */
+
+#pragma once
+
+#include <so_5_extra/mboxes/composite.hpp>
+
+#include <so_5_extra/error_ranges.hpp>
+
+#include <so_5_extra/enveloped_msg/impl/payload_extractor.hpp>
+
+#include <so_5/impl/msg_tracing_helpers.hpp>
+
+#include <so_5/enveloped_msg.hpp>
+#include <so_5/environment.hpp>
+#include <so_5/mbox.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace so_5 {
+
+namespace extra {
+
+namespace mboxes {
+
+namespace content_router {
+
+namespace errors {
+
+/*!
+ * \brief An attempt to make a subscription to a message type that
+ * is routed by the content of messages.
+ *
+ * Content-based router doesn't know the destination for a message
+ * before the message is sent. Because of that it's impossible to
+ * subscribe (or set a delivery filter) to a routed message type.
+ *
+ * \since v.1.7.0
+ */
+const int rc_subscription_to_routed_type =
+		so_5::extra::errors::mboxes_content_router_errors;
+
+/*!
+ * \brief An attempt to use nullptr as the destination mbox.
+ *
+ * \since v.1.7.0
+ */
+const int rc_null_as_destination_mbox =
+		so_5::extra::errors::mboxes_content_router_errors + 1;
+
+/*!
+ * \brief An attempt to add MPMC target to MPSC mbox.
+ *
+ * If content-based router is created as MPSC mbox then a MPMC mbox can't be
+ * added as a destination for a mutable message.
+ *
+ * \since v.1.7.0
+ */
+const int rc_mpmc_sink_can_be_used_with_mpsc_router =
+		so_5::extra::errors::mboxes_content_router_errors + 2;
+
+/*!
+ * \brief An attempt to mix different routing schemes for one message type.
+ *
+ * A message type can be routed either by a list of rules or by
+ * a key. An attempt to add a rule for a message type that is routed by
+ * a key (and vice versa) will lead to this error.
+ *
+ * \since v.1.7.0
+ */
+const int rc_different_routing_scheme_for_message_type =
+		so_5::extra::errors::mboxes_content_router_errors + 3;
+
+} /* namespace errors */
+
+//
+// no_destination_reaction_t
+//
+/*!
+ * \brief Description of a reaction to a message without a destination.
+ *
+ * It's just a wrapper around reactions of composite mbox. The wrapper
+ * is necessary to avoid clashes between builder functions from
+ * composite and content_router namespaces.
+ *
+ * \note
+ * Instances of that type are created by redirect_if_no_destination(),
+ * throw_if_no_destination() and drop_if_no_destination() functions.
+ *
+ * \since v.1.7.0
+ */
+class no_destination_reaction_t
+	{
+		//! The actual reaction.
+		::so_5::extra::mboxes::composite::type_not_found_reaction_t m_reaction;
+
+	public:
+		//! Initializing constructor.
+		explicit no_destination_reaction_t(
+			::so_5::extra::mboxes::composite::type_not_found_reaction_t reaction )
+			:	m_reaction{ std::move(reaction) }
+			{}
+
+		//! Getter for the actual reaction.
+		[[nodiscard]]
+		::so_5::extra::mboxes::composite::type_not_found_reaction_t &
+		reaction() noexcept { return m_reaction; }
+	};
+
+/*!
+ * \brief Helper function to specify that a message without a destination
+ * has to be redirected to another mbox.
+ *
+ * \note
+ * Subscriptions to message types that aren't routed by content are
+ * redirected to \a dest_mbox too.
+ *
+ * Usage example:
+ * \code
+ * using namespace so_5::extra::mboxes::content_router;
+ *
+ * auto mbox = multi_consumer_builder(redirect_if_no_destination(default_mbox))
+ * 	.add_rule<order>(...)
+ * 	...
+ * 	.make(env);
+ * \endcode
+ *
+ * \since v.1.7.0
+ */
+[[nodiscard]]
+inline no_destination_reaction_t
+redirect_if_no_destination( const mbox_t & dest_mbox )
+	{
+		return no_destination_reaction_t{
+				::so_5::extra::mboxes::composite::redirect_to_if_not_found(
+						dest_mbox )
+			};
+	}
+
+/*!
+ * \brief Helper function to specify that an exception has to be thrown
+ * if a message has no destination.
+ *
+ * \since v.1.7.0
+ */
+[[nodiscard]]
+inline no_destination_reaction_t
+throw_if_no_destination()
+	{
+		return no_destination_reaction_t{
+				::so_5::extra::mboxes::composite::throw_if_not_found()
+			};
+	}
+
+/*!
+ * \brief Helper function to specify that a message without a destination
+ * has to be dropped (ignored).
+ *
+ * \since v.1.7.0
+ */
+[[nodiscard]]
+inline no_destination_reaction_t
+drop_if_no_destination()
+	{
+		return no_destination_reaction_t{
+				::so_5::extra::mboxes::composite::drop_if_not_found()
+			};
+	}
+
+// Forward declaration.
+class mbox_builder_t;
+
+namespace impl {
+
+/*!
+ * \brief Interface of router for messages of one type.
+ *
+ * \since v.1.7.0
+ */
+class type_router_t
+	{
+	public:
+		virtual ~type_router_t() noexcept = default;
+
+		/*!
+		 * \brief Select the destination for a message.
+		 *
+		 * \note
+		 * \a msg is the actual payload (not an envelope).
+		 *
+		 * \return nullptr if there is no destination for \a msg.
+		 */
+		[[nodiscard]]
+		virtual const mbox_t *
+		select( message_t & msg ) const = 0;
+	};
+
+/*!
+ * \brief Type of unique pointer to type_router.
+ *
+ * \since v.1.7.0
+ */
+using type_router_unique_ptr_t = std::unique_ptr< type_router_t >;
+
+/*!
+ * \brief Router that checks a list of rules in the order of their addition.
+ *
+ * The first rule with a predicate that returns `true` determines the
+ * destination.
+ *
+ * \since v.1.7.0
+ */
+template< typename Msg_Type >
+class rules_router_t final : public type_router_t
+	{
+	public:
+		//! Type of the payload to be passed to predicates.
+		using payload_type = typename message_payload_type< Msg_Type >::payload_type;
+
+		//! Type of a predicate.
+		using predicate_t = std::function< bool(const payload_type &) >;
+
+		const mbox_t *
+		select( message_t & msg ) const override
+			{
+				const payload_type & payload =
+						message_payload_type< Msg_Type >::payload_reference( msg );
+
+				for( const auto & r : m_rules )
+					if( r.m_predicate( payload ) )
+						return std::addressof( r.m_dest );
+
+				return nullptr;
+			}
+
+		//! Add another rule to the end of the list.
+		void
+		add( predicate_t predicate, mbox_t dest )
+			{
+				m_rules.push_back( rule_t{ std::move(predicate), std::move(dest) } );
+			}
+
+	private:
+		//! Description of one rule.
+		struct rule_t
+			{
+				predicate_t m_predicate;
+				mbox_t m_dest;
+			};
+
+		//! List of rules.
+		std::vector< rule_t > m_rules;
+	};
+
+/*!
+ * \brief Router that uses a small integer key as an index in an array
+ * of destinations.
+ *
+ * \tparam Key_Extractor type of function object that extracts the key
+ * from a message. It's stored by value, so the call to it can be
+ * inlined by the compiler.
+ *
+ * \since v.1.7.0
+ */
+template< typename Msg_Type, typename Key_Extractor >
+class dense_key_router_t final : public type_router_t
+	{
+	public:
+		//! Type of the payload to be passed to key extractor.
+		using payload_type = typename message_payload_type< Msg_Type >::payload_type;
+
+		dense_key_router_t(
+			Key_Extractor key_extractor,
+			std::vector< mbox_t > targets )
+			:	m_key_extractor{ std::move(key_extractor) }
+			,	m_targets{ std::move(targets) }
+			{}
+
+		const mbox_t *
+		select( message_t & msg ) const override
+			{
+				const payload_type & payload =
+						message_payload_type< Msg_Type >::payload_reference( msg );
+
+				// NOTE: negative value for a signed key will be converted
+				// to a very big value and that value will be out of range.
+				const auto key = static_cast< std::size_t >(
+						m_key_extractor( payload ) );
+
+				if( key < m_targets.size() && m_targets[ key ] )
+					return std::addressof( m_targets[ key ] );
+
+				return nullptr;
+			}
+
+	private:
+		//! Function object for getting a key from a message.
+		const Key_Extractor m_key_extractor;
+
+		//! Destinations. Index in that vector is the key value.
+		/*!
+		 * \note
+		 * Null items are allowed. They mean absence of a destination.
+		 */
+		const std::vector< mbox_t > m_targets;
+	};
+
+/*!
+ * \brief Description of one routed message type.
+ *
+ * \since v.1.7.0
+ */
+struct routed_type_t
+	{
+		//! Message type.
+		std::type_index m_msg_type;
+
+		//! Router for that type.
+		type_router_unique_ptr_t m_router;
+
+		routed_type_t(
+			std::type_index msg_type,
+			type_router_unique_ptr_t router )
+			:	m_msg_type{ std::move(msg_type) }
+			,	m_router{ std::move(router) }
+			{}
+	};
+
+/*!
+ * \brief Type of container for routed types.
+ *
+ * \note
+ * It's expected to be sorted by message type.
+ *
+ * \since v.1.7.0
+ */
+using routed_type_container_t = std::vector< routed_type_t >;
+
+using ::so_5::extra::enveloped_msg::impl::payload_extractor_t;
+
+/*!
+ * \brief Mbox data that doesn't depend on template parameters.
+ *
+ * \since v.1.7.0
+ */
+struct mbox_data_t
+	{
+		//! SObjectizer Environment to work in.
+		environment_t * m_env_ptr;
+
+		//! ID of this mbox.
+		mbox_id_t m_id;
+
+		//! Type of the mbox.
+		mbox_type_t m_mbox_type;
+
+		//! What to do with messages without a destination.
+		composite::type_not_found_reaction_t m_no_destination_reaction;
+
+		//! Routed message types.
+		routed_type_container_t m_routes;
+
+		mbox_data_t(
+			environment_t & env,
+			mbox_id_t id,
+			mbox_type_t mbox_type,
+			composite::type_not_found_reaction_t no_destination_reaction,
+			routed_type_container_t routes )
+			:	m_env_ptr{ &env }
+			,	m_id{ id }
+			,	m_mbox_type{ mbox_type }
+			,	m_no_destination_reaction{ std::move(no_destination_reaction) }
+			,	m_routes{ std::move(routes) }
+			{}
+	};
+
+/*!
+ * \brief Actual implementation of content-based router mbox.
+ *
+ * \note
+ * An instance of that class is immutable. It doesn't allow modification of its
+ * state. It makes the internals of actual_mbox_t thread safe.
+ *
+ * \since v.1.7.0
+ */
+template< typename Tracing_Base >
+class actual_mbox_t final
+	:	public abstract_message_box_t
+	,	private Tracing_Base
+	{
+		friend class ::so_5::extra::mboxes::content_router::mbox_builder_t;
+
+		/*!
+		 * \brief Initializing constructor.
+		 *
+		 * \tparam Tracing_Args parameters for Tracing_Base constructor
+		 * (can be empty list if Tracing_Base have only the default constructor).
+		 */
+		template< typename... Tracing_Args >
+		actual_mbox_t(
+			//! Data for mbox that doesn't depend on template parameters.
+			mbox_data_t mbox_data,
+			Tracing_Args &&... tracing_args )
+			:	Tracing_Base{ std::forward<Tracing_Args>(tracing_args)... }
+			,	m_data{ std::move(mbox_data) }
+			{}
+
+	public:
+		~actual_mbox_t() override = default;
+
+		mbox_id_t
+		id() const override
+			{
+				return this->m_data.m_id;
+			}
+
+		void
+		subscribe_event_handler(
+			const std::type_index & msg_type,
+			abstract_message_sink_t & subscriber ) override
+			{
+				ensure_not_routed_type( msg_type );
+
+				std::visit(
+						composite::impl::unknown_msg_type_handlers::subscribe_event_t{
+								msg_type,
+								subscriber },
+						this->m_data.m_no_destination_reaction );
+			}
+
+		void
+		unsubscribe_event_handler(
+			const std::type_index & msg_type,
+			abstract_message_sink_t & subscriber ) noexcept override
+			{
+				// Subscriptions to routed types are impossible.
+				if( !try_find_router( msg_type ) )
+					std::visit(
+							composite::impl::unknown_msg_type_handlers::unsubscribe_event_t{
+									msg_type,
+									subscriber },
+							this->m_data.m_no_destination_reaction );
+			}
+
+		std::string
+		query_name() const override
+			{
+				std::ostringstream s;
+				s << "<mbox:type=CONTENT_ROUTER";
+
+				switch( this->m_data.m_mbox_type )
+					{
+					case mbox_type_t::multi_producer_multi_consumer:
+						s << "(MPMC)";
+					break;
+
+					case mbox_type_t::multi_producer_single_consumer:
+						s << "(MPSC)";
+					break;
+					}
+
+				s << ":id=" << this->m_data.m_id << ">";
+
+				return s.str();
+			}
+
+		mbox_type_t
+		type() const override
+			{
+				return this->m_data.m_mbox_type;
+			}
+
+		void
+		do_deliver_message(
+			message_delivery_mode_t delivery_mode,
+			const std::type_index & msg_type,
+			const message_ref_t & message,
+			unsigned int redirection_deep ) override
+			{
+				ensure_immutable_message( msg_type, message );
+
+				typename Tracing_Base::deliver_op_tracer tracer{
+						*this, // as Tracing_base
+						*this, // as abstract_message_box_t
+						"deliver_message",
+						delivery_mode,
+						msg_type, message, redirection_deep };
+
+				const mbox_t * dest = nullptr;
+
+				if( const auto * router = try_find_router( msg_type ) )
+					{
+						const message_ref_t payload =
+								payload_extractor_t::extract( message );
+						if( !payload )
+							{
+								// Message was revoked or something like that.
+								tracer.make_trace( "payload_is_not_available" );
+								return;
+							}
+
+						dest = router->select( *payload );
+					}
+
+				if( dest )
+					{
+						using namespace ::so_5::impl::msg_tracing_helpers::details;
+
+						tracer.make_trace(
+								"redirect_to_destination",
+								mbox_as_msg_destination{ *(*dest) } );
+
+						(*dest)->do_deliver_message(
+								delivery_mode,
+								msg_type,
+								message,
+								redirection_deep );
+					}
+				else
+					{
+						using handler_t = composite::impl::unknown_msg_type_handlers::
+								deliver_message_t< typename Tracing_Base::deliver_op_tracer >;
+
+						std::visit(
+								handler_t{
+										tracer,
+										delivery_mode,
+										msg_type,
+										message,
+										redirection_deep },
+								this->m_data.m_no_destination_reaction );
+					}
+			}
+
+		void
+		set_delivery_filter(
+			const std::type_index & msg_type,
+			const delivery_filter_t & filter,
+			abstract_message_sink_t & subscriber ) override
+			{
+				ensure_not_routed_type( msg_type );
+
+				std::visit(
+						composite::impl::unknown_msg_type_handlers::set_delivery_filter_t{
+								msg_type,
+								filter,
+								subscriber },
+						this->m_data.m_no_destination_reaction );
+			}
+
+		void
+		drop_delivery_filter(
+			const std::type_index & msg_type,
+			abstract_message_sink_t & subscriber ) noexcept override
+			{
+				// Delivery filters for routed types are impossible.
+				if( !try_find_router( msg_type ) )
+					std::visit(
+							composite::impl::unknown_msg_type_handlers::drop_delivery_filter_t{
+									msg_type,
+									subscriber },
+							this->m_data.m_no_destination_reaction );
+			}
+
+		so_5::environment_t &
+		environment() const noexcept override
+			{
+				return *(this->m_data.m_env_ptr);
+			}
+
+	private:
+		//! Mbox's data.
+		const mbox_data_t m_data;
+
+		/*!
+		 * \brief Attempt to find a router for specified message type.
+		 *
+		 * \return nullptr if \a msg_type isn't routed.
+		 */
+		[[nodiscard]]
+		const type_router_t *
+		try_find_router( const std::type_index & msg_type ) const noexcept
+			{
+				const auto last = end( m_data.m_routes );
+				const auto it = std::lower_bound(
+						begin( m_data.m_routes ), last,
+						msg_type,
+						[]( const routed_type_t & r, const std::type_index & t ) {
+							return r.m_msg_type < t;
+						} );
+
+				if( !( it == last ) && msg_type == it->m_msg_type )
+					return it->m_router.get();
+				else
+					return nullptr;
+			}
+
+		/*!
+		 * \brief Ensures that there is no a router for a message type.
+		 *
+		 * \throw so_5::exception_t if \a msg_type is routed.
+		 */
+		void
+		ensure_not_routed_type( const std::type_index & msg_type ) const
+			{
+				if( try_find_router( msg_type ) )
+					SO_5_THROW_EXCEPTION(
+							errors::rc_subscription_to_routed_type,
+							"subscription to a message type routed by content "
+							"isn't supported, msg_type="
+							+ std::string(msg_type.name()) );
+			}
+
+		/*!
+		 * \brief Ensures that message is an immutable message.
+		 *
+		 * Checks mutability flag and throws an exception if message is
+		 * a mutable one.
+		 */
+		void
+		ensure_immutable_message(
+			const std::type_index & msg_type,
+			const message_ref_t & what ) const
+			{
+				if( (mbox_type_t::multi_producer_multi_consumer ==
+						this->m_data.m_mbox_type) &&
+						(message_mutability_t::immutable_message !=
+								message_mutability( what )) )
+					SO_5_THROW_EXCEPTION(
+							so_5::rc_mutable_msg_cannot_be_delivered_via_mpmc_mbox,
+							"an attempt to deliver mutable message via MPMC mbox"
+							", msg_type=" + std::string(msg_type.name()) );
+			}
+	};
+
+} /* namespace impl */
+
+/*!
+ * \brief Factory class for building an instance of content-based
+ * router mbox.
+ *
+ * Content-based router is similar to composite mbox (see
+ * so_5::extra::mboxes::composite), but the destination is selected not
+ * only by the type of a message but by the content of the message.
+ * The destination is selected inside do_deliver_message() in the
+ * context of the sender, so there is no need to have a separate
+ * dispatching agent that receives messages and resends them.
+ *
+ * There are two schemes of routing for a message type.
+ *
+ * The first one is a list of rules. Every rule is a pair of predicate and
+ * destination mbox. Rules are checked in the order of their addition. The
+ * first rule with a predicate that returns `true` determines the
+ * destination:
+ * \code
+ * using namespace so_5::extra::mboxes::content_router;
+ *
+ * auto mbox = multi_consumer_builder(redirect_if_no_destination(default_mbox))
+ * 	.add_rule<order>(
+ * 		[](const order & o) { return o.m_priority > 5; },
+ * 		urgent_orders_mbox)
+ * 	.add_rule<order>(
+ * 		[](const order & o) { return o.m_venue == "XNAS"; },
+ * 		nasdaq_orders_mbox)
+ * 	.make(env);
+ * \endcode
+ *
+ * The second one is a fast path for cases where a message contains a small
+ * integer key (like an ID of a venue or a number of a shard). The key is
+ * used as an index in a dense array of destinations:
+ * \code
+ * using namespace so_5::extra::mboxes::content_router;
+ *
+ * auto mbox = multi_consumer_builder(drop_if_no_destination())
+ * 	.add_by_key<quote>(
+ * 		[](const quote & q) { return q.m_venue_id; },
+ * 		{ venue_0_mbox, venue_1_mbox, venue_2_mbox })
+ * 	.make(env);
+ * \endcode
+ *
+ * The reaction passed to the builder is used if there is no destination for
+ * a message: the type of the message isn't routed, no one rule matches, or
+ * the key is out of range.
+ *
+ * \attention
+ * It's impossible to subscribe to a routed message type (or to set a
+ * delivery filter for it) via content-based router mbox. An attempt to do
+ * that leads to an exception. Subscriptions to other message types are
+ * handled by the reaction passed to the builder (for example, a subscription
+ * is redirected to the default destination by redirect_if_no_destination()).
+ *
+ * \note
+ * Predicates and key extractors are called on every send, in the context of
+ * the sender, possibly from several threads at the same time. They have to
+ * be thread safe and shouldn't block.
+ *
+ * \note
+ * Messages can't be signals because a signal has no content.
+ *
+ * \attention
+ * An instance of mbox_builder_t isn't thread safe.
+ *
+ * \since v.1.7.0
+ */
+class mbox_builder_t
+	{
+		friend mbox_builder_t
+		builder(
+			mbox_type_t mbox_type,
+			no_destination_reaction_t no_destination_reaction );
+
+		//! Initializing constructor.
+		mbox_builder_t(
+			//! Type of mbox to be created.
+			mbox_type_t mbox_type,
+			//! Reaction to a message without a destination.
+			no_destination_reaction_t no_destination_reaction )
+			:	m_mbox_type{ mbox_type }
+			,	m_no_destination_reaction{ std::move(no_destination_reaction) }
+			{}
+
+	public:
+		~mbox_builder_t() noexcept = default;
+
+		/*!
+		 * \brief Add a rule for a message type.
+		 *
+		 * Rules for a message type are checked in the order of their addition.
+		 *
+		 * Usage example:
+		 * \code
+		 * using namespace so_5::extra::mboxes::content_router;
+		 *
+		 * auto my_builder = multi_consumer_builder(drop_if_no_destination());
+		 * my_builder.add_rule<order>(
+		 * 		[](const order & o) { return o.m_priority > 5; },
+		 * 		urgent_orders_mbox);
+		 * // The last rule that is always true works as the default destination
+		 * // for order messages.
+		 * my_builder.add_rule<order>(
+		 * 		[](const order &) { return true; },
+		 * 		other_orders_mbox);
+		 * auto result_mbox = my_builder.make(env);
+		 * \endcode
+		 *
+		 * If a type for mutable message has to be specified then
+		 * so_5::mutable_msg marker should be used (only for MPSC router).
+		 *
+		 * \attention
+		 * An exception will be thrown if Msg_Type is already routed by a key.
+		 *
+		 * \tparam Msg_Type type of message to be routed.
+		 *
+		 * \tparam Predicate type of predicate. Has to be callable with
+		 * the signature `bool(const Payload &)`.
+		 */
+		template< typename Msg_Type, typename Predicate >
+		mbox_builder_t &
+		add_rule( Predicate && predicate, mbox_t dest_mbox ) &
+			{
+				ensure_valid_destination< Msg_Type >( dest_mbox );
+
+				using router_t = impl::rules_router_t< Msg_Type >;
+
+				auto & router_ptr = m_routes[
+						message_payload_type< Msg_Type >::subscription_type_index() ];
+				if( !router_ptr )
+					router_ptr = std::make_unique< router_t >();
+
+				auto * router = dynamic_cast< router_t * >( router_ptr.get() );
+				if( !router )
+					SO_5_THROW_EXCEPTION(
+							errors::rc_different_routing_scheme_for_message_type,
+							"message type is already routed by a key, "
+							"msg_type=" + std::string(typeid(Msg_Type).name()) );
+
+				router->add(
+						typename router_t::predicate_t{
+								std::forward<Predicate>(predicate) },
+						std::move(dest_mbox) );
+
+				return *this;
+			}
+
+		/*!
+		 * \brief Add a rule for a message type.
+		 *
+		 * Usage example:
+		 * \code
+		 * using namespace so_5::extra::mboxes::content_router;
+		 *
+		 * auto result_mbox = single_consumer_builder(throw_if_no_destination())
+		 * 	.add_rule< so_5::mutable_msg<order> >(
+		 * 		[](const order & o) { return o.m_priority > 5; },
+		 * 		urgent_orders_mbox)
+		 * 	.make(env);
+		 * \endcode
+		 *
+		 * \attention
+		 * An exception will be thrown if Msg_Type is already routed by a key.
+		 *
+		 * \tparam Msg_Type type of message to be routed.
+		 *
+		 * \tparam Predicate type of predicate. Has to be callable with
+		 * the signature `bool(const Payload &)`.
+		 */
+		template< typename Msg_Type, typename Predicate >
+		[[nodiscard]]
+		mbox_builder_t &&
+		add_rule( Predicate && predicate, mbox_t dest_mbox ) &&
+			{
+				return std::move( add_rule< Msg_Type >(
+						std::forward<Predicate>(predicate),
+						std::move(dest_mbox) ) );
+			}
+
+		/*!
+		 * \brief Add routing by a small integer key for a message type.
+		 *
+		 * The value returned by \a key_extractor is used as an index in
+		 * \a targets. If the value is out of range or the corresponding
+		 * item in \a targets is nullptr then the message has no destination.
+		 *
+		 * Usage example:
+		 * \code
+		 * using namespace so_5::extra::mboxes::content_router;
+		 *
+		 * auto my_builder = multi_consumer_builder(drop_if_no_destination());
+		 * my_builder.add_by_key<quote>(
+		 * 		[](const quote & q) { return q.m_venue_id; },
+		 * 		{ venue_0_mbox, venue_1_mbox, venue_2_mbox });
+		 * auto result_mbox = my_builder.make(env);
+		 * \endcode
+		 *
+		 * \note
+		 * \a targets is a dense array: its size is determined by the maximum
+		 * value of the key. So this routing scheme should be used only
+		 * if the key values are small. Rules (see add_rule()) should be used
+		 * otherwise.
+		 *
+		 * \attention
+		 * An exception will be thrown if Msg_Type is already routed.
+		 *
+		 * \tparam Msg_Type type of message to be routed.
+		 *
+		 * \tparam Key_Extractor type of function object. Has to be callable
+		 * with the signature `Integer_Type(const Payload &)`.
+		 */
+		template< typename Msg_Type, typename Key_Extractor >
+		mbox_builder_t &
+		add_by_key(
+			Key_Extractor && key_extractor,
+			std::vector< mbox_t > targets ) &
+			{
+				for( const auto & dest : targets )
+					if( dest )
+						ensure_valid_destination< Msg_Type >( dest );
+
+				using router_t = impl::dense_key_router_t<
+						Msg_Type,
+						std::decay_t< Key_Extractor > >;
+
+				static_assert(
+						std::is_integral_v< std::decay_t< decltype(
+								std::declval< const std::decay_t< Key_Extractor > & >()(
+										std::declval< const typename router_t::payload_type & >() )
+							) > >,
+						"Key_Extractor has to return a value of an integral type" );
+
+				auto & router_ptr = m_routes[
+						message_payload_type< Msg_Type >::subscription_type_index() ];
+				if( router_ptr )
+					SO_5_THROW_EXCEPTION(
+							errors::rc_different_routing_scheme_for_message_type,
+							"message type is already routed, "
+							"msg_type=" + std::string(typeid(Msg_Type).name()) );
+
+				router_ptr = std::make_unique< router_t >(
+						std::forward<Key_Extractor>(key_extractor),
+						std::move(targets) );
+
+				return *this;
+			}
+
+		/*!
+		 * \brief Add routing by a small integer key for a message type.
+		 *
+		 * Usage example:
+		 * \code
+		 * using namespace so_5::extra::mboxes::content_router;
+		 *
+		 * auto result_mbox = multi_consumer_builder(drop_if_no_destination())
+		 * 	.add_by_key<quote>(
+		 * 		[](const quote & q) { return q.m_venue_id; },
+		 * 		{ venue_0_mbox, venue_1_mbox, venue_2_mbox })
+		 * 	.make(env);
+		 * \endcode
+		 *
+		 * \attention
+		 * An exception will be thrown if Msg_Type is already routed.
+		 *
+		 * \tparam Msg_Type type of message to be routed.
+		 *
+		 * \tparam Key_Extractor type of function object. Has to be callable
+		 * with the signature `Integer_Type(const Payload &)`.
+		 */
+		template< typename Msg_Type, typename Key_Extractor >
+		[[nodiscard]]
+		mbox_builder_t &&
+		add_by_key(
+			Key_Extractor && key_extractor,
+			std::vector< mbox_t > targets ) &&
+			{
+				return std::move( add_by_key< Msg_Type >(
+						std::forward<Key_Extractor>(key_extractor),
+						std::move(targets) ) );
+			}
+
+		/*!
+		 * \brief Make a content-based router mbox.
+		 *
+		 * The created mbox will be based on information added to builder
+		 * before calling make() method.
+		 *
+		 * It's guaranteed that the builder object will be in some correct
+		 * state after make() returns. It means that builder can be safely
+		 * deleted or can obtain a new value as the result of assignement.
+		 * But it isn't guaranteed ther the builder will hold values previously
+		 * stored to it by add_rule()/add_by_key() methods.
+		 */
+		[[nodiscard]]
+		mbox_t
+		make( environment_t & env )
+			{
+				return env.make_custom_mbox(
+						[this]( const mbox_creation_data_t & data )
+						{
+							impl::mbox_data_t mbox_data{
+									data.m_env.get(),
+									data.m_id,
+									m_mbox_type,
+									std::move(m_no_destination_reaction.reaction()),
+									routes_to_vector()
+								};
+							mbox_t result;
+
+							if( data.m_tracer.get().is_msg_tracing_enabled() )
+								{
+									using ::so_5::impl::msg_tracing_helpers::
+											tracing_enabled_base;
+									using T = impl::actual_mbox_t< tracing_enabled_base >;
+
+									result = mbox_t{ new T{
+											std::move(mbox_data),
+											data.m_tracer
+										} };
+								}
+							else
+								{
+									using ::so_5::impl::msg_tracing_helpers::
+											tracing_disabled_base;
+									using T = impl::actual_mbox_t< tracing_disabled_base >;
+
+									result = mbox_t{ new T{ std::move(mbox_data) } };
+								}
+
+							return result;
+						} );
+			}
+
+	private:
+		//! Type of container for routers.
+		using route_map_t = std::map< std::type_index, impl::type_router_unique_ptr_t >;
+
+		//! Type of mbox to be created.
+		mbox_type_t m_mbox_type;
+
+		//! Reaction to a message without a destination.
+		no_destination_reaction_t m_no_destination_reaction;
+
+		//! Routers for message types.
+		route_map_t m_routes;
+
+		/*!
+		 * \brief Check that a mbox can be used as a destination for
+		 * a message type.
+		 */
+		template< typename Msg_Type >
+		void
+		ensure_valid_destination( const mbox_t & dest_mbox ) const
+			{
+				static_assert( !is_signal< typename message_payload_type<
+								Msg_Type >::payload_type >::value,
+						"signal can't be routed by its content" );
+
+				if( !dest_mbox )
+					SO_5_THROW_EXCEPTION(
+							errors::rc_null_as_destination_mbox,
+							"nullptr can't be used as the destination mbox, "
+							"msg_type=" + std::string(typeid(Msg_Type).name()) );
+
+				// Use of mutable message type for MPMC mbox should be prohibited.
+				if constexpr( is_mutable_message< Msg_Type >::value )
+					{
+						if( mbox_type_t::multi_producer_multi_consumer == m_mbox_type )
+							SO_5_THROW_EXCEPTION(
+									so_5::rc_mutable_msg_cannot_be_delivered_via_mpmc_mbox,
+									"mutable message can't handled with MPMC router, "
+									"msg_type=" + std::string(typeid(Msg_Type).name()) );
+
+						if( mbox_type_t::multi_producer_multi_consumer ==
+								dest_mbox->type() )
+							SO_5_THROW_EXCEPTION(
+									errors::rc_mpmc_sink_can_be_used_with_mpsc_router,
+									"MPMC mbox can't be added as a target to MPSC "
+									"router and mutable message, "
+									"msg_type=" + std::string(typeid(Msg_Type).name()) );
+					}
+			}
+
+		/*!
+		 * \return A vector of routers that should be passed to
+		 * impl::actual_mbox_t constructor. That vector is guaranteed to be
+		 * sorted (it means that binary search can be used for searching
+		 * message types).
+		 */
+		[[nodiscard]]
+		impl::routed_type_container_t
+		routes_to_vector()
+			{
+				impl::routed_type_container_t result;
+				result.reserve( m_routes.size() );
+
+				// Use the fact that items in std::map are ordered by keys.
+				for( auto & [k, v] : m_routes )
+					result.emplace_back( k, std::move(v) );
+
+				m_routes.clear();
+
+				return result;
+			}
+	};
+
+/*!
+ * \brief Factory function for making mbox_builder.
+ *
+ * Usage example:
+ * \code
+ * using namespace so_5::extra::mboxes::content_router;
+ *
+ * auto result_mbox = builder(
+ * 		so_5::mbox_type_t::multi_producer_multi_consumer,
+ * 		redirect_if_no_destination(default_mbox))
+ * 	.add_rule<order>(
+ * 		[](const order & o) { return o.m_priority > 5; },
+ * 		urgent_orders_mbox)
+ * 	.make(env);
+ * \endcode
+ *
+ * \since v.1.7.0
+ */
+[[nodiscard]]
+inline mbox_builder_t
+builder(
+	//! Type of new mbox: MPMC or MPSC.
+	mbox_type_t mbox_type,
+	//! What to do if there is no destination for a message.
+	no_destination_reaction_t no_destination_reaction )
+	{
+		return { mbox_type, std::move(no_destination_reaction) };
+	}
+
+/*!
+ * \brief Factory function for making mbox_builder that produces MPMC
+ * content-based router mbox.
+ *
+ * \since v.1.7.0
+ */
+[[nodiscard]]
+inline mbox_builder_t
+multi_consumer_builder(
+	//! What to do if there is no destination for a message.
+	no_destination_reaction_t no_destination_reaction )
+	{
+		return builder(
+				mbox_type_t::multi_producer_multi_consumer,
+				std::move(no_destination_reaction) );
+	}
+
+/*!
+ * \brief Factory function for making mbox_builder that produces MPSC
+ * content-based router mbox.
+ *
+ * \since v.1.7.0
+ */
+[[nodiscard]]
+inline mbox_builder_t
+single_consumer_builder(
+	//! What to do if there is no destination for a message.
+	no_destination_reaction_t no_destination_reaction )
+	{
+		return builder(
+				mbox_type_t::multi_producer_single_consumer,
+				std::move(no_destination_reaction) );
+	}
+
+} /* namespace content_router */
+
+} /* namespace mboxes */
+
+} /* namespace extra */
+
+} /* namespace so_5 */
@@ -15,17 +15,30 @@
 #endif
 
 #include <so_5_extra/error_ranges.hpp>
+#include <so_5_extra/mboxes/impl/delivery_snapshot_holder.hpp>
+#include <so_5_extra/mboxes/proxy.hpp>
 
 #include <so_5/impl/msg_tracing_helpers.hpp>
 #include <so_5/impl/local_mbox_basic_subscription_info.hpp>
 
 #include <so_5/details/sync_helpers.hpp>
 #include <so_5/details/invoke_noexcept_code.hpp>
+#include <so_5/details/rollback_on_exception.hpp>
 
 #include <so_5/mbox.hpp>
 #include <so_5/send_functions.hpp>
-
+#include <so_5/timers.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <string_view>
+#include <thread>
+#include <vector>
 
 namespace so_5 {
 
@@ -141,6 +154,42 @@ struct msg_first_subscriber final : public so_5::signal_t {};
  */
 struct msg_last_subscriber final : public so_5::signal_t {};
 
+/*!
+ * \brief Message to be sent when the first subscriber for a message type
+ * arrives to multi-type mbox.
+ *
+ * See make_multi_type_mbox() for usage example.
+ *
+ * \since v.1.7.0
+ */
+struct msg_first_subscriber_for_type final : public so_5::message_t
+	{
+		//! Type of message for that the first subscriber arrived.
+		const std::type_index m_msg_type;
+
+		explicit msg_first_subscriber_for_type( std::type_index msg_type )
+			:	m_msg_type{ msg_type }
+			{}
+	};
+
+/*!
+ * \brief Message to be sent when the last subscriber for a message type
+ * gone from multi-type mbox.
+ *
+ * See make_multi_type_mbox() for usage example.
+ *
+ * \since v.1.7.0
+ */
+struct msg_last_subscriber_for_type final : public so_5::message_t
+	{
+		//! Type of message for that the last subscriber gone.
+		const std::type_index m_msg_type;
+
+		explicit msg_last_subscriber_for_type( std::type_index msg_type )
+			:	m_msg_type{ msg_type }
+			{}
+	};
+
 namespace details {
 
 /*!
@@ -151,6 +200,214 @@ namespace details {
 using subscriber_info_t =
 		so_5::impl::local_mbox_details::subscription_info_without_sink_t;
 
+//
+// pending_last_notification_t
+//
+/*!
+ * \brief A state of the last subscriber notification that waits for
+ * the end of grace period.
+ *
+ * The notification either expires (when the timer fires at the end of
+ * grace period) or is cancelled (when a new subscriber arrives before
+ * the end of grace period). Only one of those outcomes is possible.
+ *
+ * \note
+ * The outcome doesn't depend on the receiver of the notification:
+ * the notification expires even if nobody handles it.
+ *
+ * \since v.1.7.0
+ */
+class pending_last_notification_t final : public so_5::atomic_refcounted_t
+	{
+		//! Possible states of the notification.
+		enum class status_t
+			{
+				pending,
+				expired,
+				cancelled
+			};
+
+		//! The current state.
+		std::atomic< status_t > m_status{ status_t::pending };
+
+	public:
+		//! Try to mark the notification as expired.
+		/*!
+		 * \retval true if the notification wasn't cancelled.
+		 */
+		[[nodiscard]]
+		bool
+		try_expire() noexcept
+			{
+				auto expected = status_t::pending;
+				return m_status.compare_exchange_strong(
+						expected, status_t::expired, std::memory_order_acq_rel );
+			}
+
+		//! Try to cancel the notification.
+		/*!
+		 * \retval true if the notification was cancelled.
+		 * \retval false if the notification has already expired.
+		 */
+		[[nodiscard]]
+		bool
+		try_cancel() noexcept
+			{
+				auto expected = status_t::pending;
+				return m_status.compare_exchange_strong(
+						expected, status_t::cancelled, std::memory_order_acq_rel );
+			}
+	};
+
+//! Type of smart pointer to pending_last_notification_t.
+using pending_last_notification_ref_t =
+		so_5::intrusive_ptr_t< pending_last_notification_t >;
+
+//
+// grace_period_timer_mbox_t
+//
+/*!
+ * \brief A mbox to be used as the target of the timer for the delayed
+ * notification about the last subscriber.
+ *
+ * The notification is forwarded to the actual destination only if it
+ * wasn't cancelled. The notification is marked as expired at the moment
+ * of the forwarding, so a new subscriber that arrives after that will
+ * lead to msg_first_subscriber that goes after msg_last_subscriber.
+ *
+ * \since v.1.7.0
+ */
+class grace_period_timer_mbox_t final
+	:	public ::so_5::extra::mboxes::proxy::simple_t
+	{
+		using base_type_t = ::so_5::extra::mboxes::proxy::simple_t;
+
+		//! The state of the notification.
+		const pending_last_notification_ref_t m_pending;
+
+	public:
+		grace_period_timer_mbox_t(
+			mbox_t dest,
+			pending_last_notification_ref_t pending )
+			:	base_type_t{ std::move(dest) }
+			,	m_pending{ std::move(pending) }
+			{}
+
+		void
+		do_deliver_message(
+			message_delivery_mode_t delivery_mode,
+			const std::type_index & msg_type,
+			const message_ref_t & message,
+			unsigned int redirection_deep ) override
+			{
+				if( m_pending->try_expire() )
+					base_type_t::do_deliver_message(
+							delivery_mode,
+							msg_type,
+							message,
+							redirection_deep );
+				// Otherwise the notification should be ignored.
+			}
+	};
+
+//
+// notification_sender_t
+//
+/*!
+ * \brief Helper for sending the first/last subscriber notifications.
+ *
+ * If the grace period is zero then notifications are sent immediately.
+ *
+ * Otherwise the last subscriber notification is sent as a delayed message
+ * and the first subscriber notification cancels the pending last
+ * notification if the grace period isn't finished yet. In that case both
+ * notifications are suppressed because the receiver hasn't been informed
+ * about the absence of subscribers.
+ *
+ * \note
+ * This class isn't thread safe. It's expected that it's used under
+ * the mbox's lock.
+ *
+ * \since v.1.7.0
+ */
+class notification_sender_t
+	{
+		//! How long the number of subscribers has to stay at zero
+		//! before the last subscriber notification is sent.
+		const std::chrono::steady_clock::duration m_grace_period;
+
+		//! The last subscriber notification that waits for the end of
+		//! grace period.
+		/*!
+		 * \note
+		 * It's nullptr if there is no pending notification.
+		 */
+		pending_last_notification_ref_t m_pending_last;
+
+	public:
+		explicit notification_sender_t(
+			std::chrono::steady_clock::duration grace_period ) noexcept
+			:	m_grace_period{ grace_period }
+			{}
+
+		//! Handle the arrival of the first subscriber.
+		template< typename Msg, typename... Args >
+		void
+		first_subscriber_arrived(
+			const mbox_t & dest,
+			Args &&... args )
+			{
+				if( m_pending_last )
+					{
+						const bool cancelled = m_pending_last->try_cancel();
+						m_pending_last.reset();
+
+						// Subscribers have come back before the end of
+						// grace period. There is no need to inform anyone.
+						// NOTE: if the grace period is over then the last
+						// subscriber notification has already been sent
+						// and the first subscriber notification is necessary.
+						if( cancelled )
+							return;
+					}
+
+				so_5::send< Msg >( dest, std::forward< Args >(args)... );
+			}
+
+		//! Handle the removal of the last subscriber.
+		template< typename Msg, typename... Args >
+		void
+		last_subscriber_gone(
+			const mbox_t & dest,
+			Args &&... args )
+			{
+				if( m_grace_period <= std::chrono::steady_clock::duration::zero() )
+					{
+						so_5::send< Msg >( dest, std::forward< Args >(args)... );
+						return;
+					}
+
+				message_ref_t payload;
+				if constexpr( !is_signal< Msg >::value )
+					payload = message_ref_t{
+							std::make_unique< Msg >( std::forward< Args >(args)... )
+						};
+
+				pending_last_notification_ref_t pending{
+						new pending_last_notification_t{}
+					};
+
+				so_5::low_level_api::single_timer(
+						typeid(Msg),
+						std::move(payload),
+						mbox_t{ std::make_unique< grace_period_timer_mbox_t >(
+								dest, pending ) },
+						m_grace_period );
+
+				m_pending_last = std::move(pending);
+			}
+	};
+
 //
 // template_independent_mbox_data_t
 //
@@ -211,15 +468,20 @@ struct template_independent_mbox_data_t
 		 */
 		std::size_t m_subscriptions_count{};
 
+		//! Sender of notifications.
+		notification_sender_t m_notification_sender;
+
 		template_independent_mbox_data_t(
 			environment_t & env,
 			mbox_id_t id,
 			mbox_t notification_mbox,
-			mbox_type_t mbox_type )
+			mbox_type_t mbox_type,
+			std::chrono::steady_clock::duration grace_period )
 			:	m_env{ env }
 			,	m_id{ id }
 			,	m_notification_mbox{ std::move(notification_mbox) }
 			,	m_mbox_type{ mbox_type }
+			,	m_notification_sender{ grace_period }
 		{}
 	};
 
@@ -264,10 +526,12 @@ class actual_mbox_t final
 			mbox_t notification_mbox,
 			//! Type of this mbox (MPSC or MPMC).
 			mbox_type_t mbox_type,
+			//! Grace period for the last subscriber notification.
+			std::chrono::steady_clock::duration grace_period,
 			//! Optional parameters for Tracing_Base's constructor.
 			Tracing_Args &&... args )
 			:	Tracing_Base{ std::forward< Tracing_Args >(args)... }
-			,	m_data{ env, id, std::move(notification_mbox), mbox_type }
+			,	m_data{ env, id, std::move(notification_mbox), mbox_type, grace_period }
 			{
 				// Use of mutable message type for MPMC mbox should be prohibited.
 				if constexpr( is_mutable_message< Msg_Type >::value )
@@ -505,8 +769,9 @@ class actual_mbox_t final
 								1u == this->m_data.m_subscriptions_count )
 							{
 								// We've got the first subscriber.
-								so_5::send< msg_first_subscriber >(
-										this->m_data.m_notification_mbox );
+								this->m_data.m_notification_sender
+										.template first_subscriber_arrived< msg_first_subscriber >(
+												this->m_data.m_notification_mbox );
 							}
 					} );
 			}
@@ -548,8 +813,9 @@ class actual_mbox_t final
 										0u == this->m_data.m_subscriptions_count )
 								{
 									// We've lost the last subscriber.
-									so_5::send< msg_last_subscriber >(
-											this->m_data.m_notification_mbox );
+									this->m_data.m_notification_sender
+											.template last_subscriber_gone< msg_last_subscriber >(
+													this->m_data.m_notification_mbox );
 								}
 							} );
 					}
@@ -637,157 +903,870 @@ class actual_mbox_t final
 			}
 	};
 
-} /* namespace details */
-
 //
-// make_mbox
+// delivery_snapshot_holder_t
 //
+using ::so_5::extra::mboxes::impl::delivery_snapshot_holder_t;
+
 /*!
- * \brief Create an instance of first_last_subscriber_notification mbox.
- *
- * Usage examples:
- *
- * Create a MPMC mbox with std::mutex as Lock_Type (this mbox can safely be
- * used in multi-threaded environments):
- * \code
- * namespace mbox_ns = so_5::extra::mboxes::first_last_subscriber_notification;
- * so_5::environment_t & env = ...;
- * auto notification_mbox = env.create_mbox();
- * auto mbox = mbox_ns::make_mbox<my_message>(
- * 		env,
- * 		notification_mbox,
- * 		so_5::mbox_type_t::multi_producer_multi_consumer);
- * \endcode
+ * \brief Info about one subscriber inside delivery snapshot.
  *
- * Create a MPSC mbox with std::mutex as Lock_Type (this mbox can safely be
- * used in multi-threaded environments):
- * \code
- * namespace mbox_ns = so_5::extra::mboxes::first_last_subscriber_notification;
- * so_5::environment_t & env = ...;
- * auto notification_mbox = env.create_mbox();
- * auto mbox = mbox_ns::make_mbox<my_message>(
- * 		env,
- * 		notification_mbox,
- * 		so_5::mbox_type_t::multi_producer_single_consumer);
- * \endcode
+ * \since v.1.7.0
+ */
+struct snapshot_subscriber_t
+	{
+		abstract_message_sink_t * m_sink;
+		subscriber_info_t m_info;
+	};
+
+/*!
+ * \brief Type of list of subscribers for one message type.
  *
- * Create a MPMC mbox with so_5::null_mutex_t as Lock_Type (this mbox can only
- * be used in single-threaded environments):
- * \code
- * namespace mbox_ns = so_5::extra::mboxes::first_last_subscriber_notification;
- * so_5::environment_t & env = ...;
- * auto notification_mbox = env.create_mbox();
- * auto mbox = mbox_ns::make_mbox<my_message, so_5::null_mutex_t>(
- * 		env,
- * 		notification_mbox,
- * 		so_5::mbox_type_t::multi_producer_multi_consumer);
- * \endcode
+ * \note
+ * The order of subscribers is the same as the order in
+ * template_independent_mbox_data_t::subscribers_map_t (it means
+ * that priorities of sinks are respected).
  *
- * \attention
- * This type of mbox terminates the whole application if an attempt
- * to send a notification (in form of msg_first_subscriber and msg_last_subscriber
- * signals) throws.
+ * \since v.1.7.0
+ */
+using snapshot_subscriber_list_t = std::vector< snapshot_subscriber_t >;
+
+/*!
+ * \brief Type of shared pointer to list of subscribers.
  *
- * \tparam Msg_Type type of message to be used with a new mbox.
+ * Lists for types that aren't changed are shared between snapshots.
  *
- * \tparam Lock_Type type of lock to be used for thread safety. It can be
- * std::mutex or so_5::null_mutex_t (or any other type which can be used
- * with std::lock_quard).
+ * \since v.1.7.0
+ */
+using snapshot_subscriber_list_shptr_t =
+		std::shared_ptr< const snapshot_subscriber_list_t >;
+
+//
+// delivery_snapshot_t
+//
+/*!
+ * \brief Immutable snapshot of subscribers to be used for message delivery.
  *
- * \since v.1.5.2
+ * \since v.1.7.0
  */
-template<
-	typename Msg_Type,
-	typename Lock_Type = std::mutex >
-[[nodiscard]]
-mbox_t
-make_mbox(
-	//! SObjectizer Environment to work in.
-	environment_t & env,
-	//! Mbox for notifications about the first/last subscriber.
-	mbox_t notification_mbox,
-	//! Type of this mbox (MPSC or MPMC).
-	mbox_type_t mbox_type )
+struct delivery_snapshot_t
 	{
-		return env.make_custom_mbox(
-				[&notification_mbox, mbox_type]( const mbox_creation_data_t & data )
-				{
-					mbox_t result;
+		//! Type of info about one message type.
+		using item_t = std::pair< std::type_index, snapshot_subscriber_list_shptr_t >;
 
-					if( data.m_tracer.get().is_msg_tracing_enabled() )
-						{
-							using T = details::actual_mbox_t<
-									Msg_Type,
-									Lock_Type,
-									::so_5::impl::msg_tracing_helpers::tracing_enabled_base >;
+		//! Subscribers for message types.
+		/*!
+		 * \attention
+		 * It's sorted by message type.
+		 */
+		std::vector< item_t > m_types;
 
-							result = mbox_t{ new T{
-									data.m_env.get(),
-									data.m_id,
-									std::move(notification_mbox),
-									mbox_type,
-									data.m_tracer
-								} };
-						}
-					else
-						{
-							using T = details::actual_mbox_t<
-									Msg_Type,
-									Lock_Type,
-									::so_5::impl::msg_tracing_helpers::tracing_disabled_base >;
-							result = mbox_t{ new T{
-									data.m_env.get(),
-									data.m_id,
-									std::move(notification_mbox),
-									mbox_type
-								} };
-						}
+		//! Find subscribers for a message type.
+		/*!
+		 * \return nullptr if there is no subscribers for \a msg_type.
+		 */
+		[[nodiscard]]
+		const snapshot_subscriber_list_t *
+		try_find( const std::type_index & msg_type ) const noexcept
+			{
+				const auto it = lower_bound_for( msg_type );
+				if( it != m_types.end() && it->first == msg_type )
+					return it->second.get();
+				return nullptr;
+			}
 
-					return result;
-				} );
-	}
+		//! Make a copy of snapshot with updated list for a message type.
+		/*!
+		 * If \a new_list is nullptr then \a msg_type is removed from
+		 * the new snapshot.
+		 */
+		[[nodiscard]]
+		std::unique_ptr< const delivery_snapshot_t >
+		make_updated(
+			const std::type_index & msg_type,
+			snapshot_subscriber_list_shptr_t new_list ) const
+			{
+				auto result = std::make_unique< delivery_snapshot_t >( *this );
+
+				auto & types = result->m_types;
+				const auto it = std::lower_bound(
+						types.begin(), types.end(), msg_type,
+						[]( const item_t & item, const std::type_index & t ) {
+							return item.first < t;
+						} );
+				const bool found = ( it != types.end() && it->first == msg_type );
+
+				if( new_list )
+					{
+						if( found )
+							it->second = std::move(new_list);
+						else
+							types.emplace( it, msg_type, std::move(new_list) );
+					}
+				else if( found )
+					types.erase( it );
+
+				return result;
+			}
+
+	private:
+		[[nodiscard]]
+		std::vector< item_t >::const_iterator
+		lower_bound_for( const std::type_index & msg_type ) const noexcept
+			{
+				return std::lower_bound(
+						m_types.begin(), m_types.end(), msg_type,
+						[]( const item_t & item, const std::type_index & t ) {
+							return item.first < t;
+						} );
+			}
+	};
 
 //
-// make_multi_consumer_mbox
+// multi_type_mbox_data_t
 //
 /*!
- * \brief Create an instance of first_last_subscriber_notification MPMC mbox.
- *
- * Usage examples:
- *
- * Create a MPMC mbox with std::mutex as Lock_Type (this mbox can safely be
- * used in multi-threaded environments):
- * \code
- * namespace mbox_ns = so_5::extra::mboxes::first_last_subscriber_notification;
- * so_5::environment_t & env = ...;
- * auto notification_mbox = env.create_mbox();
- * auto mbox = mbox_ns::make_multi_consumer_mbox<my_message>(
- * 		env,
- * 		notification_mbox);
- * \endcode
- *
- * \note
- * It's just a thin wrapper around make_mbox() template function.
+ * \brief Data of multi-type mbox that doesn't depend on template parameters.
  *
- * \sa make_mbox
- *
- * \since v.1.5.2
+ * \since v.1.7.0
  */
-template<
-	typename Msg_Type,
-	typename Lock_Type = std::mutex >
-[[nodiscard]]
-mbox_t
+struct multi_type_mbox_data_t
+	{
+		//! Type of subscribers map.
+		using subscribers_map_t =
+				template_independent_mbox_data_t::subscribers_map_t;
+
+		//! Info about subscribers for one message type.
+		struct per_type_data_t
+			{
+				//! Subscribers.
+				subscribers_map_t m_subscribers;
+
+				//! Number of actual subscriptions.
+				/*!
+				 * \note
+				 * See template_independent_mbox_data_t::m_subscriptions_count
+				 * for the explanation why it's necessary.
+				 */
+				std::size_t m_subscriptions_count{};
+			};
+
+		//! Type of map for all message types.
+		using types_map_t = std::map< std::type_index, per_type_data_t >;
+
+		//! Type of map of notification senders.
+		using notification_senders_map_t =
+				std::map< std::type_index, notification_sender_t >;
+
+		//! SObjectizer Environment to work in.
+		environment_t & m_env;
+
+		//! ID of the mbox.
+		const mbox_id_t m_id;
+
+		//! Mbox for notifications about the first/last subscribers.
+		const mbox_t m_notification_mbox;
+
+		//! Type of this mbox (MPMC or MPSC).
+		const mbox_type_t m_mbox_type;
+
+		//! Lock for modification of subscribers.
+		/*!
+		 * \note
+		 * It's not used for message delivery.
+		 */
+		std::mutex m_lock;
+
+		//! Info about subscribers.
+		/*!
+		 * \note
+		 * Can be accessed only when m_lock is acquired.
+		 */
+		types_map_t m_types;
+
+		//! Grace period for the last subscriber notifications.
+		const std::chrono::steady_clock::duration m_grace_period;
+
+		//! Senders of notifications for message types.
+		/*!
+		 * \note
+		 * A sender isn't removed when the last subscriber for
+		 * a message type gone because it may hold a pending
+		 * notification about the last subscriber.
+		 *
+		 * \note
+		 * Can be accessed only when m_lock is acquired.
+		 */
+		notification_senders_map_t m_notification_senders;
+
+		//! Snapshot for message delivery.
+		delivery_snapshot_holder_t< delivery_snapshot_t > m_snapshot;
+
+		multi_type_mbox_data_t(
+			environment_t & env,
+			mbox_id_t id,
+			mbox_t notification_mbox,
+			mbox_type_t mbox_type,
+			std::chrono::steady_clock::duration grace_period )
+			:	m_env{ env }
+			,	m_id{ id }
+			,	m_notification_mbox{ std::move(notification_mbox) }
+			,	m_mbox_type{ mbox_type }
+			,	m_grace_period{ grace_period }
+			,	m_snapshot{ std::make_unique< delivery_snapshot_t >() }
+		{}
+	};
+
+//
+// actual_multi_type_mbox_t
+//
+/*!
+ * \brief An actual implementation of first/last subscriber notification
+ * mbox for several message types.
+ *
+ * Modifications of subscribers are performed under the lock. Every
+ * modification creates a new delivery snapshot. Message delivery uses
+ * the current snapshot and doesn't acquire any locks.
+ *
+ * \tparam Tracing_Base base class with implementation of message
+ * delivery tracing methods.
+ *
+ * \since v.1.7.0
+ */
+template< typename Tracing_Base >
+class actual_multi_type_mbox_t final
+	:	public abstract_message_box_t
+	,	private Tracing_Base
+	{
+		using per_type_data_t = multi_type_mbox_data_t::per_type_data_t;
+
+	public:
+		/*!
+		 * \brief Initializing constructor.
+		 *
+		 * \tparam Tracing_Args parameters for Tracing_Base constructor
+		 * (can be empty list if Tracing_Base have only the default constructor).
+		 */
+		template< typename... Tracing_Args >
+		actual_multi_type_mbox_t(
+			//! SObjectizer Environment to work in.
+			environment_t & env,
+			//! ID of this mbox.
+			mbox_id_t id,
+			//! Mbox for notifications about the first/last subscriber.
+			mbox_t notification_mbox,
+			//! Type of this mbox (MPSC or MPMC).
+			mbox_type_t mbox_type,
+			//! Grace period for the last subscriber notification.
+			std::chrono::steady_clock::duration grace_period,
+			//! Optional parameters for Tracing_Base's constructor.
+			Tracing_Args &&... args )
+			:	Tracing_Base{ std::forward< Tracing_Args >(args)... }
+			,	m_data{ env, id, std::move(notification_mbox), mbox_type, grace_period }
+			{}
+
+		mbox_id_t
+		id() const override
+			{
+				return this->m_data.m_id;
+			}
+
+		void
+		subscribe_event_handler(
+			const std::type_index & msg_type,
+			abstract_message_sink_t & subscriber ) override
+			{
+				insert_or_modify_subscriber(
+						msg_type,
+						subscriber,
+						[] {
+							return subscriber_info_t{
+									subscriber_info_t::subscription_present_t{}
+								};
+						},
+						[]( subscriber_info_t & info ) {
+							info.subscription_defined();
+						},
+						[]( per_type_data_t & data ) {
+							data.m_subscriptions_count += 1u;
+						} );
+			}
+
+		void
+		unsubscribe_event_handler(
+			const std::type_index & msg_type,
+			abstract_message_sink_t & subscriber ) noexcept override
+			{
+				modify_and_remove_subscriber_if_needed(
+						msg_type,
+						subscriber,
+						[]( subscriber_info_t & info ) {
+							info.subscription_dropped();
+						},
+						[]( per_type_data_t & data ) {
+							data.m_subscriptions_count -= 1u;
+						} );
+			}
+
+		std::string
+		query_name() const override
+			{
+				std::ostringstream s;
+				s << "<mbox:type=FIRST_LAST_SUBSCR_NOTIFY_MULTI_TYPE";
+
+				switch( this->m_data.m_mbox_type )
+					{
+					case mbox_type_t::multi_producer_multi_consumer:
+						s << "(MPMC)";
+					break;
+
+					case mbox_type_t::multi_producer_single_consumer:
+						s << "(MPSC)";
+					break;
+					}
+
+				s << ":id=" << this->m_data.m_id << ">";
+
+				return s.str();
+			}
+
+		mbox_type_t
+		type() const override
+			{
+				return this->m_data.m_mbox_type;
+			}
+
+		void
+		do_deliver_message(
+			message_delivery_mode_t delivery_mode,
+			const std::type_index & msg_type,
+			const message_ref_t & message,
+			unsigned int redirection_deep ) override
+			{
+				ensure_immutable_message( msg_type, message );
+
+				typename Tracing_Base::deliver_op_tracer tracer{
+						*this, // as Tracing_base
+						*this, // as abstract_message_box_t
+						"deliver_message",
+						delivery_mode,
+						msg_type, message, redirection_deep };
+
+				// NOTE: there is no locking here.
+				const auto reader = this->m_data.m_snapshot.acquire();
+
+				const auto * subscribers = reader.value().try_find( msg_type );
+				if( subscribers )
+					for( const auto & s : *subscribers )
+						do_deliver_message_to_subscriber(
+								*(s.m_sink),
+								s.m_info,
+								tracer,
+								delivery_mode,
+								msg_type,
+								message,
+								redirection_deep );
+				else
+					tracer.no_subscribers();
+			}
+
+		void
+		set_delivery_filter(
+			const std::type_index & msg_type,
+			const delivery_filter_t & filter,
+			abstract_message_sink_t & subscriber ) override
+			{
+				insert_or_modify_subscriber(
+						msg_type,
+						subscriber,
+						[&filter] {
+							return subscriber_info_t{ filter };
+						},
+						[&filter]( subscriber_info_t & info ) {
+							info.set_filter( filter );
+						},
+						[]( per_type_data_t & ) { /* nothing to do */ } );
+			}
+
+		void
+		drop_delivery_filter(
+			const std::type_index & msg_type,
+			abstract_message_sink_t & subscriber ) noexcept override
+			{
+				modify_and_remove_subscriber_if_needed(
+						msg_type,
+						subscriber,
+						[]( subscriber_info_t & info ) {
+							info.drop_filter();
+						},
+						[]( per_type_data_t & ) { /* nothing to do */ } );
+			}
+
+		so_5::environment_t &
+		environment() const noexcept override
+			{
+				return this->m_data.m_env;
+			}
+
+	private :
+		//! Data of this message mbox.
+		multi_type_mbox_data_t m_data;
+
+		/*!
+		 * \brief Make a list of subscribers for delivery snapshot.
+		 *
+		 * \return nullptr if there is no subscribers.
+		 */
+		[[nodiscard]]
+		static snapshot_subscriber_list_shptr_t
+		make_subscriber_list( const per_type_data_t & data )
+			{
+				if( data.m_subscribers.empty() )
+					return {};
+
+				auto list = std::make_shared< snapshot_subscriber_list_t >();
+				list->reserve( data.m_subscribers.size() );
+				for( const auto & [sink, info] : data.m_subscribers )
+					list->push_back( snapshot_subscriber_t{ sink, info } );
+
+				return list;
+			}
+
+		/*!
+		 * \brief Send notifications if the number of subscriptions changed
+		 * from 0 to 1 or from 1 to 0.
+		 */
+		void
+		send_notification_if_needed(
+			notification_sender_t & sender,
+			const std::type_index & msg_type,
+			std::size_t old_subscriptions_count,
+			std::size_t new_subscriptions_count ) noexcept
+			{
+				// All following actions shouldn't throw.
+				so_5::details::invoke_noexcept_code( [&]()
+					{
+						if( old_subscriptions_count < new_subscriptions_count &&
+								1u == new_subscriptions_count )
+							{
+								// We've got the first subscriber.
+								sender.first_subscriber_arrived<
+												msg_first_subscriber_for_type >(
+										this->m_data.m_notification_mbox,
+										msg_type );
+							}
+						else if( old_subscriptions_count > new_subscriptions_count &&
+								0u == new_subscriptions_count )
+							{
+								// We've lost the last subscriber.
+								sender.last_subscriber_gone<
+												msg_last_subscriber_for_type >(
+										this->m_data.m_notification_mbox,
+										msg_type );
+							}
+					} );
+			}
+
+		template<
+			typename Info_Maker,
+			typename Info_Changer,
+			typename Post_Action >
+		void
+		insert_or_modify_subscriber(
+			const std::type_index & msg_type,
+			abstract_message_sink_t & subscriber,
+			Info_Maker maker,
+			Info_Changer changer,
+			Post_Action post_action )
+			{
+				std::lock_guard< std::mutex > lock( this->m_data.m_lock );
+
+				// Sender of notifications has to exist before the first
+				// subscriber will be added.
+				notification_sender_t & sender =
+						this->m_data.m_notification_senders.try_emplace(
+								msg_type, this->m_data.m_grace_period ).first->second;
+
+				auto & types = this->m_data.m_types;
+				const auto emplace_result = types.try_emplace( msg_type );
+				const auto it_type = emplace_result.first;
+				const bool inserted = emplace_result.second;
+
+				so_5::details::do_with_rollback_on_exception(
+					[&] {
+						// All changes are made in a copy. The original data
+						// will be replaced only when the new snapshot is ready.
+						per_type_data_t updated{ it_type->second };
+
+						auto it_subscriber = updated.m_subscribers.find(
+								std::addressof(subscriber) );
+						if( it_subscriber == updated.m_subscribers.end() )
+							{
+								// There is no subscriber yet. It must be added if
+								// it's possible.
+								ensure_new_subscriber_can_be_added( subscriber );
+
+								updated.m_subscribers.emplace(
+										std::addressof(subscriber), maker() );
+							}
+						else
+							// Subscriber is known. It must be updated.
+							changer( it_subscriber->second );
+
+						post_action( updated );
+
+						auto new_snapshot = this->m_data.m_snapshot.acquire()
+								.value().make_updated(
+										msg_type,
+										make_subscriber_list( updated ) );
+
+						// All following actions shouldn't throw.
+						const auto old_subscriptions_count =
+								it_type->second.m_subscriptions_count;
+						it_type->second = std::move(updated);
+						this->m_data.m_snapshot.replace( std::move(new_snapshot) );
+
+						send_notification_if_needed(
+								sender,
+								msg_type,
+								old_subscriptions_count,
+								it_type->second.m_subscriptions_count );
+					},
+					[&] {
+						if( inserted )
+							types.erase( it_type );
+					} );
+			}
+
+		template<
+			typename Info_Changer,
+			typename Post_Action >
+		void
+		modify_and_remove_subscriber_if_needed(
+			const std::type_index & msg_type,
+			abstract_message_sink_t & subscriber,
+			Info_Changer changer,
+			Post_Action post_action ) noexcept
+			{
+				std::lock_guard< std::mutex > lock( this->m_data.m_lock );
+
+				auto & types = this->m_data.m_types;
+				const auto it_type = types.find( msg_type );
+				if( it_type == types.end() )
+					return;
+
+				auto it_subscriber = it_type->second.m_subscribers.find(
+						std::addressof(subscriber) );
+				if( it_subscriber == it_type->second.m_subscribers.end() )
+					return;
+
+				// NOTE: there is no way to report an error (like bad_alloc)
+				// from noexcept methods, so the application will be
+				// terminated in the case of an exception.
+				so_5::details::invoke_noexcept_code( [&]()
+					{
+						per_type_data_t updated{ it_type->second };
+						it_subscriber = updated.m_subscribers.find(
+								std::addressof(subscriber) );
+
+						// Subscriber is found and must be modified.
+						changer( it_subscriber->second );
+
+						// If info about subscriber becomes empty after
+						// modification then subscriber info must be removed.
+						if( it_subscriber->second.empty() )
+							updated.m_subscribers.erase( it_subscriber );
+
+						post_action( updated );
+
+						auto new_snapshot = this->m_data.m_snapshot.acquire()
+								.value().make_updated(
+										msg_type,
+										make_subscriber_list( updated ) );
+
+						const auto old_subscriptions_count =
+								it_type->second.m_subscriptions_count;
+						const auto new_subscriptions_count =
+								updated.m_subscriptions_count;
+
+						if( updated.m_subscribers.empty() )
+							types.erase( it_type );
+						else
+							it_type->second = std::move(updated);
+
+						this->m_data.m_snapshot.replace( std::move(new_snapshot) );
+
+						// Sender of notifications was created when the
+						// subscriber had been added.
+						send_notification_if_needed(
+								this->m_data.m_notification_senders.find( msg_type )->second,
+								msg_type,
+								old_subscriptions_count,
+								new_subscriptions_count );
+					} );
+			}
+
+		void
+		do_deliver_message_to_subscriber(
+			abstract_message_sink_t & subscriber,
+			const subscriber_info_t & subscriber_info,
+			typename Tracing_Base::deliver_op_tracer const & tracer,
+			message_delivery_mode_t delivery_mode,
+			const std::type_index & msg_type,
+			const message_ref_t & message,
+			unsigned int redirection_deep ) const
+			{
+				const auto delivery_status =
+						subscriber_info.must_be_delivered(
+								subscriber,
+								message,
+								[]( const message_ref_t & msg ) -> message_t & {
+									return *msg;
+								} );
+
+				if( delivery_possibility_t::must_be_delivered == delivery_status )
+					{
+						subscriber.push_event(
+								this->id(),
+								delivery_mode,
+								msg_type,
+								message,
+								redirection_deep,
+								tracer.overlimit_tracer() );
+					}
+				else
+					tracer.message_rejected(
+							std::addressof(subscriber), delivery_status );
+			}
+
+		void
+		ensure_new_subscriber_can_be_added(
+			abstract_message_sink_t & subscriber ) const
+			{
+				// If this mbox is MPSC mbox then a new subscriber can be
+				// added only if there is no other subscribers for any of
+				// message types.
+				if( mbox_type_t::multi_producer_single_consumer ==
+						this->m_data.m_mbox_type )
+					{
+						for( const auto & [t, data] : this->m_data.m_types )
+							for( const auto & [sink, info] : data.m_subscribers )
+								if( sink != std::addressof(subscriber) )
+									SO_5_THROW_EXCEPTION(
+											errors::rc_subscriber_already_exists_for_mpsc_mbox,
+											"subscriber already exists for MPSC mbox, new "
+											"subscriber can't be added" );
+					}
+			}
+
+		/*!
+		 * \brief Ensures that message is an immutable message.
+		 *
+		 * Checks mutability flag and throws an exception if message is
+		 * a mutable one.
+		 */
+		void
+		ensure_immutable_message(
+			const std::type_index & msg_type,
+			const message_ref_t & what ) const
+			{
+				if( (mbox_type_t::multi_producer_multi_consumer ==
+						this->m_data.m_mbox_type) &&
+						(message_mutability_t::immutable_message !=
+								message_mutability( what )) )
+					SO_5_THROW_EXCEPTION(
+							so_5::rc_mutable_msg_cannot_be_delivered_via_mpmc_mbox,
+							"an attempt to deliver mutable message via MPMC mbox"
+							", msg_type=" + std::string(msg_type.name()) );
+			}
+	};
+
+} /* namespace details */
+
+//
+// make_mbox
+//
+/*!
+ * \brief Create an instance of first_last_subscriber_notification mbox.
+ *
+ * Usage examples:
+ *
+ * Create a MPMC mbox with std::mutex as Lock_Type (this mbox can safely be
+ * used in multi-threaded environments):
+ * \code
+ * namespace mbox_ns = so_5::extra::mboxes::first_last_subscriber_notification;
+ * so_5::environment_t & env = ...;
+ * auto notification_mbox = env.create_mbox();
+ * auto mbox = mbox_ns::make_mbox<my_message>(
+ * 		env,
+ * 		notification_mbox,
+ * 		so_5::mbox_type_t::multi_producer_multi_consumer);
+ * \endcode
+ *
+ * Create a MPSC mbox with std::mutex as Lock_Type (this mbox can safely be
+ * used in multi-threaded environments):
+ * \code
+ * namespace mbox_ns = so_5::extra::mboxes::first_last_subscriber_notification;
+ * so_5::environment_t & env = ...;
+ * auto notification_mbox = env.create_mbox();
+ * auto mbox = mbox_ns::make_mbox<my_message>(
+ * 		env,
+ * 		notification_mbox,
+ * 		so_5::mbox_type_t::multi_producer_single_consumer);
+ * \endcode
+ *
+ * Create a MPMC mbox with so_5::null_mutex_t as Lock_Type (this mbox can only
+ * be used in single-threaded environments):
+ * \code
+ * namespace mbox_ns = so_5::extra::mboxes::first_last_subscriber_notification;
+ * so_5::environment_t & env = ...;
+ * auto notification_mbox = env.create_mbox();
+ * auto mbox = mbox_ns::make_mbox<my_message, so_5::null_mutex_t>(
+ * 		env,
+ * 		notification_mbox,
+ * 		so_5::mbox_type_t::multi_producer_multi_consumer);
+ * \endcode
+ *
+ * Create a MPMC mbox that informs about the last subscriber only if
+ * there were no subscribers during 250ms (quick unsubscribe/subscribe
+ * sequences are ignored):
+ * \code
+ * namespace mbox_ns = so_5::extra::mboxes::first_last_subscriber_notification;
+ * so_5::environment_t & env = ...;
+ * auto notification_mbox = env.create_mbox();
+ * auto mbox = mbox_ns::make_mbox<my_message>(
+ * 		env,
+ * 		notification_mbox,
+ * 		so_5::mbox_type_t::multi_producer_multi_consumer,
+ * 		std::chrono::milliseconds{250});
+ * \endcode
+ *
+ * If \a last_subscriber_grace_period isn't zero then msg_last_subscriber is
+ * sent as a delayed message. If a new subscriber arrives before the end of
+ * the grace period then the pending msg_last_subscriber is cancelled and
+ * msg_first_subscriber isn't sent at all: the receiver doesn't see such
+ * flapping. If the grace period is over (msg_last_subscriber has already
+ * been sent) then msg_first_subscriber is sent as usual. It doesn't matter
+ * whether msg_last_subscriber is handled by someone.
+ *
+ * \attention
+ * This type of mbox terminates the whole application if an attempt
+ * to send a notification (in form of msg_first_subscriber and msg_last_subscriber
+ * signals) throws.
+ *
+ * \tparam Msg_Type type of message to be used with a new mbox.
+ *
+ * \tparam Lock_Type type of lock to be used for thread safety. It can be
+ * std::mutex or so_5::null_mutex_t (or any other type which can be used
+ * with std::lock_quard).
+ *
+ * \since v.1.5.2
+ */
+template<
+	typename Msg_Type,
+	typename Lock_Type = std::mutex >
+[[nodiscard]]
+mbox_t
+make_mbox(
+	//! SObjectizer Environment to work in.
+	environment_t & env,
+	//! Mbox for notifications about the first/last subscriber.
+	mbox_t notification_mbox,
+	//! Type of this mbox (MPSC or MPMC).
+	mbox_type_t mbox_type,
+	//! How long the number of subscribers has to stay at zero before
+	//! the last subscriber notification is sent.
+	//! Zero means that the notification is sent immediately.
+	std::chrono::steady_clock::duration last_subscriber_grace_period =
+			std::chrono::steady_clock::duration::zero() )
+	{
+		return env.make_custom_mbox(
+				[&notification_mbox, mbox_type, last_subscriber_grace_period](
+					const mbox_creation_data_t & data )
+				{
+					mbox_t result;
+
+					if( data.m_tracer.get().is_msg_tracing_enabled() )
+						{
+							using T = details::actual_mbox_t<
+									Msg_Type,
+									Lock_Type,
+									::so_5::impl::msg_tracing_helpers::tracing_enabled_base >;
+
+							result = mbox_t{ new T{
+									data.m_env.get(),
+									data.m_id,
+									std::move(notification_mbox),
+									mbox_type,
+									last_subscriber_grace_period,
+									data.m_tracer
+								} };
+						}
+					else
+						{
+							using T = details::actual_mbox_t<
+									Msg_Type,
+									Lock_Type,
+									::so_5::impl::msg_tracing_helpers::tracing_disabled_base >;
+							result = mbox_t{ new T{
+									data.m_env.get(),
+									data.m_id,
+									std::move(notification_mbox),
+									mbox_type,
+									last_subscriber_grace_period
+								} };
+						}
+
+					return result;
+				} );
+	}
+
+//
+// make_multi_consumer_mbox
+//
+/*!
+ * \brief Create an instance of first_last_subscriber_notification MPMC mbox.
+ *
+ * Usage examples:
+ *
+ * Create a MPMC mbox with std::mutex as Lock_Type (this mbox can safely be
+ * used in multi-threaded environments):
+ * \code
+ * namespace mbox_ns = so_5::extra::mboxes::first_last_subscriber_notification;
+ * so_5::environment_t & env = ...;
+ * auto notification_mbox = env.create_mbox();
+ * auto mbox = mbox_ns::make_multi_consumer_mbox<my_message>(
+ * 		env,
+ * 		notification_mbox);
+ * \endcode
+ *
+ * \note
+ * It's just a thin wrapper around make_mbox() template function.
+ *
+ * \sa make_mbox
+ *
+ * \since v.1.5.2
+ */
+template<
+	typename Msg_Type,
+	typename Lock_Type = std::mutex >
+[[nodiscard]]
+mbox_t
 make_multi_consumer_mbox(
 	//! SObjectizer Environment to work in.
 	environment_t & env,
 	//! Mbox for notifications about the first/last subscriber.
-	mbox_t notification_mbox )
+	mbox_t notification_mbox,
+	//! Grace period for the last subscriber notification.
+	//! See make_mbox() for details.
+	std::chrono::steady_clock::duration last_subscriber_grace_period =
+			std::chrono::steady_clock::duration::zero() )
 {
 	return make_mbox< Msg_Type, Lock_Type >(
 			env,
 			std::move(notification_mbox),
-			mbox_type_t::multi_producer_multi_consumer );
+			mbox_type_t::multi_producer_multi_consumer,
+			last_subscriber_grace_period );
 }
 
 //
@@ -825,14 +1804,143 @@ make_single_consumer_mbox(
 	//! SObjectizer Environment to work in.
 	environment_t & env,
 	//! Mbox for notifications about the first/last subscriber.
-	mbox_t notification_mbox )
+	mbox_t notification_mbox,
+	//! Grace period for the last subscriber notification.
+	//! See make_mbox() for details.
+	std::chrono::steady_clock::duration last_subscriber_grace_period =
+			std::chrono::steady_clock::duration::zero() )
 {
 	return make_mbox< Msg_Type, Lock_Type >(
 			env,
 			std::move(notification_mbox),
-			mbox_type_t::multi_producer_single_consumer );
+			mbox_type_t::multi_producer_single_consumer,
+			last_subscriber_grace_period );
 }
 
+//
+// make_multi_type_mbox
+//
+/*!
+ * \brief Create an instance of first_last_subscriber_notification mbox
+ * that can be used for several message types.
+ *
+ * Unlike make_mbox() this mbox isn't bound to just one message type.
+ * It tracks subscribers for every message type separately and sends
+ * msg_first_subscriber_for_type when the first subscriber for a message
+ * type arrives and msg_last_subscriber_for_type when the last subscriber for
+ * a message type gone.
+ *
+ * Usage example:
+ * \code
+ * namespace mbox_ns = so_5::extra::mboxes::first_last_subscriber_notification;
+ *
+ * class my_producer final : public so_5::agent_t
+ * {
+ * 	const so_5::mbox_t publishing_mbox_;
+ * 	...
+ * public:
+ * 	my_producer( context_t ctx )
+ * 		:	so_5::agent_t{ std::move(ctx) }
+ * 		,	publishing_mbox_{ mbox_ns::make_multi_type_mbox(
+ * 				so_environment(),
+ * 				so_direct_mbox(),
+ * 				so_5::mbox_type_t::multi_producer_multi_consumer )
+ * 			}
+ * 	{...}
+ *
+ * 	void so_define_agent() override
+ * 	{
+ * 		so_subscribe_self()
+ * 			.event( [this]( mhood_t< mbox_ns::msg_first_subscriber_for_type > cmd ) {
+ * 					if( typeid(prices) == cmd->m_msg_type )
+ * 						turn_prices_acquisition_on();
+ * 					else if( typeid(trades) == cmd->m_msg_type )
+ * 						turn_trades_acquisition_on();
+ * 				} )
+ * 			.event( [this]( mhood_t< mbox_ns::msg_last_subscriber_for_type > cmd ) {
+ * 					...
+ * 				} );
+ * 	}
+ * 	...
+ * };
+ * \endcode
+ *
+ * Message delivery doesn't acquire any locks. Subscribers are held in
+ * an immutable snapshot and a new snapshot is created on every change of
+ * subscriptions (or delivery filters). So a sender pays just for
+ * a lookup of a message type in a sorted array and a couple of atomic
+ * operations. The price is paid by subscribers: subscription and
+ * unsubscription are more expensive than for an ordinary mbox because
+ * they have to wait while senders that use the old snapshot complete
+ * their work.
+ *
+ * \attention
+ * This type of mbox terminates the whole application if an attempt
+ * to send a notification (in form of msg_first_subscriber_for_type and
+ * msg_last_subscriber_for_type messages) throws.
+ *
+ * \note
+ * If the mbox is created as MPMC mbox then it can't be used for
+ * mutable messages.
+ *
+ * \note
+ * The grace period for msg_last_subscriber_for_type works the same way
+ * as for make_mbox(), but separately for every message type.
+ *
+ * \since v.1.7.0
+ */
+[[nodiscard]]
+inline mbox_t
+make_multi_type_mbox(
+	//! SObjectizer Environment to work in.
+	environment_t & env,
+	//! Mbox for notifications about the first/last subscriber.
+	mbox_t notification_mbox,
+	//! Type of this mbox (MPSC or MPMC).
+	mbox_type_t mbox_type,
+	//! How long the number of subscribers has to stay at zero before
+	//! the last subscriber notification is sent.
+	//! Zero means that the notification is sent immediately.
+	std::chrono::steady_clock::duration last_subscriber_grace_period =
+			std::chrono::steady_clock::duration::zero() )
+	{
+		return env.make_custom_mbox(
+				[&notification_mbox, mbox_type, last_subscriber_grace_period](
+					const mbox_creation_data_t & data )
+				{
+					mbox_t result;
+
+					if( data.m_tracer.get().is_msg_tracing_enabled() )
+						{
+							using T = details::actual_multi_type_mbox_t<
+									::so_5::impl::msg_tracing_helpers::tracing_enabled_base >;
+
+							result = mbox_t{ new T{
+									data.m_env.get(),
+									data.m_id,
+									std::move(notification_mbox),
+									mbox_type,
+									last_subscriber_grace_period,
+									data.m_tracer
+								} };
+						}
+					else
+						{
+							using T = details::actual_multi_type_mbox_t<
+									::so_5::impl::msg_tracing_helpers::tracing_disabled_base >;
+							result = mbox_t{ new T{
+									data.m_env.get(),
+									data.m_id,
+									std::move(notification_mbox),
+									mbox_type,
+									last_subscriber_grace_period
+								} };
+						}
+
+					return result;
+				} );
+	}
+
 } /* namespace first_last_subscriber_notification */
 
 } /* namespace mboxes */
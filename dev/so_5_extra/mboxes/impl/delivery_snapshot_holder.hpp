@@ -0,0 +1,159 @@
+/*!
+ * \file
+ * \brief Holder of an immutable snapshot for lock-free delivery.
+ *
+ * \since v.1.7.0
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <thread>
+
+namespace so_5 {
+
+namespace extra {
+
+namespace mboxes {
+
+namespace impl {
+
+//
+// delivery_snapshot_holder_t
+//
+/*!
+ * \brief Holder of an immutable snapshot to be used for message delivery
+ * without locks.
+ *
+ * Readers don't acquire any locks. A reader increments one of two
+ * counters of active readers, loads the pointer to the current snapshot,
+ * works with it, then decrements the counter.
+ *
+ * A writer publishes a new snapshot and then waits while all readers who
+ * could see the old snapshot complete their work. Only then the old
+ * snapshot is destroyed. The index of readers counter is flipped before the
+ * waiting, so new readers go to another counter and the waiting can't be
+ * infinite even if there is a constant flow of readers. Two flips are
+ * performed because a reader can load the index of the counter before
+ * the previous flip.
+ *
+ * It means that after the return from replace() no one reader uses the
+ * old snapshot. So a snapshot can hold raw pointers to objects that can
+ * be destroyed right after the replacement (like sinks and delivery
+ * filters), and the resources of the old snapshot are released without
+ * any delay.
+ *
+ * \attention
+ * replace() has to be called by one writer at a time.
+ *
+ * \attention
+ * replace() can't be called by a thread that holds a reader_t object.
+ *
+ * \tparam T type of snapshot.
+ *
+ * \since v.1.7.0
+ */
+template< typename T >
+class delivery_snapshot_holder_t
+	{
+	public:
+		//! Type of counter for active readers.
+		using counter_t = std::atomic< std::size_t >;
+
+		/*!
+		 * \brief Guard for reading access to the current snapshot.
+		 *
+		 * The snapshot stays alive while reader_t object exists.
+		 */
+		class reader_t
+			{
+				counter_t & m_counter;
+				const T & m_value;
+
+			public:
+				reader_t( counter_t & counter, const T & value ) noexcept
+					:	m_counter{ counter }
+					,	m_value{ value }
+					{}
+				~reader_t() noexcept
+					{
+						m_counter.fetch_sub( 1u, std::memory_order_release );
+					}
+
+				reader_t( const reader_t & ) = delete;
+				reader_t & operator=( const reader_t & ) = delete;
+
+				[[nodiscard]]
+				const T &
+				value() const noexcept { return m_value; }
+			};
+
+		explicit delivery_snapshot_holder_t( std::unique_ptr< const T > initial )
+			:	m_current{ initial.release() }
+			{
+				m_readers[ 0 ].store( 0u );
+				m_readers[ 1 ].store( 0u );
+			}
+
+		~delivery_snapshot_holder_t() noexcept
+			{
+				delete m_current.load();
+			}
+
+		delivery_snapshot_holder_t( const delivery_snapshot_holder_t & ) = delete;
+		delivery_snapshot_holder_t( delivery_snapshot_holder_t && ) = delete;
+
+		//! Get the reading access to the current snapshot.
+		[[nodiscard]]
+		reader_t
+		acquire() const noexcept
+			{
+				counter_t & counter = m_readers[ m_epoch.load() & 1u ];
+				counter.fetch_add( 1u );
+
+				return { counter, *(m_current.load()) };
+			}
+
+		//! Publish a new snapshot and destroy the old one.
+		/*!
+		 * \note
+		 * This method blocks the caller until all readers of the old
+		 * snapshot complete their work.
+		 */
+		void
+		replace( std::unique_ptr< const T > new_value ) noexcept
+			{
+				std::unique_ptr< const T > old{
+						m_current.exchange( new_value.release() )
+					};
+
+				for( int i = 0; i != 2; ++i )
+					{
+						const auto old_epoch = m_epoch.fetch_add( 1u );
+						const counter_t & counter = m_readers[ old_epoch & 1u ];
+						while( 0u != counter.load() )
+							std::this_thread::yield();
+					}
+			}
+
+	private:
+		//! The current snapshot.
+		std::atomic< const T * > m_current;
+
+		//! The current index of readers counter.
+		mutable std::atomic< unsigned int > m_epoch{ 0u };
+
+		//! Counters of active readers.
+		mutable std::array< counter_t, 2 > m_readers;
+	};
+
+} /* namespace impl */
+
+} /* namespace mboxes */
+
+} /* namespace extra */
+
+} /* namespace so_5 */
@@ -12,12 +12,26 @@
 #include <so_5_extra/error_ranges.hpp>
 
 #include <so_5_extra/enveloped_msg/just_envelope.hpp>
+#include <so_5_extra/enveloped_msg/impl/payload_extractor.hpp>
 
 #include <so_5/impl/msg_tracing_helpers.hpp>
 
+#include <so_5/details/invoke_noexcept_code.hpp>
+
 #include <so_5/environment.hpp>
+#include <so_5/send_functions.hpp>
 
+#include <algorithm>
+#include <array>
 #include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
 
 namespace so_5 {
 
@@ -95,30 +109,422 @@ const int rc_different_message_type =
 const int rc_nullptr_as_underlying_mbox =
 		::so_5::extra::errors::mboxes_inflight_limit_errors + 1;
 
-} /* namespace impl */
+/*!
+ * \brief Invalid values of watermarks.
+ *
+ * The low watermark should be less than the high watermark and the high
+ * watermark shouldn't be greater than the limit of inflight messages.
+ *
+ * \since v.1.7.0
+ */
+const int rc_invalid_watermarks =
+		::so_5::extra::errors::mboxes_inflight_limit_errors + 2;
+
+/*!
+ * \brief Null pointer to mbox for watermark notifications.
+ *
+ * \since v.1.7.0
+ */
+const int rc_nullptr_as_notification_mbox =
+		::so_5::extra::errors::mboxes_inflight_limit_errors + 3;
+
+/*!
+ * \brief Invalid parameters for adaptive inflight limit.
+ *
+ * \since v.1.7.0
+ */
+const int rc_invalid_adaptive_limit_params =
+		::so_5::extra::errors::mboxes_inflight_limit_errors + 4;
+
+} /* namespace errors */
+
+/*!
+ * \brief Signal to be sent when the number of inflight messages reaches
+ * the high watermark.
+ *
+ * See make_mbox_with_watermarks() for usage example.
+ *
+ * \since v.1.7.0
+ */
+struct msg_high_watermark final : public so_5::signal_t {};
+
+/*!
+ * \brief Signal to be sent when the number of inflight messages drops
+ * to the low watermark after reaching the high watermark.
+ *
+ * See make_mbox_with_watermarks() for usage example.
+ *
+ * \since v.1.7.0
+ */
+struct msg_low_watermark final : public so_5::signal_t {};
+
+/*!
+ * \brief Values of watermarks for make_mbox_with_watermarks().
+ *
+ * \since v.1.7.0
+ */
+struct watermarks_t
+	{
+		//! msg_high_watermark is sent when the number of inflight messages
+		//! becomes equal to this value.
+		underlying_counter_t m_high;
+
+		//! msg_low_watermark is sent when the number of inflight messages
+		//! drops to this value.
+		underlying_counter_t m_low;
+	};
+
+/*!
+ * \brief Parameters for make_adaptive_mbox().
+ *
+ * Usage example:
+ * \code
+ * namespace mbox_ns = so_5::extra::mboxes::inflight_limit;
+ *
+ * auto mbox = mbox_ns::make_adaptive_mbox< request >(
+ * 		workers_mbox,
+ * 		mbox_ns::adaptive_limit_params_t{ 16u, std::chrono::milliseconds{20} }
+ * 			.min_limit( 4u )
+ * 			.max_limit( 256u )
+ * 			.backoff_ratio( 0.75 ) );
+ * \endcode
+ *
+ * \since v.1.7.0
+ */
+class adaptive_limit_params_t
+	{
+		//! Initial value of the limit.
+		underlying_counter_t m_initial_limit;
+
+		//! The limit can't be decreased below this value.
+		underlying_counter_t m_min_limit{ 1u };
+
+		//! The limit can't be increased above this value.
+		underlying_counter_t m_max_limit{ 1000u };
+
+		//! Target latency.
+		/*!
+		 * The limit is increased while the latency is not greater than
+		 * that value.
+		 */
+		std::chrono::steady_clock::duration m_target_latency;
+
+		//! The limit is multiplied by this value when the latency is
+		//! greater than the target latency.
+		double m_backoff_ratio{ 0.5 };
+
+	public:
+		adaptive_limit_params_t(
+			underlying_counter_t initial_limit,
+			std::chrono::steady_clock::duration target_latency )
+			:	m_initial_limit{ initial_limit }
+			,	m_target_latency{ target_latency }
+			{}
+
+		[[nodiscard]]
+		underlying_counter_t
+		initial_limit() const noexcept { return m_initial_limit; }
+
+		[[nodiscard]]
+		underlying_counter_t
+		min_limit() const noexcept { return m_min_limit; }
+
+		adaptive_limit_params_t &
+		min_limit( underlying_counter_t v ) noexcept
+			{
+				m_min_limit = v;
+				return *this;
+			}
+
+		[[nodiscard]]
+		underlying_counter_t
+		max_limit() const noexcept { return m_max_limit; }
+
+		adaptive_limit_params_t &
+		max_limit( underlying_counter_t v ) noexcept
+			{
+				m_max_limit = v;
+				return *this;
+			}
+
+		[[nodiscard]]
+		std::chrono::steady_clock::duration
+		target_latency() const noexcept { return m_target_latency; }
+
+		[[nodiscard]]
+		double
+		backoff_ratio() const noexcept { return m_backoff_ratio; }
+
+		adaptive_limit_params_t &
+		backoff_ratio( double v ) noexcept
+			{
+				m_backoff_ratio = v;
+				return *this;
+			}
+	};
 
 namespace impl {
 
+template< typename Counter >
+class counter_owner_t;
+
 /*!
- * \brief Separate type for holding inflight message counter as a separate object.
+ * \brief Counter of inflight messages that can be shared between several
+ * owners.
  *
- * It's expected that an instance of instances_counter_t will be created in
- * dynamic memory and shared between entities via shared_ptr.
+ * It's the only type of counter used by all kinds of inflight_limit_mbox.
+ * Counters with additional logic (like watermarks or adaptive limit)
+ * are derived from it.
  *
- * \since v.1.5.2
+ * The lifetime of that object is controlled by an intrusive reference
+ * counter. That reference counter is a part of the same atomic value as
+ * the number of inflight messages: the lower 32 bits hold the number
+ * of inflight messages, the upper bits hold the number of owners (mboxes
+ * and shared_budget_t objects). The object is destroyed when both
+ * values become zero. So sending of a message and the destruction of
+ * the message require just one atomic operation each.
+ *
+ * An inflight message keeps the counter alive, so an envelope can hold
+ * a plain reference to the counter.
+ *
+ * \since v.1.7.0
+ */
+class shared_counter_t
+	{
+		template< typename Counter >
+		friend class counter_owner_t;
+
+		using state_t = std::uint64_t;
+
+		static_assert( sizeof(underlying_counter_t) <= sizeof(std::uint32_t),
+				"underlying_counter_t should fit into the lower part of state_t" );
+
+		//! The value for one owner in the state.
+		static constexpr state_t one_owner = state_t{ 1u } << 32u;
+
+		//! Mask for getting the number of inflight messages from the state.
+		static constexpr state_t instances_mask = one_owner - 1u;
+
+		//! The number of owners and the number of inflight messages.
+		/*!
+		 * The object is created with one owner.
+		 */
+		std::atomic< state_t > m_state{ one_owner };
+
+		void
+		add_owner() noexcept
+			{
+				m_state.fetch_add( one_owner, std::memory_order_relaxed );
+			}
+
+		void
+		release( state_t delta ) noexcept
+			{
+				if( delta == m_state.fetch_sub( delta ) )
+					delete this;
+			}
+
+	protected:
+		shared_counter_t() = default;
+		virtual ~shared_counter_t() noexcept = default;
+
+		//! Decrement the number of inflight messages and become an owner
+		//! of the counter.
+		/*!
+		 * It's one atomic operation. It allows to work with the counter
+		 * after the decrement. Such a work has to be finished by
+		 * release_owner().
+		 *
+		 * \return the new number of inflight messages.
+		 */
+		[[nodiscard]]
+		underlying_counter_t
+		decrement_and_pin() noexcept
+			{
+				const auto prev = m_state.fetch_add( one_owner - 1u );
+				return static_cast< underlying_counter_t >(
+						( prev & instances_mask ) - 1u );
+			}
+
+		void
+		release_owner() noexcept
+			{
+				release( one_owner );
+			}
+
+	public:
+		shared_counter_t( const shared_counter_t & ) = delete;
+		shared_counter_t & operator=( const shared_counter_t & ) = delete;
+
+		//! Increment the number of inflight messages.
+		/*!
+		 * \return the new number of inflight messages.
+		 */
+		[[nodiscard]]
+		underlying_counter_t
+		increment() noexcept
+			{
+				const auto prev = m_state.fetch_add( 1u );
+				return static_cast< underlying_counter_t >(
+						( prev + 1u ) & instances_mask );
+			}
+
+		//! Decrement the number of inflight messages.
+		/*!
+		 * \attention
+		 * The object can be destroyed inside this call.
+		 */
+		void
+		decrement() noexcept
+			{
+				release( 1u );
+			}
+
+		//! Decrement the number of inflight messages.
+		/*!
+		 * \return the new number of inflight messages. It's zero if
+		 * the object was destroyed inside this call.
+		 */
+		[[nodiscard]]
+		underlying_counter_t
+		decrement_and_fetch() noexcept
+			{
+				const auto prev = m_state.fetch_sub( 1u );
+				if( 1u == prev )
+					{
+						delete this;
+						return 0u;
+					}
+
+				return static_cast< underlying_counter_t >(
+						( prev & instances_mask ) - 1u );
+			}
+
+		//! Get the current number of inflight messages.
+		[[nodiscard]]
+		underlying_counter_t
+		inflight() const noexcept
+			{
+				return static_cast< underlying_counter_t >(
+						m_state.load() & instances_mask );
+			}
+	};
+
+/*!
+ * \brief An owning reference to a counter.
+ *
+ * A new counter is created by the constructor. Copies of
+ * a counter_owner_t refer to the same counter.
+ *
+ * \tparam Counter type of the counter. It's shared_counter_t or a type
+ * derived from it.
+ *
+ * \since v.1.7.0
  */
-struct instances_counter_t
+template< typename Counter >
+class counter_owner_t
 	{
-		//! Counter of inflight instances.
-		std::atomic< underlying_counter_t > m_instances{};
+		static_assert( std::is_base_of_v< shared_counter_t, Counter >,
+				"Counter should be derived from shared_counter_t" );
+
+		Counter * m_counter;
+
+	public:
+		//! Create a new counter.
+		template< typename... Args >
+		explicit counter_owner_t( std::in_place_t, Args &&... args )
+			:	m_counter{ new Counter{ std::forward< Args >(args)... } }
+			{}
+
+		counter_owner_t()
+			:	counter_owner_t{ std::in_place }
+			{}
+
+		counter_owner_t( const counter_owner_t & other ) noexcept
+			:	m_counter{ other.m_counter }
+			{
+				m_counter->add_owner();
+			}
+
+		counter_owner_t &
+		operator=( const counter_owner_t & other ) noexcept
+			{
+				counter_owner_t tmp{ other };
+				std::swap( m_counter, tmp.m_counter );
+				return *this;
+			}
+
+		~counter_owner_t() noexcept
+			{
+				m_counter->release_owner();
+			}
+
+		[[nodiscard]]
+		Counter &
+		get() const noexcept { return *m_counter; }
 	};
 
 /*!
- * \brief An alias for shared_ptr to instances_counter.
+ * \brief An owning reference to a plain counter of inflight messages.
  *
- * \since v.1.5.2
+ * \since v.1.7.0
+ */
+using shared_counter_owner_t = counter_owner_t< shared_counter_t >;
+
+struct shared_budget_accessor_t;
+
+} /* namespace impl */
+
+//
+// shared_budget_t
+//
+/*!
+ * \brief A budget of inflight messages that can be shared between several
+ * inflight_limit_mboxes.
+ *
+ * It's a handle: copies of a shared_budget_t object refer to the same
+ * budget.
+ *
+ * See make_mbox(mbox_t, const shared_budget_t &) for usage example.
+ *
+ * \since v.1.7.0
  */
-using instances_counter_shptr_t = std::shared_ptr< instances_counter_t >;
+class shared_budget_t
+	{
+		friend struct impl::shared_budget_accessor_t;
+
+		//! Counter of inflight messages.
+		impl::shared_counter_owner_t m_counter;
+
+		//! The limit of inflight messages.
+		underlying_counter_t m_limit;
+
+	public:
+		explicit shared_budget_t(
+			//! The limit of inflight messages.
+			underlying_counter_t limit )
+			:	m_limit{ limit }
+			{}
+
+		//! Get the limit of inflight messages.
+		[[nodiscard]]
+		underlying_counter_t
+		limit() const noexcept { return m_limit; }
+
+		//! Get the current number of inflight messages.
+		/*!
+		 * \note
+		 * The value can be changed immediately after the return.
+		 */
+		[[nodiscard]]
+		underlying_counter_t
+		inflight() const noexcept
+			{
+				return m_counter.get().inflight();
+			}
+	};
+
+namespace impl {
 
 /*!
  * \brief Helper class for incrementing/decrementing number of messages in
@@ -145,22 +551,22 @@ using instances_counter_shptr_t = std::shared_ptr< instances_counter_t >;
  */
 class counter_incrementer_t
 	{
-		instances_counter_t & m_counter;
+		shared_counter_t & m_counter;
 		const underlying_counter_t m_value;
 
 		bool m_should_decrement_in_destructor{ true };
 
 	public:
 		counter_incrementer_t(
-			outliving_reference_t< instances_counter_t > counter ) noexcept
+			outliving_reference_t< shared_counter_t > counter ) noexcept
 			:	m_counter{ counter.get() }
-			,	m_value{ ++(m_counter.m_instances) }
+			,	m_value{ m_counter.increment() }
 			{}
 
 		~counter_incrementer_t() noexcept
 			{
 				if( m_should_decrement_in_destructor )
-					(m_counter.m_instances)--;
+					m_counter.decrement();
 			}
 
 		void
@@ -184,87 +590,358 @@ class counter_incrementer_t
  * The envelope expects that the number of messages is already incremented before
  * the creation of the envelope. That number is always decremented in the
  * destructor.
- * 
+ *
+ * \note
+ * A new envelope is allocated for every message. There is no pool or
+ * cache of envelopes.
+ *
  * \since v.1.5.2
  */
 class special_envelope_t final : public so_5::extra::enveloped_msg::just_envelope_t
 	{
 		using base_type_t = so_5::extra::enveloped_msg::just_envelope_t;
 
-		instances_counter_shptr_t m_counter;
+		shared_counter_t & m_counter;
 
 	public:
 		//! Initializing constructor.
 		special_envelope_t(
 			message_ref_t payload,
-			instances_counter_shptr_t counter )
+			outliving_reference_t< shared_counter_t > counter )
 			:	base_type_t{ std::move(payload) }
-			,	m_counter{ std::move(counter) }
+			,	m_counter{ counter.get() }
 			{}
 
 		~special_envelope_t() noexcept override
 			{
 				// Counter should always be decremented because it was
 				// incremented before the creation of envelope instance.
-				(m_counter->m_instances)--;
+				// NOTE: the counter can be destroyed here.
+				m_counter.decrement();
 			}
 	};
 
 /*!
- * \brief Helper type that tells that underlying mbox isn't nullptr.
+ * \brief Counter of inflight messages that tracks watermarks.
  *
- * \since v.1.5.2
+ * Notifications are sent under the lock, so msg_high_watermark and
+ * msg_low_watermark always alternate and never arrive in the wrong order.
+ *
+ * \since v.1.7.0
  */
-class not_null_underlying_mbox_t
+class watermark_counter_t final : public shared_counter_t
 	{
-		friend not_null_underlying_mbox_t
-		ensure_underlying_mbox_not_null( so_5::mbox_t );
+		//! Values of watermarks.
+		const watermarks_t m_watermarks;
 
-		so_5::mbox_t m_value;
+		//! Destination for notifications.
+		const so_5::mbox_t m_notification_mbox;
 
-		not_null_underlying_mbox_t( so_5::mbox_t value )
-			:	m_value{ std::move(value) }
-			{}
+		//! Lock for sending notifications.
+		std::mutex m_lock;
+
+		//! Has the high watermark been reached?
+		/*!
+		 * \note
+		 * It's changed only when m_lock is acquired.
+		 */
+		std::atomic< bool > m_high_reached{ false };
+
+		void
+		check_watermarks() noexcept
+			{
+				std::lock_guard< std::mutex > lock{ m_lock };
+
+				// NOTE: there is no way to report an error from here
+				// (this method is called from envelope's destructor),
+				// so the application will be terminated in the case of an
+				// exception.
+				so_5::details::invoke_noexcept_code( [this] {
+						// The counter is rechecked after every change of
+						// m_high_reached because the counter could be changed
+						// by a thread that saw the old value of m_high_reached.
+						for(;;)
+							{
+								const auto current = inflight();
+								if( !m_high_reached.load() &&
+										current >= m_watermarks.m_high )
+									{
+										m_high_reached.store( true );
+										so_5::send< msg_high_watermark >(
+												m_notification_mbox );
+									}
+								else if( m_high_reached.load() &&
+										current <= m_watermarks.m_low )
+									{
+										m_high_reached.store( false );
+										so_5::send< msg_low_watermark >(
+												m_notification_mbox );
+									}
+								else
+									break;
+							}
+					} );
+			}
 
 	public:
-		[[nodiscard]]
-		const so_5::mbox_t &
-		value() const noexcept { return m_value; }
-	};
+		watermark_counter_t(
+			watermarks_t watermarks,
+			so_5::mbox_t notification_mbox )
+			:	m_watermarks{ watermarks }
+			,	m_notification_mbox{ std::move(notification_mbox) }
+			{}
 
-//! Ensure that underlying mbox is not nullptr.
-/*!
- * \throw so_5::exception_t if \a mbox is nullptr.
- */
-[[nodiscard]]
-inline not_null_underlying_mbox_t
-ensure_underlying_mbox_not_null(
-	so_5::mbox_t mbox )
-	{
-		if( !mbox )
-			SO_5_THROW_EXCEPTION(
-					errors::rc_nullptr_as_underlying_mbox,
-					"nullptr is used as underlying mbox" );
+		//! Reaction to increment of the counter.
+		void
+		on_incremented( underlying_counter_t value ) noexcept
+			{
+				if( value >= m_watermarks.m_high && !m_high_reached.load() )
+					check_watermarks();
+			}
 
-		return { std::move(mbox) };
-	}
+		//! Decrement the counter and send a notification if needed.
+		/*!
+		 * \attention
+		 * The object can be destroyed inside this call.
+		 */
+		void
+		on_completed() noexcept
+			{
+				// The counter has to live until the end of the check.
+				const auto value = decrement_and_pin();
+				if( value <= m_watermarks.m_low && m_high_reached.load() )
+					check_watermarks();
+
+				release_owner();
+			}
+	};
 
 /*!
- * \brief Actual implementation of inflight_limit_mbox.
+ * \brief Type of envelope to be used by inflight_limit_mbox with
+ * watermarks.
  *
- * \tparam Tracing_Base base class with implementation of message
- * delivery tracing methods.
+ * \attention
+ * The envelope expects that the number of messages is already incremented before
+ * the creation of the envelope. That number is always decremented in the
+ * destructor.
  *
- * \since v.1.5.2
+ * \since v.1.7.0
  */
-template< typename Tracing_Base >
-class actual_mbox_t final
-	: public so_5::abstract_message_box_t
-	, private Tracing_Base
+class watermark_special_envelope_t final
+	: public so_5::extra::enveloped_msg::just_envelope_t
 	{
-		//! Actual underlying mbox to be used for all calls.
-		/*!
-		 * \attention Should not be nullptr.
+		using base_type_t = so_5::extra::enveloped_msg::just_envelope_t;
+
+		watermark_counter_t & m_counter;
+
+	public:
+		//! Initializing constructor.
+		watermark_special_envelope_t(
+			message_ref_t payload,
+			outliving_reference_t< watermark_counter_t > counter )
+			:	base_type_t{ std::move(payload) }
+			,	m_counter{ counter.get() }
+			{}
+
+		~watermark_special_envelope_t() noexcept override
+			{
+				// Counter should always be decremented because it was
+				// incremented before the creation of envelope instance.
+				// NOTE: the counter can be destroyed here.
+				m_counter.on_completed();
+			}
+	};
+
+/*!
+ * \brief Counter of inflight messages with adaptive limit.
+ *
+ * The limit is changed in AIMD (additive increase, multiplicative decrease)
+ * style on the base of time between sending of a message and
+ * the destruction of the message:
+ *
+ * - if the latency isn't greater than the target latency and at least
+ *   half of the current limit is used then the limit is increased by one;
+ * - if the latency is greater than the target latency then the limit
+ *   is multiplied by backoff ratio.
+ *
+ * Only messages sent after the last decrease can decrease the limit
+ * again. It prevents the collapse of the limit to the minimum when
+ * several slow messages are completed one after another.
+ *
+ * \since v.1.7.0
+ */
+class adaptive_counter_t final : public shared_counter_t
+	{
+		using clock_t = std::chrono::steady_clock;
+
+		//! Parameters of the limit.
+		const adaptive_limit_params_t m_params;
+
+		//! The current value of the limit.
+		std::atomic< underlying_counter_t > m_limit;
+
+		//! Time of the last decrease of the limit.
+		std::atomic< clock_t::rep > m_last_decrease{
+				clock_t::time_point::min().time_since_epoch().count()
+			};
+
+	public:
+		explicit adaptive_counter_t( const adaptive_limit_params_t & params )
+			:	m_params{ params }
+			,	m_limit{ params.initial_limit() }
+			{}
+
+		[[nodiscard]]
+		underlying_counter_t
+		current_limit() const noexcept
+			{
+				return m_limit.load( std::memory_order_relaxed );
+			}
+
+		//! Update the limit and decrement the counter of inflight messages.
+		/*!
+		 * \attention
+		 * The object can be destroyed inside this call.
+		 */
+		void
+		on_completed( clock_t::time_point sent_at ) noexcept
+			{
+				const auto now = clock_t::now();
+				const auto inflight = this->inflight();
+
+				auto limit = m_limit.load( std::memory_order_relaxed );
+				if( now - sent_at <= m_params.target_latency() )
+					{
+						// Additive increase. It makes sense only if the current
+						// limit is really used.
+						while( limit < m_params.max_limit() && inflight * 2u >= limit &&
+								!m_limit.compare_exchange_weak( limit, limit + 1u ) )
+							{}
+					}
+				else
+					{
+						auto last_decrease = m_last_decrease.load();
+						// Multiplicative decrease, but only once for messages
+						// sent before the previous decrease.
+						if( sent_at.time_since_epoch().count() > last_decrease &&
+								m_last_decrease.compare_exchange_strong(
+										last_decrease, now.time_since_epoch().count() ) )
+							{
+								underlying_counter_t new_limit;
+								do
+									{
+										new_limit = std::max(
+												m_params.min_limit(),
+												static_cast< underlying_counter_t >(
+														limit * m_params.backoff_ratio() ) );
+									}
+								while( !m_limit.compare_exchange_weak( limit, new_limit ) );
+							}
+					}
+
+				decrement();
+			}
+	};
+
+/*!
+ * \brief Type of envelope to be used by inflight_limit_mbox with
+ * adaptive limit.
+ *
+ * \attention
+ * The envelope expects that the number of messages is already incremented before
+ * the creation of the envelope. That number is always decremented in the
+ * destructor.
+ *
+ * \since v.1.7.0
+ */
+class adaptive_special_envelope_t final
+	: public so_5::extra::enveloped_msg::just_envelope_t
+	{
+		using base_type_t = so_5::extra::enveloped_msg::just_envelope_t;
+
+		adaptive_counter_t & m_counter;
+
+		//! Time when the message was sent.
+		const std::chrono::steady_clock::time_point m_sent_at;
+
+	public:
+		//! Initializing constructor.
+		adaptive_special_envelope_t(
+			message_ref_t payload,
+			outliving_reference_t< adaptive_counter_t > counter )
+			:	base_type_t{ std::move(payload) }
+			,	m_counter{ counter.get() }
+			,	m_sent_at{ std::chrono::steady_clock::now() }
+			{}
+
+		~adaptive_special_envelope_t() noexcept override
+			{
+				// Counter should always be decremented because it was
+				// incremented before the creation of envelope instance.
+				// NOTE: the counter can be destroyed here.
+				m_counter.on_completed( m_sent_at );
+			}
+	};
+
+/*!
+ * \brief Helper type that tells that underlying mbox isn't nullptr.
+ *
+ * \since v.1.5.2
+ */
+class not_null_underlying_mbox_t
+	{
+		friend not_null_underlying_mbox_t
+		ensure_underlying_mbox_not_null( so_5::mbox_t );
+
+		so_5::mbox_t m_value;
+
+		not_null_underlying_mbox_t( so_5::mbox_t value )
+			:	m_value{ std::move(value) }
+			{}
+
+	public:
+		[[nodiscard]]
+		const so_5::mbox_t &
+		value() const noexcept { return m_value; }
+	};
+
+//! Ensure that underlying mbox is not nullptr.
+/*!
+ * \throw so_5::exception_t if \a mbox is nullptr.
+ */
+[[nodiscard]]
+inline not_null_underlying_mbox_t
+ensure_underlying_mbox_not_null(
+	so_5::mbox_t mbox )
+	{
+		if( !mbox )
+			SO_5_THROW_EXCEPTION(
+					errors::rc_nullptr_as_underlying_mbox,
+					"nullptr is used as underlying mbox" );
+
+		return { std::move(mbox) };
+	}
+
+/*!
+ * \brief Basic part of implementation of inflight_limit_mbox.
+ *
+ * Implements all methods of abstract_message_box_t except
+ * do_deliver_message(). Those methods are delegated to the underlying mbox.
+ *
+ * \tparam Tracing_Base base class with implementation of message
+ * delivery tracing methods.
+ *
+ * \since v.1.7.0
+ */
+template< typename Tracing_Base >
+class basic_mbox_t
+	: public so_5::abstract_message_box_t
+	, protected Tracing_Base
+	{
+	protected:
+		//! Actual underlying mbox to be used for all calls.
+		/*!
+		 * \attention Should not be nullptr.
 		 */
 		const so_5::mbox_t m_underlying_mbox;
 
@@ -274,10 +951,6 @@ class actual_mbox_t final
 		//! The limit of inflight messages.
 		const underlying_counter_t m_limit;
 
-		//! Counter for inflight instances.
-		instances_counter_shptr_t m_instances_counter;
-
-	public:
 		/*!
 		 * \brief Initializing constructor.
 		 *
@@ -285,7 +958,7 @@ class actual_mbox_t final
 		 * (can be empty list if Tracing_Base have only the default constructor).
 		 */
 		template< typename... Tracing_Args >
-		actual_mbox_t(
+		basic_mbox_t(
 			//! Destination mbox.
 			const not_null_underlying_mbox_t & dest_mbox,
 			//! Type of a message for that mbox.
@@ -298,9 +971,9 @@ class actual_mbox_t final
 			,	m_underlying_mbox{ dest_mbox.value() }
 			,	m_msg_type{ std::move(msg_type) }
 			,	m_limit{ limit }
-			,	m_instances_counter{ std::make_shared< instances_counter_t >() }
 			{}
 
+	public:
 		mbox_id_t
 		id() const override
 			{
@@ -346,61 +1019,6 @@ class actual_mbox_t final
 				return m_underlying_mbox->type();
 			}
 
-		void
-		do_deliver_message(
-			message_delivery_mode_t delivery_mode,
-			const std::type_index & msg_type,
-			const message_ref_t & message,
-			unsigned int redirection_deep ) override
-			{
-				ensure_expected_msg_type(
-						msg_type,
-						"an attempt to deliver message of a different message type" );
-
-				typename Tracing_Base::deliver_op_tracer tracer{
-						*this, // as Tracing_base
-						*this, // as abstract_message_box_t
-						"deliver_message",
-						delivery_mode,
-						msg_type, message, redirection_deep };
-
-				// Step 1: increment the counter and check that the limit
-				// isn't exceeded yet.
-				counter_incrementer_t incrementer{
-						outliving_mutable( *m_instances_counter )
-					};
-				if( incrementer.value() <= m_limit )
-					{
-						// NOTE: if there will be an exception then the number
-						// of instance will be decremented by incrementer.
-						message_ref_t our_envelope{
-								std::make_unique< special_envelope_t >(
-										std::move(message),
-										m_instances_counter )
-							};
-
-						// incrementer shouldn't control the number of instances
-						// anymore.
-						incrementer.do_not_decrement_in_destructor();
-
-						// Our envelope object has to be sent.
-						m_underlying_mbox->do_deliver_message(
-								delivery_mode,
-								msg_type,
-								our_envelope,
-								redirection_deep );
-					}
-				else
-					{
-						using namespace so_5::impl::msg_tracing_helpers::details::
-								extra_inflight_limit_specifics;
-
-						tracer.make_trace(
-								"too_many_inflight_messages",
-								limit_info{ m_limit, incrementer.value() } );
-					}
-			}
-
 		void
 		set_delivery_filter(
 			const std::type_index & msg_type,
@@ -439,7 +1057,7 @@ class actual_mbox_t final
 				return m_underlying_mbox->environment();
 			}
 
-	private:
+	protected:
 		/*!
 		 * Throws an error if msg_type differs from expected message type.
 		 */
@@ -456,40 +1074,775 @@ class actual_mbox_t final
 	};
 
 /*!
- * \brief Check for compatibility between mbox type and message type.
+ * \brief Actual implementation of inflight_limit_mbox.
+ *
+ * \tparam Tracing_Base base class with implementation of message
+ * delivery tracing methods.
  *
- * Throws if mutable message is used with MPMC mbox.
- * 
  * \since v.1.5.2
  */
-template< typename Msg_Type >
-void
-ensure_valid_message_type_for_underlying_mbox(
-	//! NOTE: it's expected to be not-null.
-	const so_5::mbox_t & underlying_mbox )
+template< typename Tracing_Base >
+class actual_mbox_t final : public basic_mbox_t< Tracing_Base >
 	{
-		// Use of mutable message type for MPMC mbox should be prohibited.
-		if constexpr( is_mutable_message< Msg_Type >::value )
+		using base_type_t = basic_mbox_t< Tracing_Base >;
+
+		//! Counter for inflight instances.
+		const shared_counter_owner_t m_instances_counter;
+
+	public:
+		/*!
+		 * \brief Initializing constructor.
+		 *
+		 * \tparam Tracing_Args parameters for Tracing_Base constructor
+		 * (can be empty list if Tracing_Base have only the default constructor).
+		 */
+		template< typename... Tracing_Args >
+		actual_mbox_t(
+			//! Destination mbox.
+			const not_null_underlying_mbox_t & dest_mbox,
+			//! Type of a message for that mbox.
+			std::type_index msg_type,
+			//! The limit of inflight messages.
+			underlying_counter_t limit,
+			//! Counter for inflight instances.
+			//! It can be shared with other mboxes.
+			shared_counter_owner_t instances_counter,
+			//! Optional parameters for Tracing_Base's constructor.
+			Tracing_Args &&... args )
+			:	base_type_t{
+					dest_mbox,
+					std::move(msg_type),
+					limit,
+					std::forward< Tracing_Args >(args)...
+				}
+			,	m_instances_counter{ std::move(instances_counter) }
+			{}
+
+		void
+		do_deliver_message(
+			message_delivery_mode_t delivery_mode,
+			const std::type_index & msg_type,
+			const message_ref_t & message,
+			unsigned int redirection_deep ) override
 			{
-				switch( underlying_mbox->type() )
-					{
-					case mbox_type_t::multi_producer_multi_consumer:
-						SO_5_THROW_EXCEPTION(
-								so_5::rc_mutable_msg_cannot_be_delivered_via_mpmc_mbox,
-								"an attempt to make MPMC mbox for mutable message, "
-								"msg_type=" + std::string(typeid(Msg_Type).name()) );
-					break;
+				this->ensure_expected_msg_type(
+						msg_type,
+						"an attempt to deliver message of a different message type" );
 
-					case mbox_type_t::multi_producer_single_consumer:
-					break;
-					}
-			}
-	}
+				typename Tracing_Base::deliver_op_tracer tracer{
+						*this, // as Tracing_base
+						*this, // as abstract_message_box_t
+						"deliver_message",
+						delivery_mode,
+						msg_type, message, redirection_deep };
 
-} /* namespace impl */
+				// Step 1: increment the counter and check that the limit
+				// isn't exceeded yet.
+				counter_incrementer_t incrementer{
+						outliving_mutable< shared_counter_t >( m_instances_counter.get() )
+					};
+				if( incrementer.value() <= this->m_limit )
+					{
+						// NOTE: if there will be an exception then the number
+						// of instance will be decremented by incrementer.
+						message_ref_t our_envelope{
+								std::make_unique< special_envelope_t >(
+										message,
+										outliving_mutable( m_instances_counter.get() ) )
+							};
 
-/*!
- * \brief Create an instance of inflight_limit_mbox.
+						// incrementer shouldn't control the number of instances
+						// anymore.
+						incrementer.do_not_decrement_in_destructor();
+
+						// Our envelope object has to be sent.
+						this->m_underlying_mbox->do_deliver_message(
+								delivery_mode,
+								msg_type,
+								our_envelope,
+								redirection_deep );
+					}
+				else
+					{
+						using namespace so_5::impl::msg_tracing_helpers::details::
+								extra_inflight_limit_specifics;
+
+						tracer.make_trace(
+								"too_many_inflight_messages",
+								limit_info{ this->m_limit, incrementer.value() } );
+					}
+			}
+	};
+
+/*!
+ * \brief Actual implementation of inflight_limit_mbox with watermarks.
+ *
+ * \tparam Tracing_Base base class with implementation of message
+ * delivery tracing methods.
+ *
+ * \since v.1.7.0
+ */
+template< typename Tracing_Base >
+class actual_watermark_mbox_t final : public basic_mbox_t< Tracing_Base >
+	{
+		using base_type_t = basic_mbox_t< Tracing_Base >;
+
+		//! Counter for inflight instances.
+		const counter_owner_t< watermark_counter_t > m_instances_counter;
+
+	public:
+		/*!
+		 * \brief Initializing constructor.
+		 *
+		 * \tparam Tracing_Args parameters for Tracing_Base constructor
+		 * (can be empty list if Tracing_Base have only the default constructor).
+		 */
+		template< typename... Tracing_Args >
+		actual_watermark_mbox_t(
+			//! Destination mbox.
+			const not_null_underlying_mbox_t & dest_mbox,
+			//! Type of a message for that mbox.
+			std::type_index msg_type,
+			//! The limit of inflight messages.
+			underlying_counter_t limit,
+			//! Values of watermarks.
+			watermarks_t watermarks,
+			//! Destination for notifications.
+			so_5::mbox_t notification_mbox,
+			//! Optional parameters for Tracing_Base's constructor.
+			Tracing_Args &&... args )
+			:	base_type_t{
+					dest_mbox,
+					std::move(msg_type),
+					limit,
+					std::forward< Tracing_Args >(args)...
+				}
+			,	m_instances_counter{
+					std::in_place, watermarks, std::move(notification_mbox)
+				}
+			{}
+
+		void
+		do_deliver_message(
+			message_delivery_mode_t delivery_mode,
+			const std::type_index & msg_type,
+			const message_ref_t & message,
+			unsigned int redirection_deep ) override
+			{
+				this->ensure_expected_msg_type(
+						msg_type,
+						"an attempt to deliver message of a different message type" );
+
+				typename Tracing_Base::deliver_op_tracer tracer{
+						*this, // as Tracing_base
+						*this, // as abstract_message_box_t
+						"deliver_message",
+						delivery_mode,
+						msg_type, message, redirection_deep };
+
+				// Step 1: increment the counter and check that the limit
+				// isn't exceeded yet.
+				auto & counter = m_instances_counter.get();
+				counter_incrementer_t incrementer{
+						outliving_mutable< shared_counter_t >( counter )
+					};
+				if( incrementer.value() <= this->m_limit )
+					{
+						// NOTE: if there will be an exception then the number
+						// of instance will be decremented by incrementer.
+						message_ref_t our_envelope{
+								std::make_unique< watermark_special_envelope_t >(
+										message,
+										outliving_mutable( counter ) )
+							};
+
+						// incrementer shouldn't control the number of instances
+						// anymore.
+						incrementer.do_not_decrement_in_destructor();
+
+						counter.on_incremented( incrementer.value() );
+
+						// Our envelope object has to be sent.
+						this->m_underlying_mbox->do_deliver_message(
+								delivery_mode,
+								msg_type,
+								our_envelope,
+								redirection_deep );
+					}
+				else
+					{
+						// NOTE: the high watermark can't be greater than the
+						// limit, so there is no need to check watermarks when
+						// incrementer decrements the counter.
+						using namespace so_5::impl::msg_tracing_helpers::details::
+								extra_inflight_limit_specifics;
+
+						tracer.make_trace(
+								"too_many_inflight_messages",
+								limit_info{ this->m_limit, incrementer.value() } );
+					}
+			}
+	};
+
+/*!
+ * \brief Actual implementation of inflight_limit_mbox with adaptive limit.
+ *
+ * \tparam Tracing_Base base class with implementation of message
+ * delivery tracing methods.
+ *
+ * \since v.1.7.0
+ */
+template< typename Tracing_Base >
+class actual_adaptive_mbox_t final : public basic_mbox_t< Tracing_Base >
+	{
+		using base_type_t = basic_mbox_t< Tracing_Base >;
+
+		//! Counter for inflight instances.
+		const counter_owner_t< adaptive_counter_t > m_instances_counter;
+
+	public:
+		/*!
+		 * \brief Initializing constructor.
+		 *
+		 * \tparam Tracing_Args parameters for Tracing_Base constructor
+		 * (can be empty list if Tracing_Base have only the default constructor).
+		 */
+		template< typename... Tracing_Args >
+		actual_adaptive_mbox_t(
+			//! Destination mbox.
+			const not_null_underlying_mbox_t & dest_mbox,
+			//! Type of a message for that mbox.
+			std::type_index msg_type,
+			//! Parameters of the adaptive limit.
+			const adaptive_limit_params_t & params,
+			//! Optional parameters for Tracing_Base's constructor.
+			Tracing_Args &&... args )
+			:	base_type_t{
+					dest_mbox,
+					std::move(msg_type),
+					params.max_limit(),
+					std::forward< Tracing_Args >(args)...
+				}
+			,	m_instances_counter{ std::in_place, params }
+			{}
+
+		void
+		do_deliver_message(
+			message_delivery_mode_t delivery_mode,
+			const std::type_index & msg_type,
+			const message_ref_t & message,
+			unsigned int redirection_deep ) override
+			{
+				this->ensure_expected_msg_type(
+						msg_type,
+						"an attempt to deliver message of a different message type" );
+
+				typename Tracing_Base::deliver_op_tracer tracer{
+						*this, // as Tracing_base
+						*this, // as abstract_message_box_t
+						"deliver_message",
+						delivery_mode,
+						msg_type, message, redirection_deep };
+
+				// Step 1: increment the counter and check that the current
+				// limit isn't exceeded yet.
+				auto & counter = m_instances_counter.get();
+				counter_incrementer_t incrementer{
+						outliving_mutable< shared_counter_t >( counter )
+					};
+				const auto limit = counter.current_limit();
+				if( incrementer.value() <= limit )
+					{
+						// NOTE: if there will be an exception then the number
+						// of instance will be decremented by incrementer.
+						message_ref_t our_envelope{
+								std::make_unique< adaptive_special_envelope_t >(
+										message,
+										outliving_mutable( counter ) )
+							};
+
+						// incrementer shouldn't control the number of instances
+						// anymore.
+						incrementer.do_not_decrement_in_destructor();
+
+						// Our envelope object has to be sent.
+						this->m_underlying_mbox->do_deliver_message(
+								delivery_mode,
+								msg_type,
+								our_envelope,
+								redirection_deep );
+					}
+				else
+					{
+						using namespace so_5::impl::msg_tracing_helpers::details::
+								extra_inflight_limit_specifics;
+
+						tracer.make_trace(
+								"too_many_inflight_messages",
+								limit_info{ limit, incrementer.value() } );
+					}
+			}
+	};
+
+//
+// per_key_counters_t
+//
+/*!
+ * \brief A concurrent hash table with counters of inflight messages
+ * for individual keys.
+ *
+ * The table is divided into several shards. Every shard is protected
+ * by its own mutex, so senders with different keys rarely contend with
+ * each other.
+ *
+ * A counter for a key is created by acquire() and is removed from the
+ * table when the number of inflight messages for that key returns to zero.
+ *
+ * The table itself is a counter of all inflight messages. It's owned
+ * by the mbox and is kept alive by inflight messages, so envelopes can
+ * hold plain references to the table and to the counter for a key.
+ *
+ * \tparam Key type of the key. It should be usable as a key for
+ * std::unordered_map.
+ *
+ * \since v.1.7.0
+ */
+template< typename Key >
+class per_key_counters_t final : public shared_counter_t
+	{
+		//! Number of shards in the table.
+		static constexpr std::size_t shards_count = 16u;
+
+		//! One shard of the table.
+		struct shard_t
+			{
+				std::mutex m_lock;
+				std::unordered_map< Key, shared_counter_owner_t > m_counters;
+			};
+
+		//! All shards.
+		std::array< shard_t, shards_count > m_shards;
+
+		[[nodiscard]]
+		shard_t &
+		shard_for( const Key & key )
+			{
+				return m_shards[ std::hash< Key >{}( key ) % shards_count ];
+			}
+
+	public:
+		//! Result of acquire() operation.
+		struct acquired_counter_t
+			{
+				//! Counter for the key.
+				shared_counter_t & m_counter;
+				//! The value of the counter just after the increment.
+				underlying_counter_t m_value;
+			};
+
+		//! Find or create the counter for the key and increment it.
+		/*!
+		 * \attention
+		 * Every successful call to acquire() has to be paired with a call
+		 * to release().
+		 */
+		[[nodiscard]]
+		acquired_counter_t
+		acquire( const Key & key )
+			{
+				shard_t & shard = shard_for( key );
+
+				std::lock_guard< std::mutex > lock{ shard.m_lock };
+
+				auto & counter = shard.m_counters.try_emplace( key ).first->second.get();
+
+				// NOTE: the increment is performed under the lock, so the
+				// counter can't be removed from the table concurrently.
+				const auto value = counter.increment();
+
+				// The table has to live while there is an inflight message.
+				(void)this->increment();
+
+				return { counter, value };
+			}
+
+		//! Decrement the counter for the key.
+		/*!
+		 * The counter is removed from the table if it becomes zero.
+		 *
+		 * \attention
+		 * The table can be destroyed inside this call.
+		 */
+		void
+		release(
+			const Key & key,
+			shared_counter_t & counter ) noexcept
+			{
+				// NOTE: the counter for the key is owned by the table
+				// and can't be destroyed here.
+				if( 0u == counter.decrement_and_fetch() )
+					{
+						// The counter has to be checked again under the lock
+						// because it could be incremented by a concurrent acquire().
+						shard_t & shard = shard_for( key );
+
+						std::lock_guard< std::mutex > lock{ shard.m_lock };
+
+						const auto it = shard.m_counters.find( key );
+						if( it != shard.m_counters.end() &&
+								0u == it->second.get().inflight() )
+							shard.m_counters.erase( it );
+					}
+
+				// It has to be the last action because the table can be
+				// destroyed here.
+				this->decrement();
+			}
+	};
+
+/*!
+ * \brief Helper class for incrementing/decrementing number of messages
+ * for a key in RAII style.
+ *
+ * It's the same thing as counter_incrementer_t but for per_key_counters_t.
+ *
+ * \since v.1.7.0
+ */
+template< typename Key >
+class per_key_counter_incrementer_t
+	{
+		using counters_t = per_key_counters_t< Key >;
+
+		counters_t & m_counters;
+		const Key & m_key;
+		const typename counters_t::acquired_counter_t m_acquired;
+
+		bool m_should_decrement_in_destructor{ true };
+
+	public:
+		per_key_counter_incrementer_t(
+			outliving_reference_t< counters_t > counters,
+			outliving_reference_t< const Key > key )
+			:	m_counters{ counters.get() }
+			,	m_key{ key.get() }
+			,	m_acquired{ m_counters.acquire( m_key ) }
+			{}
+
+		~per_key_counter_incrementer_t() noexcept
+			{
+				if( m_should_decrement_in_destructor )
+					m_counters.release( m_key, m_acquired.m_counter );
+			}
+
+		void
+		do_not_decrement_in_destructor() noexcept
+			{
+				m_should_decrement_in_destructor = false;
+			}
+
+		[[nodiscard]]
+		shared_counter_t &
+		counter() const noexcept
+			{
+				return m_acquired.m_counter;
+			}
+
+		[[nodiscard]]
+		underlying_counter_t
+		value() const noexcept
+			{
+				return m_acquired.m_value;
+			}
+	};
+
+/*!
+ * \brief Type of envelope to be used by inflight_limit_mbox with
+ * per-key limits.
+ *
+ * \attention
+ * The envelope expects that the number of messages for the key is already
+ * incremented before the creation of the envelope. That number is always
+ * decremented in the destructor.
+ *
+ * \since v.1.7.0
+ */
+template< typename Key >
+class per_key_special_envelope_t final
+	: public so_5::extra::enveloped_msg::just_envelope_t
+	{
+		using base_type_t = so_5::extra::enveloped_msg::just_envelope_t;
+
+		per_key_counters_t< Key > & m_counters;
+		const Key m_key;
+		shared_counter_t & m_counter;
+
+	public:
+		//! Initializing constructor.
+		per_key_special_envelope_t(
+			message_ref_t payload,
+			outliving_reference_t< per_key_counters_t< Key > > counters,
+			Key key,
+			outliving_reference_t< shared_counter_t > counter )
+			:	base_type_t{ std::move(payload) }
+			,	m_counters{ counters.get() }
+			,	m_key{ std::move(key) }
+			,	m_counter{ counter.get() }
+			{}
+
+		~per_key_special_envelope_t() noexcept override
+			{
+				// Counter should always be decremented because it was
+				// incremented before the creation of envelope instance.
+				// NOTE: the table can be destroyed here.
+				m_counters.release( m_key, m_counter );
+			}
+	};
+
+using ::so_5::extra::enveloped_msg::impl::payload_extractor_t;
+
+/*!
+ * \brief Actual implementation of inflight_limit_mbox with per-key limits.
+ *
+ * \tparam Msg_Type type of message to be used with this mbox.
+ *
+ * \tparam Key_Extractor type of functor that returns a key for a message.
+ *
+ * \tparam Tracing_Base base class with implementation of message
+ * delivery tracing methods.
+ *
+ * \since v.1.7.0
+ */
+template<
+	typename Msg_Type,
+	typename Key_Extractor,
+	typename Tracing_Base >
+class actual_per_key_mbox_t final : public basic_mbox_t< Tracing_Base >
+	{
+		using base_type_t = basic_mbox_t< Tracing_Base >;
+
+		//! Type of message payload.
+		using payload_t = typename message_payload_type< Msg_Type >::payload_type;
+
+		//! Type of the key.
+		using key_t = std::decay_t<
+				std::invoke_result_t< const Key_Extractor &, const payload_t & > >;
+
+		//! Functor for getting the key from a message.
+		const Key_Extractor m_key_extractor;
+
+		//! Counters of inflight instances for keys.
+		const counter_owner_t< per_key_counters_t< key_t > > m_counters;
+
+	public:
+		/*!
+		 * \brief Initializing constructor.
+		 *
+		 * \tparam Tracing_Args parameters for Tracing_Base constructor
+		 * (can be empty list if Tracing_Base have only the default constructor).
+		 */
+		template< typename... Tracing_Args >
+		actual_per_key_mbox_t(
+			//! Destination mbox.
+			const not_null_underlying_mbox_t & dest_mbox,
+			//! The limit of inflight messages for every key.
+			underlying_counter_t limit,
+			//! Functor for getting the key from a message.
+			Key_Extractor key_extractor,
+			//! Optional parameters for Tracing_Base's constructor.
+			Tracing_Args &&... args )
+			:	base_type_t{
+					dest_mbox,
+					message_payload_type< Msg_Type >::subscription_type_index(),
+					limit,
+					std::forward< Tracing_Args >(args)...
+				}
+			,	m_key_extractor{ std::move(key_extractor) }
+			,	m_counters{ std::in_place }
+			{}
+
+		void
+		do_deliver_message(
+			message_delivery_mode_t delivery_mode,
+			const std::type_index & msg_type,
+			const message_ref_t & message,
+			unsigned int redirection_deep ) override
+			{
+				this->ensure_expected_msg_type(
+						msg_type,
+						"an attempt to deliver message of a different message type" );
+
+				typename Tracing_Base::deliver_op_tracer tracer{
+						*this, // as Tracing_base
+						*this, // as abstract_message_box_t
+						"deliver_message",
+						delivery_mode,
+						msg_type, message, redirection_deep };
+
+				const message_ref_t payload = payload_extractor_t::extract( message );
+				if( !payload )
+					{
+						// Message was revoked or something like that.
+						tracer.make_trace( "payload_is_not_available" );
+						return;
+					}
+
+				const key_t key = m_key_extractor(
+						message_payload_type< Msg_Type >::payload_reference(
+								*payload ) );
+
+				// Step 1: increment the counter for the key and check that
+				// the limit isn't exceeded yet.
+				per_key_counter_incrementer_t< key_t > incrementer{
+						outliving_mutable( m_counters.get() ),
+						outliving_const( key )
+					};
+				if( incrementer.value() <= this->m_limit )
+					{
+						// NOTE: if there will be an exception then the number
+						// of instance will be decremented by incrementer.
+						message_ref_t our_envelope{
+								std::make_unique< per_key_special_envelope_t< key_t > >(
+										message,
+										outliving_mutable( m_counters.get() ),
+										key,
+										outliving_mutable( incrementer.counter() ) )
+							};
+
+						// incrementer shouldn't control the number of instances
+						// anymore.
+						incrementer.do_not_decrement_in_destructor();
+
+						// Our envelope object has to be sent.
+						this->m_underlying_mbox->do_deliver_message(
+								delivery_mode,
+								msg_type,
+								our_envelope,
+								redirection_deep );
+					}
+				else
+					{
+						using namespace so_5::impl::msg_tracing_helpers::details::
+								extra_inflight_limit_specifics;
+
+						tracer.make_trace(
+								"too_many_inflight_messages_for_key",
+								limit_info{ this->m_limit, incrementer.value() } );
+					}
+			}
+	};
+
+/*!
+ * \brief Check for compatibility between mbox type and message type.
+ *
+ * Throws if mutable message is used with MPMC mbox.
+ * 
+ * \since v.1.5.2
+ */
+template< typename Msg_Type >
+void
+ensure_valid_message_type_for_underlying_mbox(
+	//! NOTE: it's expected to be not-null.
+	const so_5::mbox_t & underlying_mbox )
+	{
+		// Use of mutable message type for MPMC mbox should be prohibited.
+		if constexpr( is_mutable_message< Msg_Type >::value )
+			{
+				switch( underlying_mbox->type() )
+					{
+					case mbox_type_t::multi_producer_multi_consumer:
+						SO_5_THROW_EXCEPTION(
+								so_5::rc_mutable_msg_cannot_be_delivered_via_mpmc_mbox,
+								"an attempt to make MPMC mbox for mutable message, "
+								"msg_type=" + std::string(typeid(Msg_Type).name()) );
+					break;
+
+					case mbox_type_t::multi_producer_single_consumer:
+					break;
+					}
+			}
+	}
+
+/*!
+ * \brief Helper for creation of actual_mbox_t instance.
+ *
+ * \tparam Msg_Type type of message to be used with a new mbox.
+ *
+ * \since v.1.7.0
+ */
+template< typename Msg_Type >
+[[nodiscard]]
+mbox_t
+make_actual_mbox(
+	//! Actual destination mbox.
+	mbox_t dest_mbox,
+	//! The limit of inflight messages.
+	underlying_counter_t inflight_limit,
+	//! Counter for inflight instances.
+	shared_counter_owner_t instances_counter )
+	{
+		const auto underlying_mbox = ensure_underlying_mbox_not_null(
+				std::move(dest_mbox) );
+
+		// Use of mutable message type for MPMC mbox should be prohibited.
+		ensure_valid_message_type_for_underlying_mbox< Msg_Type >(
+				underlying_mbox.value() );
+
+		auto & env = underlying_mbox.value()->environment();
+
+		return env.make_custom_mbox(
+				[&]( const mbox_creation_data_t & data )
+				{
+					mbox_t result;
+
+					if( data.m_tracer.get().is_msg_tracing_enabled() )
+						{
+							using T = actual_mbox_t<
+									::so_5::impl::msg_tracing_helpers::tracing_enabled_base >;
+
+							result = mbox_t{ new T{
+									underlying_mbox,
+									message_payload_type< Msg_Type >::subscription_type_index(),
+									inflight_limit,
+									std::move(instances_counter),
+									data.m_tracer
+								} };
+						}
+					else
+						{
+							using T = actual_mbox_t<
+									::so_5::impl::msg_tracing_helpers::tracing_disabled_base >;
+
+							result = mbox_t{ new T{
+									underlying_mbox,
+									message_payload_type< Msg_Type >::subscription_type_index(),
+									inflight_limit,
+									std::move(instances_counter)
+								} };
+						}
+
+					return result;
+				} );
+	}
+
+/*!
+ * \brief Helper for accessing the internals of shared_budget_t.
+ *
+ * \since v.1.7.0
+ */
+struct shared_budget_accessor_t
+	{
+		[[nodiscard]]
+		static const shared_counter_owner_t &
+		counter( const shared_budget_t & budget ) noexcept
+			{
+				return budget.m_counter;
+			}
+	};
+
+} /* namespace impl */
+
+/*!
+ * \brief Create an instance of inflight_limit_mbox.
  *
  * Usage example:
  *
@@ -526,6 +1879,237 @@ make_mbox(
 	mbox_t dest_mbox,
 	//! The limit of inflight messages.
 	underlying_counter_t inflight_limit )
+	{
+		return impl::make_actual_mbox< Msg_Type >(
+				std::move(dest_mbox),
+				inflight_limit,
+				impl::shared_counter_owner_t{} );
+	}
+
+/*!
+ * \brief Create an instance of inflight_limit_mbox that uses a shared budget.
+ *
+ * All inflight_limit_mboxes created for the same \a budget share the same
+ * counter of inflight messages. It allows to limit the total number of
+ * inflight messages of different types.
+ *
+ * Usage example:
+ *
+ * \code
+ * namespace mbox_ns = so_5::extra::mboxes::inflight_limit;
+ *
+ * // All requests use the same pool of DB connections.
+ * mbox_ns::shared_budget_t db_budget{ 16u };
+ *
+ * auto select_mbox = mbox_ns::make_mbox< select_request >( workers_mbox, db_budget );
+ * auto insert_mbox = mbox_ns::make_mbox< insert_request >( workers_mbox, db_budget );
+ * auto update_mbox = mbox_ns::make_mbox< update_request >( workers_mbox, db_budget );
+ * \endcode
+ *
+ * \tparam Msg_Type type of message to be used with a new mbox.
+ *
+ * \since v.1.7.0
+ */
+template< typename Msg_Type >
+[[nodiscard]]
+mbox_t
+make_mbox(
+	//! Actual destination mbox.
+	mbox_t dest_mbox,
+	//! The budget to be used.
+	const shared_budget_t & budget )
+	{
+		return impl::make_actual_mbox< Msg_Type >(
+				std::move(dest_mbox),
+				budget.limit(),
+				impl::shared_budget_accessor_t::counter( budget ) );
+	}
+
+/*!
+ * \brief Create an instance of inflight_limit_mbox with separate limits
+ * for different keys.
+ *
+ * The key for a message is returned by \a key_extractor. Every key has its
+ * own counter of inflight messages, so a flood of messages with one key
+ * can't use the whole capacity of receivers and block messages with other
+ * keys.
+ *
+ * Counters are held in a concurrent hash table and a counter for a key
+ * is removed from the table when there is no more inflight messages with
+ * that key.
+ *
+ * Usage example:
+ *
+ * \code
+ * namespace mbox_ns = so_5::extra::mboxes::inflight_limit;
+ *
+ * struct request final : public so_5::message_t
+ * {
+ * 	std::string m_customer_id;
+ * 	...
+ * };
+ *
+ * so_5::environment_t & env = ...;
+ *
+ * // No more than 8 inflight requests for every customer.
+ * auto my_mbox = mbox_ns::make_per_key_mbox< request >(
+ * 		env.create_mbox(),
+ * 		8u,
+ * 		[]( const request & r ) { return r.m_customer_id; } );
+ * \endcode
+ *
+ * \note
+ * \a key_extractor is called for every message sent to the mbox.
+ * It should be a thread safe and shouldn't throw exceptions.
+ *
+ * \tparam Msg_Type type of message to be used with a new mbox.
+ * It can't be a signal.
+ *
+ * \tparam Key_Extractor type of functor that accepts const reference to
+ * the message and returns the key. The type of the key should be suitable
+ * for std::unordered_map (there should be std::hash specialization for it).
+ *
+ * \since v.1.7.0
+ */
+template< typename Msg_Type, typename Key_Extractor >
+[[nodiscard]]
+mbox_t
+make_per_key_mbox(
+	//! Actual destination mbox.
+	mbox_t dest_mbox,
+	//! The limit of inflight messages for every key.
+	underlying_counter_t inflight_limit_per_key,
+	//! Functor for getting the key from a message.
+	Key_Extractor key_extractor )
+	{
+		static_assert( !is_signal< typename message_payload_type< Msg_Type >::payload_type >::value,
+				"per-key limits can't be used for signals" );
+
+		const auto underlying_mbox = impl::ensure_underlying_mbox_not_null(
+				std::move(dest_mbox) );
+
+		// Use of mutable message type for MPMC mbox should be prohibited.
+		impl::ensure_valid_message_type_for_underlying_mbox< Msg_Type >(
+				underlying_mbox.value() );
+
+		auto & env = underlying_mbox.value()->environment();
+
+		return env.make_custom_mbox(
+				[&]( const mbox_creation_data_t & data )
+				{
+					mbox_t result;
+
+					if( data.m_tracer.get().is_msg_tracing_enabled() )
+						{
+							using T = impl::actual_per_key_mbox_t<
+									Msg_Type,
+									Key_Extractor,
+									::so_5::impl::msg_tracing_helpers::tracing_enabled_base >;
+
+							result = mbox_t{ new T{
+									underlying_mbox,
+									inflight_limit_per_key,
+									std::move(key_extractor),
+									data.m_tracer
+								} };
+						}
+					else
+						{
+							using T = impl::actual_per_key_mbox_t<
+									Msg_Type,
+									Key_Extractor,
+									::so_5::impl::msg_tracing_helpers::tracing_disabled_base >;
+
+							result = mbox_t{ new T{
+									underlying_mbox,
+									inflight_limit_per_key,
+									std::move(key_extractor)
+								} };
+						}
+
+					return result;
+				} );
+	}
+
+/*!
+ * \brief Create an instance of inflight_limit_mbox that informs a producer
+ * about the exhaustion of capacity.
+ *
+ * This mbox works like an ordinary inflight_limit_mbox (see make_mbox()),
+ * but additionally sends msg_high_watermark to \a notification_mbox when
+ * the number of inflight messages reaches \a watermarks.m_high.
+ * When the number of inflight messages drops to \a watermarks.m_low
+ * msg_low_watermark is sent to \a notification_mbox.
+ *
+ * It allows a producer to suspend sending of messages before the limit
+ * is reached and messages are dropped.
+ *
+ * Usage example:
+ *
+ * \code
+ * namespace mbox_ns = so_5::extra::mboxes::inflight_limit;
+ *
+ * class producer final : public so_5::agent_t
+ * {
+ * 	state_t st_sending{ this };
+ * 	state_t st_throttled{ this };
+ *
+ * 	const so_5::mbox_t m_dest;
+ *
+ * public:
+ * 	producer(context_t ctx, so_5::mbox_t workers_mbox)
+ * 		:	so_5::agent_t{std::move(ctx)}
+ * 		,	m_dest{ mbox_ns::make_mbox_with_watermarks<task>(
+ * 				std::move(workers_mbox),
+ * 				// Limit of inflight messages.
+ * 				100u,
+ * 				// Stop sending at 80 inflight messages and resume
+ * 				// when there will be only 20 of them.
+ * 				mbox_ns::watermarks_t{ 80u, 20u },
+ * 				so_direct_mbox() ) }
+ * 	{}
+ *
+ * 	void so_define_agent() override
+ * 	{
+ * 		st_sending
+ * 			.on_enter( [this]{ send_next_portion(); } )
+ * 			.event( [this](mhood_t<mbox_ns::msg_high_watermark>) {
+ * 					st_throttled.activate();
+ * 				} );
+ * 		st_throttled
+ * 			.event( [this](mhood_t<mbox_ns::msg_low_watermark>) {
+ * 					st_sending.activate();
+ * 				} );
+ * 		...
+ * 	}
+ * 	...
+ * };
+ * \endcode
+ *
+ * \note
+ * Notifications are sent from the context of a sender (for
+ * msg_high_watermark) or from the context of a thread that destroys
+ * the last reference to a message (for msg_low_watermark).
+ * The mbox terminates the whole application if an attempt to send a
+ * notification throws.
+ *
+ * \tparam Msg_Type type of message to be used with a new mbox.
+ *
+ * \since v.1.7.0
+ */
+template< typename Msg_Type >
+[[nodiscard]]
+mbox_t
+make_mbox_with_watermarks(
+	//! Actual destination mbox.
+	mbox_t dest_mbox,
+	//! The limit of inflight messages.
+	underlying_counter_t inflight_limit,
+	//! Values of watermarks.
+	//! The following condition should be met: low < high <= inflight_limit.
+	watermarks_t watermarks,
+	//! Destination for msg_high_watermark and msg_low_watermark.
+	mbox_t notification_mbox )
 	{
 		const auto underlying_mbox = impl::ensure_underlying_mbox_not_null(
 				std::move(dest_mbox) );
@@ -534,34 +2118,150 @@ make_mbox(
 		impl::ensure_valid_message_type_for_underlying_mbox< Msg_Type >(
 				underlying_mbox.value() );
 
+		if( !( watermarks.m_low < watermarks.m_high &&
+				watermarks.m_high <= inflight_limit ) )
+			SO_5_THROW_EXCEPTION(
+					errors::rc_invalid_watermarks,
+					"invalid watermarks, low=" + std::to_string( watermarks.m_low )
+					+ ", high=" + std::to_string( watermarks.m_high )
+					+ ", inflight_limit=" + std::to_string( inflight_limit ) );
+
+		if( !notification_mbox )
+			SO_5_THROW_EXCEPTION(
+					errors::rc_nullptr_as_notification_mbox,
+					"nullptr is used as notification mbox" );
+
 		auto & env = underlying_mbox.value()->environment();
 
 		return env.make_custom_mbox(
-				[&underlying_mbox, inflight_limit]( const mbox_creation_data_t & data )
+				[&]( const mbox_creation_data_t & data )
 				{
 					mbox_t result;
 
 					if( data.m_tracer.get().is_msg_tracing_enabled() )
 						{
-							using T = impl::actual_mbox_t<
+							using T = impl::actual_watermark_mbox_t<
 									::so_5::impl::msg_tracing_helpers::tracing_enabled_base >;
 
 							result = mbox_t{ new T{
 									underlying_mbox,
 									message_payload_type< Msg_Type >::subscription_type_index(),
 									inflight_limit,
+									watermarks,
+									std::move(notification_mbox),
+									data.m_tracer
+								} };
+						}
+					else
+						{
+							using T = impl::actual_watermark_mbox_t<
+									::so_5::impl::msg_tracing_helpers::tracing_disabled_base >;
+
+							result = mbox_t{ new T{
+									underlying_mbox,
+									message_payload_type< Msg_Type >::subscription_type_index(),
+									inflight_limit,
+									watermarks,
+									std::move(notification_mbox)
+								} };
+						}
+
+					return result;
+				} );
+	}
+
+/*!
+ * \brief Create an instance of inflight_limit_mbox with adaptive limit.
+ *
+ * The limit of inflight messages isn't fixed for this mbox. The mbox
+ * measures the time between sending of a message and the destruction
+ * of the message (it's the time the message spent in queues and in
+ * the handler) and:
+ *
+ * - increases the limit by one while that time isn't greater than the
+ *   target latency (and the current limit is used at least by half);
+ * - decreases the limit multiplicatively when that time is greater than
+ *   the target latency.
+ *
+ * The limit is always kept in [min_limit, max_limit] range.
+ *
+ * Usage example:
+ *
+ * \code
+ * namespace mbox_ns = so_5::extra::mboxes::inflight_limit;
+ *
+ * so_5::environment_t & env = ...;
+ *
+ * // Start with 16 inflight messages and try to keep the latency
+ * // not greater than 20ms.
+ * auto my_mbox = mbox_ns::make_adaptive_mbox<my_msg>(
+ * 		env.create_mbox(),
+ * 		mbox_ns::adaptive_limit_params_t{ 16u, std::chrono::milliseconds{20} } );
+ * \endcode
+ *
+ * \note
+ * The latency is measured at the time of destruction of the message.
+ * If a receiver holds a reference to the message after the completion of
+ * the handler then the measured latency will be greater than the real one.
+ *
+ * \tparam Msg_Type type of message to be used with a new mbox.
+ *
+ * \since v.1.7.0
+ */
+template< typename Msg_Type >
+[[nodiscard]]
+mbox_t
+make_adaptive_mbox(
+	//! Actual destination mbox.
+	mbox_t dest_mbox,
+	//! Parameters of the adaptive limit.
+	const adaptive_limit_params_t & params )
+	{
+		const auto underlying_mbox = impl::ensure_underlying_mbox_not_null(
+				std::move(dest_mbox) );
+
+		// Use of mutable message type for MPMC mbox should be prohibited.
+		impl::ensure_valid_message_type_for_underlying_mbox< Msg_Type >(
+				underlying_mbox.value() );
+
+		if( !( 0u < params.min_limit() &&
+				params.min_limit() <= params.initial_limit() &&
+				params.initial_limit() <= params.max_limit() &&
+				0.0 < params.backoff_ratio() && params.backoff_ratio() < 1.0 ) )
+			SO_5_THROW_EXCEPTION(
+					errors::rc_invalid_adaptive_limit_params,
+					"invalid adaptive limit params, the following conditions "
+					"should be met: 0 < min_limit <= initial_limit <= max_limit, "
+					"0 < backoff_ratio < 1" );
+
+		auto & env = underlying_mbox.value()->environment();
+
+		return env.make_custom_mbox(
+				[&]( const mbox_creation_data_t & data )
+				{
+					mbox_t result;
+
+					if( data.m_tracer.get().is_msg_tracing_enabled() )
+						{
+							using T = impl::actual_adaptive_mbox_t<
+									::so_5::impl::msg_tracing_helpers::tracing_enabled_base >;
+
+							result = mbox_t{ new T{
+									underlying_mbox,
+									message_payload_type< Msg_Type >::subscription_type_index(),
+									params,
 									data.m_tracer
 								} };
 						}
 					else
 						{
-							using T = impl::actual_mbox_t<
+							using T = impl::actual_adaptive_mbox_t<
 									::so_5::impl::msg_tracing_helpers::tracing_disabled_base >;
 
 							result = mbox_t{ new T{
 									underlying_mbox,
 									message_payload_type< Msg_Type >::subscription_type_index(),
-									inflight_limit
+									params
 								} };
 						}
 
@@ -576,4 +2276,3 @@ make_mbox(
 } /* namespace extra */
 
 } /* namespace so_5 */
-
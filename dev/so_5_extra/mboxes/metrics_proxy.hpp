@@ -0,0 +1,793 @@
+/*!
+ * \file
+ * \brief Implementation of proxy mbox that collects delivery metrics.
+ *
+ * \since v.1.7.0
+ */
+
+#pragma once
+
+#include <so_5_extra/mboxes/proxy.hpp>
+
+#include <so_5/stats/repository.hpp>
+#include <so_5/stats/messages.hpp>
+
+#include <so_5/send_functions.hpp>
+#include <so_5/outliving.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <typeindex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#if defined(__GNUC__)
+	#include <cxxabi.h>
+	#include <cstdlib>
+#endif
+
+namespace so_5 {
+
+namespace extra {
+
+namespace mboxes {
+
+namespace metrics_proxy {
+
+//
+// size_hook_t
+//
+/*!
+ * \brief Type of optional hook for detection of the size of a message.
+ *
+ * The hook receives the type of a message and a reference to the message
+ * instance (it can be nullptr for signals). The returned value is added
+ * to the "bytes" metric of the message type.
+ *
+ * \note
+ * The hook is called on the sender's thread for every message sent,
+ * so it should be cheap and must be thread-safe.
+ *
+ * \since v.1.7.0
+ */
+using size_hook_t = std::function<
+		std::size_t( const std::type_index &, const ::so_5::message_ref_t & ) >;
+
+namespace suffixes {
+
+/*!
+ * \brief Suffix for the count of messages of a type sent to the mbox.
+ *
+ * \since v.1.7.0
+ */
+[[nodiscard]]
+inline ::so_5::stats::suffix_t
+sends() noexcept { return ::so_5::stats::suffix_t{ "/msg.sends" }; }
+
+/*!
+ * \brief Suffix for the total size of messages of a type sent to the mbox.
+ *
+ * This value is distributed only if a size hook is specified.
+ *
+ * \since v.1.7.0
+ */
+[[nodiscard]]
+inline ::so_5::stats::suffix_t
+bytes() noexcept { return ::so_5::stats::suffix_t{ "/msg.bytes" }; }
+
+} /* namespace suffixes */
+
+namespace impl {
+
+//
+// histogram_t
+//
+/*!
+ * \brief Description of buckets for the inter-arrival histogram.
+ *
+ * Bucket boundaries grow by the power of 4 from 1us up to ~1s. The last
+ * bucket holds all intervals greater than 1048576us.
+ *
+ * Every bucket holds only intervals that fall between the previous
+ * boundary and its own one (the histogram isn't cumulative).
+ *
+ * \since v.1.7.0
+ */
+struct histogram_t
+	{
+		//! Count of buckets.
+		static constexpr std::size_t bucket_count = 12u;
+
+		//! Type of storage for bucket values.
+		using buckets_t = std::array< std::uint64_t, bucket_count >;
+
+		//! Get the index of a bucket for the interval.
+		[[nodiscard]]
+		static std::size_t
+		bucket_index( std::chrono::steady_clock::duration interval ) noexcept
+			{
+				const auto us = std::chrono::duration_cast<
+						std::chrono::microseconds >( interval ).count();
+
+				std::size_t index = 0u;
+				std::int64_t upper_bound = 1;
+				while( index + 1u < bucket_count && us > upper_bound )
+					{
+						++index;
+						upper_bound *= 4;
+					}
+
+				return index;
+			}
+
+		//! Get the suffix for a bucket.
+		[[nodiscard]]
+		static ::so_5::stats::suffix_t
+		bucket_suffix( std::size_t index ) noexcept
+			{
+				static constexpr const char * names[ bucket_count ] = {
+						"/interarrival.le_1us",
+						"/interarrival.le_4us",
+						"/interarrival.le_16us",
+						"/interarrival.le_64us",
+						"/interarrival.le_256us",
+						"/interarrival.le_1024us",
+						"/interarrival.le_4096us",
+						"/interarrival.le_16384us",
+						"/interarrival.le_65536us",
+						"/interarrival.le_262144us",
+						"/interarrival.le_1048576us",
+						"/interarrival.inf"
+					};
+
+				return ::so_5::stats::suffix_t{ names[ index ] };
+			}
+	};
+
+//
+// type_totals_t
+//
+/*!
+ * \brief Aggregated values of counters for a message type.
+ *
+ * \since v.1.7.0
+ */
+struct type_totals_t
+	{
+		//! Count of messages sent.
+		std::uint64_t m_sends{};
+
+		//! Total size of messages sent.
+		std::uint64_t m_bytes{};
+
+		//! Inter-arrival histogram.
+		histogram_t::buckets_t m_interarrival{};
+	};
+
+//
+// type_data_t
+//
+/*!
+ * \brief Data for a message type shared by all threads.
+ *
+ * \since v.1.7.0
+ */
+struct type_data_t
+	{
+		//! Type of timestamp representation.
+		using timestamp_t = std::chrono::steady_clock::rep;
+
+		//! Special value for the case when there is no arrival yet.
+		static constexpr timestamp_t no_arrival =
+				std::numeric_limits< timestamp_t >::min();
+
+		//! Timestamp of the last arrival of a message of that type.
+		/*!
+		 * It's updated by all threads that send messages of that type.
+		 * So the histogram contains intervals between subsequent messages
+		 * of the type regardless of the sending thread.
+		 */
+		std::atomic< timestamp_t > m_last_arrival{ no_arrival };
+
+		//! Values of counters from thread blocks that were already removed.
+		/*!
+		 * It's accessed under the lock of collector_data_t only.
+		 */
+		type_totals_t m_retired{};
+
+		//! Get the interval from the previous arrival and store the new one.
+		/*!
+		 * \return false if there was no previous arrival.
+		 */
+		[[nodiscard]]
+		bool
+		on_arrival(
+			std::chrono::steady_clock::time_point now,
+			std::chrono::steady_clock::duration & interval ) noexcept
+			{
+				const auto prev = m_last_arrival.exchange(
+						now.time_since_epoch().count(),
+						std::memory_order_relaxed );
+				if( no_arrival == prev )
+					return false;
+
+				// NOTE: concurrent senders can store their timestamps in
+				// a different order. A negative interval is treated as zero.
+				interval = std::chrono::steady_clock::duration{
+						(std::max)( now.time_since_epoch().count() - prev,
+								timestamp_t{ 0 } ) };
+				return true;
+			}
+	};
+
+//
+// type_counters_t
+//
+/*!
+ * \brief Counters for a message type collected on a single thread.
+ *
+ * Counters are modified only by the owner thread, so they are updated
+ * by plain load/store pairs without read-modify-write operations.
+ * They are atomic only because they are read during the distribution
+ * of run-time stats.
+ *
+ * The timestamp of the last arrival is shared by all threads
+ * (see type_data_t).
+ *
+ * \since v.1.7.0
+ */
+struct type_counters_t
+	{
+		//! Data for the message type shared by all threads.
+		type_data_t & m_type_data;
+
+		//! Count of messages sent.
+		std::atomic< std::uint64_t > m_sends{};
+
+		//! Total size of messages sent.
+		std::atomic< std::uint64_t > m_bytes{};
+
+		//! Inter-arrival histogram.
+		std::array< std::atomic< std::uint64_t >, histogram_t::bucket_count >
+				m_interarrival{};
+
+		explicit type_counters_t( type_data_t & type_data ) noexcept
+			:	m_type_data{ type_data }
+			{}
+
+		//! Increment a counter. Must be called by the owner thread only.
+		static void
+		increment(
+			std::atomic< std::uint64_t > & counter,
+			std::uint64_t delta ) noexcept
+			{
+				counter.store(
+						counter.load( std::memory_order_relaxed ) + delta,
+						std::memory_order_relaxed );
+			}
+
+		//! Register a message. Must be called by the owner thread only.
+		void
+		on_message(
+			std::chrono::steady_clock::time_point now,
+			std::size_t size ) noexcept
+			{
+				increment( m_sends, 1u );
+				increment( m_bytes, size );
+
+				std::chrono::steady_clock::duration interval;
+				if( m_type_data.on_arrival( now, interval ) )
+					increment(
+							m_interarrival[ histogram_t::bucket_index( interval ) ],
+							1u );
+			}
+
+		//! Add the current values to the totals.
+		void
+		add_to( type_totals_t & totals ) const noexcept
+			{
+				totals.m_sends += m_sends.load( std::memory_order_relaxed );
+				totals.m_bytes += m_bytes.load( std::memory_order_relaxed );
+				for( std::size_t i = 0u; i != histogram_t::bucket_count; ++i )
+					totals.m_interarrival[ i ] +=
+							m_interarrival[ i ].load( std::memory_order_relaxed );
+			}
+	};
+
+//
+// thread_block_t
+//
+/*!
+ * \brief A block of counters that are updated by a single thread.
+ *
+ * The owner thread looks up its counters without the lock: nobody
+ * else modifies the map. The lock is taken by the owner thread only
+ * when a counters object for a new message type is added, and by
+ * the distribution of run-time stats when the map is read.
+ *
+ * \since v.1.7.0
+ */
+struct thread_block_t
+	{
+		//! Lock for the structure of the map.
+		std::mutex m_lock;
+
+		//! Counters for every message type seen by the owner thread.
+		std::unordered_map< std::type_index, type_counters_t > m_counters;
+	};
+
+//
+// collector_data_t
+//
+/*!
+ * \brief Data of a metrics collector shared with thread-local caches.
+ *
+ * A thread block is removed when the owner thread drops it from its
+ * thread-local cache (for example, when the thread finishes). The values
+ * of counters from the removed block are added to the retired totals of
+ * message types.
+ *
+ * Thread-local caches hold shared_ptr to that object, so it can outlive
+ * the collector.
+ *
+ * \since v.1.7.0
+ */
+class collector_data_t
+	{
+		//! Lock for the registries below.
+		std::mutex m_lock;
+
+		//! Blocks of threads those send messages.
+		std::unordered_map< thread_block_t *, std::unique_ptr< thread_block_t > >
+				m_blocks;
+
+		//! Data for every message type seen.
+		std::unordered_map< std::type_index, type_data_t > m_types;
+
+	public:
+		//! Create a block for the current thread.
+		[[nodiscard]]
+		thread_block_t &
+		make_block()
+			{
+				auto block = std::make_unique< thread_block_t >();
+				auto * ptr = block.get();
+
+				std::lock_guard< std::mutex > lock{ m_lock };
+				m_blocks.emplace( ptr, std::move(block) );
+
+				return *ptr;
+			}
+
+		//! Find or create the data for a message type.
+		[[nodiscard]]
+		type_data_t &
+		type_data( const std::type_index & msg_type )
+			{
+				std::lock_guard< std::mutex > lock{ m_lock };
+				return m_types.try_emplace( msg_type ).first->second;
+			}
+
+		//! Remove the block and keep its values in the retired totals.
+		/*!
+		 * \note
+		 * Must be called by the owner thread of the block.
+		 */
+		void
+		retire( thread_block_t & block ) noexcept
+			{
+				// NOTE: the block can't be read by distribution of run-time
+				// stats while the lock is held.
+				std::lock_guard< std::mutex > lock{ m_lock };
+
+				for( const auto & item : block.m_counters )
+					item.second.add_to( item.second.m_type_data.m_retired );
+
+				m_blocks.erase( &block );
+			}
+
+		//! Collect the current values for all message types.
+		void
+		collect( std::unordered_map< std::type_index, type_totals_t > & totals )
+			{
+				std::lock_guard< std::mutex > lock{ m_lock };
+
+				for( const auto & [msg_type, data] : m_types )
+					totals.emplace( msg_type, data.m_retired );
+
+				for( const auto & item : m_blocks )
+					{
+						thread_block_t & block = *(item.second);
+
+						std::lock_guard< std::mutex > block_lock{ block.m_lock };
+						for( const auto & [msg_type, counters] : block.m_counters )
+							counters.add_to( totals[ msg_type ] );
+					}
+			}
+	};
+
+//
+// cached_block_t
+//
+/*!
+ * \brief An item of the thread-local cache of thread blocks.
+ *
+ * The thread block is retired when the item is destroyed.
+ *
+ * \since v.1.7.0
+ */
+class cached_block_t
+	{
+		//! Data of the collector the block belongs to.
+		std::shared_ptr< collector_data_t > m_data;
+
+		//! The block of the current thread.
+		thread_block_t * m_block;
+
+	public:
+		cached_block_t(
+			std::shared_ptr< collector_data_t > data,
+			thread_block_t & block ) noexcept
+			:	m_data{ std::move(data) }
+			,	m_block{ &block }
+			{}
+
+		cached_block_t( cached_block_t && other ) noexcept
+			:	m_data{ std::move(other.m_data) }
+			,	m_block{ std::exchange( other.m_block, nullptr ) }
+			{}
+
+		cached_block_t( const cached_block_t & ) = delete;
+		cached_block_t & operator=( const cached_block_t & ) = delete;
+		cached_block_t & operator=( cached_block_t && ) = delete;
+
+		~cached_block_t() noexcept
+			{
+				if( m_data )
+					m_data->retire( *m_block );
+			}
+
+		[[nodiscard]]
+		bool
+		belongs_to( const std::shared_ptr< collector_data_t > & data ) const noexcept
+			{
+				return m_data == data;
+			}
+
+		[[nodiscard]]
+		thread_block_t &
+		block() const noexcept { return *m_block; }
+	};
+
+//
+// type_name_for_prefix
+//
+/*!
+ * \brief Get a human-readable name of a message type.
+ *
+ * The name from std::type_index::name() is demangled if the compiler
+ * provides mangled names.
+ *
+ * \since v.1.7.0
+ */
+[[nodiscard]]
+inline std::string
+type_name_for_prefix( const std::type_index & msg_type )
+	{
+#if defined(__GNUC__)
+		int status = 0;
+		std::unique_ptr< char, void(*)(void*) > demangled{
+				abi::__cxa_demangle( msg_type.name(), nullptr, nullptr, &status ),
+				&std::free
+			};
+		if( 0 == status && demangled )
+			return std::string{ demangled.get() };
+#endif
+		return std::string{ msg_type.name() };
+	}
+
+//
+// thread_local_cache_t
+//
+/*!
+ * \brief Type of thread-local cache of thread blocks.
+ *
+ * Every item holds the data of a collector, so a stale item can't be
+ * matched with a new collector.
+ *
+ * \since v.1.7.0
+ */
+using thread_local_cache_t = std::vector< cached_block_t >;
+
+//
+// thread_local_cache
+//
+/*!
+ * \brief Access to the thread-local cache of thread blocks.
+ *
+ * \since v.1.7.0
+ */
+[[nodiscard]]
+inline thread_local_cache_t &
+thread_local_cache() noexcept
+	{
+		thread_local thread_local_cache_t cache;
+		return cache;
+	}
+
+//
+// metrics_collector_t
+//
+/*!
+ * \brief Storage for all counters of a metrics proxy mbox and a data
+ * source for run-time monitoring.
+ *
+ * Counters are collected into per-thread blocks and are aggregated
+ * only in distribute() method.
+ *
+ * \since v.1.7.0
+ */
+class metrics_collector_t final : public ::so_5::stats::source_t
+	{
+		//! Max size of the thread-local cache.
+		/*!
+		 * The cache is cleaned if this size is reached. The stale entries
+		 * are thrown out this way.
+		 */
+		static constexpr std::size_t max_cache_size = 64u;
+
+		//! Data shared with thread-local caches.
+		const std::shared_ptr< collector_data_t > m_data;
+
+		//! Basic name for data source prefixes.
+		const std::string m_base_name;
+
+		//! Optional size hook.
+		const size_hook_t m_size_hook;
+
+		//! Names of message types for data source prefixes.
+		/*!
+		 * It's accessed only in distribute() method.
+		 */
+		std::unordered_map< std::type_index, std::string > m_type_names;
+
+		//! Find or create the block for the current thread.
+		[[nodiscard]]
+		thread_block_t &
+		block_for_current_thread()
+			{
+				auto & cache = thread_local_cache();
+				for( const auto & item : cache )
+					if( item.belongs_to( m_data ) )
+						return item.block();
+
+				// NOTE: the blocks from the cleared cache are retired.
+				if( max_cache_size <= cache.size() )
+					cache.clear();
+				// The place for the new item has to be reserved before
+				// the creation of the block.
+				cache.reserve( cache.size() + 1u );
+
+				return cache.emplace_back( m_data, m_data->make_block() ).block();
+			}
+
+		//! Find or create counters for a message type in the block
+		//! of the current thread.
+		[[nodiscard]]
+		type_counters_t &
+		counters_for(
+			thread_block_t & block,
+			const std::type_index & msg_type )
+			{
+				// The map is modified only by the current thread, so it
+				// can be read without the lock.
+				auto it = block.m_counters.find( msg_type );
+				if( it != block.m_counters.end() )
+					return it->second;
+
+				type_data_t & type_data = m_data->type_data( msg_type );
+
+				std::lock_guard< std::mutex > lock{ block.m_lock };
+				return block.m_counters.try_emplace( msg_type, type_data )
+						.first->second;
+			}
+
+		//! Get the prefix for a message type.
+		[[nodiscard]]
+		::so_5::stats::prefix_t
+		prefix_for( const std::type_index & msg_type )
+			{
+				auto it = m_type_names.find( msg_type );
+				if( it == m_type_names.end() )
+					it = m_type_names.emplace(
+							msg_type,
+							m_base_name + "/" + type_name_for_prefix( msg_type ) ).first;
+
+				// NOTE: the prefix will be truncated if the type name
+				// is too long.
+				return ::so_5::stats::prefix_t{ it->second };
+			}
+
+	public:
+		metrics_collector_t(
+			std::string_view base_name,
+			size_hook_t size_hook )
+			:	m_data{ std::make_shared< collector_data_t >() }
+			,	m_base_name{ base_name }
+			,	m_size_hook{ std::move(size_hook) }
+			{}
+
+		//! Register a send of a message.
+		void
+		on_message(
+			const std::type_index & msg_type,
+			const ::so_5::message_ref_t & message )
+			{
+				const auto now = std::chrono::steady_clock::now();
+				const std::size_t size =
+						m_size_hook ? m_size_hook( msg_type, message ) : 0u;
+
+				counters_for( block_for_current_thread(), msg_type )
+						.on_message( now, size );
+			}
+
+		void
+		distribute( const ::so_5::mbox_t & mbox ) override
+			{
+				std::unordered_map< std::type_index, type_totals_t > totals;
+				m_data->collect( totals );
+
+				for( const auto & [msg_type, counters] : totals )
+					{
+						const ::so_5::stats::prefix_t prefix = prefix_for( msg_type );
+
+						::so_5::send< ::so_5::stats::messages::quantity< std::size_t > >(
+								mbox,
+								prefix,
+								suffixes::sends(),
+								static_cast< std::size_t >( counters.m_sends ) );
+
+						if( m_size_hook )
+							::so_5::send< ::so_5::stats::messages::quantity< std::size_t > >(
+									mbox,
+									prefix,
+									suffixes::bytes(),
+									static_cast< std::size_t >( counters.m_bytes ) );
+
+						for( std::size_t i = 0u; i != histogram_t::bucket_count; ++i )
+							::so_5::send< ::so_5::stats::messages::quantity< std::size_t > >(
+									mbox,
+									prefix,
+									histogram_t::bucket_suffix( i ),
+									static_cast< std::size_t >(
+											counters.m_interarrival[ i ] ) );
+					}
+			}
+	};
+
+//
+// actual_mbox_t
+//
+/*!
+ * \brief Actual implementation of metrics proxy mbox.
+ *
+ * \since v.1.7.0
+ */
+class actual_mbox_t final : public ::so_5::extra::mboxes::proxy::simple_t
+	{
+		using base_type = ::so_5::extra::mboxes::proxy::simple_t;
+
+		//! Collector of metrics registered in the stats repository.
+		::so_5::stats::auto_registered_source_holder_t< metrics_collector_t >
+				m_collector;
+
+	public:
+		actual_mbox_t(
+			::so_5::mbox_t dest,
+			std::string_view data_source_name,
+			size_hook_t size_hook )
+			:	base_type{ std::move(dest) }
+			,	m_collector{
+					::so_5::outliving_mutable(
+							underlying_mbox().environment().stats_repository() ),
+					data_source_name,
+					std::move(size_hook)
+				}
+			{}
+
+		void
+		do_deliver_message(
+			::so_5::message_delivery_mode_t delivery_mode,
+			const std::type_index & msg_type,
+			const ::so_5::message_ref_t & message,
+			unsigned int redirection_deep ) override
+			{
+				m_collector.get().on_message( msg_type, message );
+
+				base_type::do_deliver_message(
+						delivery_mode,
+						msg_type,
+						message,
+						redirection_deep );
+			}
+	};
+
+} /* namespace impl */
+
+//
+// make_mbox
+//
+/*!
+ * \brief Create an instance of metrics proxy mbox.
+ *
+ * \throw so_5::exception_t if \a dest is nullptr.
+ *
+ * The new mbox delegates all actions to \a dest mbox. But for every
+ * message sent it collects:
+ *
+ * - the count of messages of that type (suffix "/msg.sends");
+ * - the total size of messages of that type (suffix "/msg.bytes"), only if
+ *   \a size_hook is specified;
+ * - the histogram of intervals between subsequent messages of that type
+ *   (suffixes "/interarrival.le_<N>us" and "/interarrival.inf").
+ *
+ * Counters are updated in per-thread blocks and are aggregated only when
+ * run-time stats are distributed. Intervals are measured between subsequent
+ * messages of a type sent to the mbox, regardless of the sending thread.
+ * All values are published via the stats repository of SObjectizer
+ * Environment with the prefix `<data_source_name>/<type_name>`.
+ *
+ * Usage example:
+ * \code
+ * namespace metrics_ns = so_5::extra::mboxes::metrics_proxy;
+ *
+ * auto mbox = metrics_ns::make_mbox(
+ * 		env.create_mbox(),
+ * 		"orders",
+ * 		[]( const std::type_index &, const so_5::message_ref_t & msg ) {
+ * 			return msg ? sizeof(order) : 0u;
+ * 		} );
+ *
+ * env.stats_controller().turn_on();
+ * \endcode
+ *
+ * \note
+ * The type name is obtained via std::type_index::name() and is demangled
+ * on GCC and Clang. The prefix will be truncated if the name is too long
+ * for so_5::stats::prefix_t.
+ *
+ * \since v.1.7.0
+ */
+[[nodiscard]]
+inline ::so_5::mbox_t
+make_mbox(
+	//! Destination mbox for all messages. Must not be nullptr.
+	::so_5::mbox_t dest,
+	//! Name to be used as the basic prefix for data sources.
+	std::string_view data_source_name,
+	//! Optional hook for detection of message sizes.
+	size_hook_t size_hook = size_hook_t{} )
+	{
+		// NOTE: a check for nullptr will be performed by proxy::simple_t.
+		return ::so_5::mbox_t{ new impl::actual_mbox_t{
+				std::move(dest),
+				data_source_name,
+				std::move(size_hook) } };
+	}
+
+} /* namespace metrics_proxy */
+
+} /* namespace mboxes */
+
+} /* namespace extra */
+
+} /* namespace so_5 */
@@ -0,0 +1,629 @@
+/*!
+ * \file
+ * \brief Implementation of proxy mbox that traces a sample of deliveries.
+ *
+ * \since v.1.7.0
+ */
+
+#pragma once
+
+#include <so_5_extra/mboxes/proxy.hpp>
+
+#include <so_5_extra/error_ranges.hpp>
+
+#include <so_5/exception.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <typeindex>
+#include <type_traits>
+#include <typeinfo>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace so_5 {
+
+namespace extra {
+
+namespace mboxes {
+
+namespace sampling_tracer {
+
+namespace errors {
+
+/*!
+ * \brief The capacity of a ring buffer isn't a power of two.
+ *
+ * \since v.1.7.0
+ */
+const int rc_invalid_ring_capacity =
+		::so_5::extra::errors::mboxes_sampling_tracer_errors + 1;
+
+/*!
+ * \brief nullptr is passed as a trace buffer.
+ *
+ * \since v.1.7.0
+ */
+const int rc_nullptr_as_trace_buffer =
+		::so_5::extra::errors::mboxes_sampling_tracer_errors + 2;
+
+} /* namespace errors */
+
+//
+// trace_record_t
+//
+/*!
+ * \brief Description of a single traced delivery.
+ *
+ * \since v.1.7.0
+ */
+struct trace_record_t
+	{
+		//! Time of the delivery.
+		std::chrono::steady_clock::time_point m_timestamp;
+
+		//! ID of the thread the delivery was initiated on.
+		std::thread::id m_thread_id;
+
+		//! Type of the message.
+		std::type_index m_msg_type;
+
+		//! ID of the mbox the message was sent to.
+		::so_5::mbox_id_t m_mbox_id;
+
+		//! Delivery mode for the message.
+		::so_5::message_delivery_mode_t m_delivery_mode;
+
+		//! Redirection deep for the delivery.
+		unsigned int m_redirection_deep;
+	};
+
+namespace impl {
+
+//
+// ring_slot_t
+//
+/*!
+ * \brief A single slot in a per-thread ring buffer.
+ *
+ * The slot is protected by a sequence counter: the writer makes the
+ * counter odd before the update and even after it. A reader accepts the
+ * content only if it sees the same even value before and after the read.
+ *
+ * All fields are atomics to make concurrent reads well-defined. Only
+ * relaxed operations are used for them.
+ *
+ * \since v.1.7.0
+ */
+struct ring_slot_t
+	{
+		static_assert( std::is_trivially_copyable_v< std::type_index >,
+				"std::type_index is expected to be trivially copyable" );
+
+		std::atomic< std::uint64_t > m_sequence{ 0u };
+
+		std::atomic< std::chrono::steady_clock::rep > m_timestamp{ 0 };
+		std::atomic< std::type_index > m_msg_type{ std::type_index{ typeid(void) } };
+		std::atomic< ::so_5::mbox_id_t > m_mbox_id{ 0u };
+		std::atomic< ::so_5::message_delivery_mode_t > m_delivery_mode{
+				::so_5::message_delivery_mode_t::ordinary };
+		std::atomic< unsigned int > m_redirection_deep{ 0u };
+	};
+
+//
+// thread_ring_t
+//
+/*!
+ * \brief A ring buffer that is written by just one thread.
+ *
+ * The writer never waits for readers. If the ring is full then the
+ * oldest records are overwritten.
+ *
+ * \since v.1.7.0
+ */
+class thread_ring_t
+	{
+		//! ID of the owner thread.
+		const std::thread::id m_thread_id;
+
+		//! Mask for index calculation.
+		const std::size_t m_mask;
+
+		//! Slots of the ring.
+		std::unique_ptr< ring_slot_t[] > m_slots;
+
+		//! Position for the next record.
+		/*!
+		 * Is modified only by the owner thread.
+		 */
+		std::size_t m_position{ 0u };
+
+		//! Countdown for 1-in-N sampling.
+		/*!
+		 * Is used only by the owner thread.
+		 */
+		std::size_t m_countdown{ 0u };
+
+	public:
+		thread_ring_t( std::size_t capacity )
+			:	m_thread_id{ std::this_thread::get_id() }
+			,	m_mask{ capacity - 1u }
+			,	m_slots{ std::make_unique< ring_slot_t[] >( capacity ) }
+			{}
+
+		//! Should the next delivery be sampled?
+		/*!
+		 * \note
+		 * Must be called only by the owner thread.
+		 */
+		[[nodiscard]]
+		bool
+		next_is_sampled( std::size_t every_nth ) noexcept
+			{
+				if( 0u == m_countdown )
+					m_countdown = every_nth;
+				--m_countdown;
+				return 0u == m_countdown;
+			}
+
+		//! Store a new record.
+		/*!
+		 * \note
+		 * Must be called only by the owner thread.
+		 */
+		void
+		write(
+			std::chrono::steady_clock::time_point timestamp,
+			const std::type_index & msg_type,
+			::so_5::mbox_id_t mbox_id,
+			::so_5::message_delivery_mode_t delivery_mode,
+			unsigned int redirection_deep ) noexcept
+			{
+				auto & slot = m_slots[ m_position & m_mask ];
+				++m_position;
+
+				const auto seq = slot.m_sequence.load( std::memory_order_relaxed );
+				slot.m_sequence.store( seq + 1u, std::memory_order_relaxed );
+				std::atomic_thread_fence( std::memory_order_release );
+
+				slot.m_timestamp.store(
+						timestamp.time_since_epoch().count(),
+						std::memory_order_relaxed );
+				slot.m_msg_type.store( msg_type, std::memory_order_relaxed );
+				slot.m_mbox_id.store( mbox_id, std::memory_order_relaxed );
+				slot.m_delivery_mode.store(
+						delivery_mode, std::memory_order_relaxed );
+				slot.m_redirection_deep.store(
+						redirection_deep, std::memory_order_relaxed );
+
+				slot.m_sequence.store( seq + 2u, std::memory_order_release );
+			}
+
+		//! Copy all consistent records into \a to.
+		/*!
+		 * Can be called from any thread. Slots that are being modified
+		 * at the moment are skipped.
+		 */
+		void
+		read_to( std::vector< trace_record_t > & to ) const
+			{
+				for( std::size_t i = 0u; i <= m_mask; ++i )
+					{
+						const auto & slot = m_slots[ i ];
+
+						const auto seq_before =
+								slot.m_sequence.load( std::memory_order_acquire );
+						if( 0u == seq_before || 0u != (seq_before & 1u) )
+							continue;
+
+						const auto timestamp =
+								slot.m_timestamp.load( std::memory_order_relaxed );
+						const auto msg_type =
+								slot.m_msg_type.load( std::memory_order_relaxed );
+						const auto mbox_id =
+								slot.m_mbox_id.load( std::memory_order_relaxed );
+						const auto delivery_mode =
+								slot.m_delivery_mode.load( std::memory_order_relaxed );
+						const auto redirection_deep =
+								slot.m_redirection_deep.load( std::memory_order_relaxed );
+
+						std::atomic_thread_fence( std::memory_order_acquire );
+						if( seq_before != slot.m_sequence.load(
+								std::memory_order_relaxed ) )
+							continue;
+
+						to.push_back( trace_record_t{
+								std::chrono::steady_clock::time_point{
+										std::chrono::steady_clock::duration{ timestamp } },
+								m_thread_id,
+								msg_type,
+								mbox_id,
+								delivery_mode,
+								redirection_deep
+							} );
+					}
+			}
+	};
+
+} /* namespace impl */
+
+//
+// trace_buffer_t
+//
+/*!
+ * \brief Storage for traced deliveries.
+ *
+ * Every thread that initiates a sampled delivery gets its own ring
+ * buffer. Writes to that ring require no locks and no atomic RMW
+ * operations, so the overhead of tracing is low.
+ *
+ * The content of all rings can be obtained via dump() at any time.
+ *
+ * A trace buffer can be shared between several sampling mboxes.
+ *
+ * \since v.1.7.0
+ */
+class trace_buffer_t
+	{
+		//! Max size of the thread-local cache.
+		static constexpr std::size_t max_cache_size = 64u;
+
+		//! Unique ID of the buffer.
+		const std::uint64_t m_id;
+
+		//! Capacity of every ring.
+		const std::size_t m_ring_capacity;
+
+		//! Lock for the list of rings.
+		mutable std::mutex m_lock;
+
+		//! Rings for every thread.
+		/*!
+		 * Rings are never removed while the buffer exists.
+		 */
+		std::unordered_map<
+						std::thread::id,
+						std::unique_ptr< impl::thread_ring_t > >
+				m_rings;
+
+		[[nodiscard]]
+		static std::uint64_t
+		next_id() noexcept
+			{
+				static std::atomic< std::uint64_t > counter{ 0u };
+				return ++counter;
+			}
+
+		[[nodiscard]]
+		static std::size_t
+		ensure_valid_capacity( std::size_t capacity )
+			{
+				if( 0u == capacity || 0u != (capacity & (capacity - 1u)) )
+					SO_5_THROW_EXCEPTION(
+							errors::rc_invalid_ring_capacity,
+							"the capacity of a ring should be a power of two, "
+							"capacity: " + std::to_string( capacity ) );
+
+				return capacity;
+			}
+
+	public:
+		//! Initializing constructor.
+		/*!
+		 * \throw so_5::exception_t if \a ring_capacity isn't a power of two.
+		 */
+		trace_buffer_t( std::size_t ring_capacity )
+			:	m_id{ next_id() }
+			,	m_ring_capacity{ ensure_valid_capacity( ring_capacity ) }
+			{}
+
+		trace_buffer_t( const trace_buffer_t & ) = delete;
+		trace_buffer_t & operator=( const trace_buffer_t & ) = delete;
+
+		//! Get the ring for the current thread.
+		/*!
+		 * \note
+		 * This method is intended to be used by sampling mboxes.
+		 */
+		[[nodiscard]]
+		impl::thread_ring_t &
+		ring_for_current_thread()
+			{
+				using cache_t = std::vector<
+						std::pair< std::uint64_t, impl::thread_ring_t * > >;
+				thread_local cache_t cache;
+
+				for( const auto & item : cache )
+					if( m_id == item.first )
+						return *(item.second);
+
+				impl::thread_ring_t * ring;
+				{
+					std::lock_guard< std::mutex > lock{ m_lock };
+					auto & holder = m_rings[ std::this_thread::get_id() ];
+					if( !holder )
+						holder = std::make_unique< impl::thread_ring_t >(
+								m_ring_capacity );
+					ring = holder.get();
+				}
+
+				// Stale items for destroyed buffers are thrown out this way.
+				if( max_cache_size <= cache.size() )
+					cache.clear();
+				cache.emplace_back( m_id, ring );
+
+				return *ring;
+			}
+
+		//! Get all consistent records from all rings.
+		/*!
+		 * Records are ordered by timestamps.
+		 *
+		 * This method can be called at any time from any thread.
+		 * Records that are being written at the moment of the call
+		 * are skipped.
+		 */
+		[[nodiscard]]
+		std::vector< trace_record_t >
+		dump() const
+			{
+				std::vector< trace_record_t > result;
+
+				{
+					std::lock_guard< std::mutex > lock{ m_lock };
+					for( const auto & item : m_rings )
+						item.second->read_to( result );
+				}
+
+				std::stable_sort( result.begin(), result.end(),
+						[]( const auto & a, const auto & b ) {
+							return a.m_timestamp < b.m_timestamp;
+						} );
+
+				return result;
+			}
+	};
+
+//
+// trace_buffer_shptr_t
+//
+/*!
+ * \brief Type of shared pointer to trace buffer.
+ *
+ * \since v.1.7.0
+ */
+using trace_buffer_shptr_t = std::shared_ptr< trace_buffer_t >;
+
+//
+// make_trace_buffer
+//
+/*!
+ * \brief Create a new trace buffer.
+ *
+ * \throw so_5::exception_t if \a ring_capacity isn't a power of two.
+ *
+ * \since v.1.7.0
+ */
+[[nodiscard]]
+inline trace_buffer_shptr_t
+make_trace_buffer(
+	//! Capacity of ring for every thread. Should be a power of two.
+	std::size_t ring_capacity )
+	{
+		return std::make_shared< trace_buffer_t >( ring_capacity );
+	}
+
+//
+// sampling_params_t
+//
+/*!
+ * \brief Parameters that specify which deliveries should be traced.
+ *
+ * A delivery is traced if the type of the message is in the list of
+ * always traced types, or if it is every N-th delivery on the current
+ * thread.
+ *
+ * Usage example:
+ * \code
+ * namespace tracer_ns = so_5::extra::mboxes::sampling_tracer;
+ *
+ * tracer_ns::sampling_params_t params;
+ * params.every_nth( 1000 )
+ * 	.always_trace< msg_cancel >()
+ * 	.always_trace< so_5::mutable_msg< msg_config > >();
+ * \endcode
+ *
+ * \since v.1.7.0
+ */
+class sampling_params_t
+	{
+		//! Value for 1-in-N sampling.
+		/*!
+		 * Value 0 means that sampling is turned off.
+		 */
+		std::size_t m_every_nth{ 0u };
+
+		//! Types to be traced always.
+		std::vector< std::type_index > m_always_traced;
+
+	public:
+		//! Trace every N-th delivery.
+		/*!
+		 * Value 0 turns sampling off.
+		 *
+		 * \note
+		 * Deliveries are counted separately for every thread.
+		 */
+		sampling_params_t &
+		every_nth( std::size_t v ) noexcept
+			{
+				m_every_nth = v;
+				return *this;
+			}
+
+		//! Trace every delivery of message of type \a Msg.
+		template< typename Msg >
+		sampling_params_t &
+		always_trace()
+			{
+				m_always_traced.push_back(
+						::so_5::message_payload_type< Msg >::subscription_type_index() );
+				return *this;
+			}
+
+		//! Should a delivery of the message type be traced always?
+		[[nodiscard]]
+		bool
+		is_always_traced( const std::type_index & msg_type ) const noexcept
+			{
+				return m_always_traced.end() != std::find(
+						m_always_traced.begin(), m_always_traced.end(), msg_type );
+			}
+
+		[[nodiscard]]
+		std::size_t
+		every_nth() const noexcept { return m_every_nth; }
+	};
+
+namespace impl {
+
+//
+// actual_mbox_t
+//
+/*!
+ * \brief Actual implementation of sampling tracer mbox.
+ *
+ * \since v.1.7.0
+ */
+class actual_mbox_t final : public ::so_5::extra::mboxes::proxy::simple_t
+	{
+		using base_type = ::so_5::extra::mboxes::proxy::simple_t;
+
+		//! Storage for traces.
+		const trace_buffer_shptr_t m_buffer;
+
+		//! Parameters of sampling.
+		const sampling_params_t m_params;
+
+		[[nodiscard]]
+		static trace_buffer_shptr_t
+		ensure_not_null( trace_buffer_shptr_t buffer )
+			{
+				if( !buffer )
+					SO_5_THROW_EXCEPTION(
+							errors::rc_nullptr_as_trace_buffer,
+							"nullptr is used as trace buffer" );
+
+				return buffer;
+			}
+
+	public:
+		actual_mbox_t(
+			::so_5::mbox_t dest,
+			trace_buffer_shptr_t buffer,
+			sampling_params_t params )
+			:	base_type{ std::move(dest) }
+			,	m_buffer{ ensure_not_null( std::move(buffer) ) }
+			,	m_params{ std::move(params) }
+			{}
+
+		void
+		do_deliver_message(
+			::so_5::message_delivery_mode_t delivery_mode,
+			const std::type_index & msg_type,
+			const ::so_5::message_ref_t & message,
+			unsigned int redirection_deep ) override
+			{
+				if( m_params.is_always_traced( msg_type ) )
+					m_buffer->ring_for_current_thread().write(
+							std::chrono::steady_clock::now(),
+							msg_type,
+							this->id(),
+							delivery_mode,
+							redirection_deep );
+				else if( 0u != m_params.every_nth() )
+					{
+						auto & ring = m_buffer->ring_for_current_thread();
+						if( ring.next_is_sampled( m_params.every_nth() ) )
+							ring.write(
+									std::chrono::steady_clock::now(),
+									msg_type,
+									this->id(),
+									delivery_mode,
+									redirection_deep );
+					}
+
+				base_type::do_deliver_message(
+						delivery_mode,
+						msg_type,
+						message,
+						redirection_deep );
+			}
+	};
+
+} /* namespace impl */
+
+//
+// make_mbox
+//
+/*!
+ * \brief Create an instance of sampling tracer mbox.
+ *
+ * The new mbox delegates all actions to \a dest mbox. But some of
+ * deliveries are stored into \a buffer before the actual delivery.
+ * Deliveries to be stored are selected by \a params.
+ *
+ * It allows to have always-on tracing of deliveries with low overhead
+ * (in contrast with msg_tracing that is either fully on or fully off
+ * for the whole SObjectizer Environment).
+ *
+ * Usage example:
+ * \code
+ * namespace tracer_ns = so_5::extra::mboxes::sampling_tracer;
+ *
+ * auto buffer = tracer_ns::make_trace_buffer( 1024u );
+ * auto mbox = tracer_ns::make_mbox(
+ * 		env.create_mbox(),
+ * 		buffer,
+ * 		tracer_ns::sampling_params_t{}
+ * 			.every_nth( 1000u )
+ * 			.always_trace< msg_cancel >() );
+ * ...
+ * // Somewhere later, for example on an admin request.
+ * for( const auto & r : buffer->dump() )
+ * 	std::cout << r.m_msg_type.name() << std::endl;
+ * \endcode
+ *
+ * \throw so_5::exception_t if \a dest or \a buffer is nullptr.
+ *
+ * \since v.1.7.0
+ */
+[[nodiscard]]
+inline ::so_5::mbox_t
+make_mbox(
+	//! Destination mbox for all messages. Must not be nullptr.
+	::so_5::mbox_t dest,
+	//! Storage for traces. Must not be nullptr.
+	trace_buffer_shptr_t buffer,
+	//! Parameters of sampling.
+	sampling_params_t params )
+	{
+		return ::so_5::mbox_t{ new impl::actual_mbox_t{
+				std::move(dest),
+				std::move(buffer),
+				std::move(params) } };
+	}
+
+} /* namespace sampling_tracer */
+
+} /* namespace mboxes */
+
+} /* namespace extra */
+
+} /* namespace so_5 */
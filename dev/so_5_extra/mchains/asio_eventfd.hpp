@@ -0,0 +1,525 @@
+/*!
+ * \file
+ * \brief Implementation of mchain that can be waited on from Asio's
+ * io_context via eventfd.
+ *
+ * \note
+ * This module is available on Linux only.
+ *
+ * \since
+ * v.1.7.0
+ */
+
+#pragma once
+
+#if !defined(__linux__)
+	#error "so_5_extra/mchains/asio_eventfd.hpp can be used on Linux only"
+#endif
+
+#include <so_5_extra/error_ranges.hpp>
+
+#include <so_5/mchain.hpp>
+#include <so_5/environment.hpp>
+#include <so_5/exception.hpp>
+
+#include <asio/io_context.hpp>
+#include <asio/post.hpp>
+#include <asio/posix/stream_descriptor.hpp>
+
+#include <sys/eventfd.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <tuple>
+#include <utility>
+
+namespace so_5
+{
+
+namespace extra
+{
+
+namespace mchains
+{
+
+namespace asio_eventfd
+{
+
+namespace errors
+{
+
+/*!
+ * \brief Creation of eventfd failed.
+ *
+ * \since
+ * v.1.7.0
+ */
+const int rc_eventfd_creation_failed =
+		so_5::extra::errors::mchains_asio_eventfd_errors + 1;
+
+/*!
+ * \brief Duplication of eventfd descriptor failed.
+ *
+ * \since
+ * v.1.7.0
+ */
+const int rc_eventfd_dup_failed =
+		so_5::extra::errors::mchains_asio_eventfd_errors + 2;
+
+} /* namespace errors */
+
+namespace details
+{
+
+//
+// eventfd_holder_t
+//
+/*!
+ * \brief Owner of eventfd descriptor.
+ *
+ * It is shared between the mchain's not-empty notificator and
+ * the channel. So the descriptor is closed only when both of them
+ * are destroyed.
+ *
+ * \since
+ * v.1.7.0
+ */
+class eventfd_holder_t
+	{
+		//! The descriptor.
+		const int m_fd;
+
+		[[nodiscard]] static int
+		make_eventfd()
+			{
+				const int fd = ::eventfd( 0u, EFD_NONBLOCK | EFD_CLOEXEC );
+				if( -1 == fd )
+					SO_5_THROW_EXCEPTION(
+							errors::rc_eventfd_creation_failed,
+							std::string{ "eventfd failed: " }
+									+ std::strerror( errno ) );
+
+				return fd;
+			}
+
+	public :
+		eventfd_holder_t()
+			:	m_fd{ make_eventfd() }
+			{}
+
+		eventfd_holder_t( const eventfd_holder_t & ) = delete;
+		eventfd_holder_t & operator=( const eventfd_holder_t & ) = delete;
+
+		~eventfd_holder_t() noexcept
+			{
+				::close( m_fd );
+			}
+
+		//! Make a copy of the descriptor.
+		/*!
+		 * The copy is owned by the caller.
+		 */
+		[[nodiscard]] int
+		dup() const
+			{
+				const int fd = ::fcntl( m_fd, F_DUPFD_CLOEXEC, 0 );
+				if( -1 == fd )
+					SO_5_THROW_EXCEPTION(
+							errors::rc_eventfd_dup_failed,
+							std::string{ "dup of eventfd failed: " }
+									+ std::strerror( errno ) );
+
+				return fd;
+			}
+
+		//! Make the descriptor readable.
+		void
+		notify() const noexcept
+			{
+				const std::uint64_t one = 1u;
+				// The only possible error is EAGAIN on counter overflow.
+				// The descriptor is readable in that case anyway.
+				[[maybe_unused]] const auto r = ::write( m_fd, &one, sizeof(one) );
+			}
+
+		//! Reset the counter of the descriptor.
+		void
+		reset() const noexcept
+			{
+				std::uint64_t value;
+				// EAGAIN is expected if the counter is already zero.
+				[[maybe_unused]] const auto r = ::read( m_fd, &value, sizeof(value) );
+			}
+	};
+
+//
+// fd_guard_t
+//
+/*!
+ * \brief Owner of a descriptor until it is passed to another owner.
+ *
+ * \since
+ * v.1.7.0
+ */
+class fd_guard_t
+	{
+		//! The descriptor (-1 if it is released).
+		int m_fd;
+
+	public :
+		explicit fd_guard_t( int fd ) noexcept
+			:	m_fd{ fd }
+			{}
+
+		fd_guard_t( const fd_guard_t & ) = delete;
+		fd_guard_t & operator=( const fd_guard_t & ) = delete;
+
+		~fd_guard_t() noexcept
+			{
+				if( -1 != m_fd )
+					::close( m_fd );
+			}
+
+		//! Get the descriptor.
+		[[nodiscard]] int
+		get() const noexcept { return m_fd; }
+
+		//! The descriptor won't be closed by the guard.
+		void
+		release() noexcept { m_fd = -1; }
+	};
+
+} /* namespace details */
+
+//
+// channel_t
+//
+/*!
+ * \brief A mchain with eventfd that becomes readable when the mchain
+ * becomes not empty.
+ *
+ * The eventfd is wrapped into asio::posix::stream_descriptor. Because of
+ * that an Asio handler or coroutine can wait for messages in the mchain
+ * on an io_context thread without a dedicated blocking thread.
+ *
+ * Usually an instance of channel_t is created by make_channel() and
+ * is used via start_draining(). But it can be used directly too:
+ * \code
+	void wait_next(so_5::extra::mchains::asio_eventfd::channel_shptr_t ch)
+	{
+		ch->async_wait([ch](const asio::error_code & ec) {
+			if(ec) return;
+			so_5::receive(
+					so_5::from(ch->chain()).handle_all().no_wait_on_empty(),
+					handlers...);
+			wait_next(ch);
+		});
+	}
+ * \endcode
+ *
+ * \attention
+ * The not-empty notification is issued only when the mchain turns from
+ * empty to not-empty state. It means that all messages should be
+ * extracted from the mchain before the next async_wait() call.
+ * Otherwise the completion handler won't be called until the mchain
+ * becomes empty and then not empty again.
+ *
+ * \since
+ * v.1.7.0
+ */
+class channel_t
+	{
+		//! The eventfd.
+		std::shared_ptr< details::eventfd_holder_t > m_eventfd;
+
+		//! The mchain.
+		so_5::mchain_t m_chain;
+
+		//! Asio's wrapper for a copy of eventfd descriptor.
+		::asio::posix::stream_descriptor m_descriptor;
+
+	public :
+		//! Type of factory for creation of the mchain.
+		using mchain_factory_t =
+				std::function< so_5::mchain_t( const so_5::mchain_params_t & ) >;
+
+		channel_t(
+			::asio::io_context & io_ctx,
+			so_5::mchain_params_t params,
+			const mchain_factory_t & factory )
+			:	m_eventfd{ std::make_shared< details::eventfd_holder_t >() }
+			,	m_chain{ factory( params.not_empty_notificator(
+						[eventfd = m_eventfd, old = params.not_empty_notificator()] {
+							eventfd->notify();
+							if( old )
+								old();
+						} ) ) }
+			,	m_descriptor{ io_ctx }
+			{
+				// The copy of the descriptor should be closed if
+				// stream_descriptor can't take the ownership.
+				details::fd_guard_t fd{ m_eventfd->dup() };
+				m_descriptor.assign( fd.get() );
+				fd.release();
+			}
+
+		channel_t( const channel_t & ) = delete;
+		channel_t & operator=( const channel_t & ) = delete;
+
+		//! Access to the mchain.
+		[[nodiscard]] const so_5::mchain_t &
+		chain() const noexcept { return m_chain; }
+
+		//! Get executor of the descriptor.
+		[[nodiscard]] auto
+		get_executor() noexcept { return m_descriptor.get_executor(); }
+
+		//! Wait until the mchain becomes not empty.
+		/*!
+		 * The \a handler is called on io_context's thread with
+		 * an instance of asio::error_code.
+		 */
+		template< typename Handler >
+		void
+		async_wait( Handler && handler )
+			{
+				m_descriptor.async_wait(
+						::asio::posix::stream_descriptor::wait_read,
+						[eventfd = m_eventfd, h = std::forward<Handler>(handler)](
+							const ::asio::error_code & ec ) mutable
+						{
+							if( !ec )
+								eventfd->reset();
+							h( ec );
+						} );
+			}
+
+		//! Cancel all pending wait operations.
+		void
+		cancel()
+			{
+				m_descriptor.cancel();
+			}
+
+		//! Close the mchain and wake up the waiting side.
+		/*!
+		 * Content of the mchain is retained, so it can be handled before
+		 * the detection of closed mchain.
+		 */
+		void
+		close() noexcept
+			{
+				so_5::close_retain_content( so_5::terminate_if_throws, m_chain );
+				m_eventfd->notify();
+			}
+	};
+
+//
+// channel_shptr_t
+//
+/*!
+ * \brief Type of shared pointer to channel.
+ *
+ * \since
+ * v.1.7.0
+ */
+using channel_shptr_t = std::shared_ptr< channel_t >;
+
+//
+// make_channel
+//
+/*!
+ * \brief Create a channel with mchain created by a user-supplied factory.
+ *
+ * The factory receives a copy of \a params with a not-empty notificator
+ * for eventfd. A not-empty notificator from \a params (if any) will be
+ * called too.
+ *
+ * Usage example:
+ * \code
+	auto ch = so_5::extra::mchains::asio_eventfd::make_channel(
+			io_ctx,
+			so_5::make_unlimited_mchain_params(),
+			[&env](const so_5::mchain_params_t & params) {
+				return so_5::extra::mchains::segmented::create_mchain<256>(env, params);
+			} );
+ * \endcode
+ *
+ * \since
+ * v.1.7.0
+ */
+[[nodiscard]] inline channel_shptr_t
+make_channel(
+	::asio::io_context & io_ctx,
+	so_5::mchain_params_t params,
+	const channel_t::mchain_factory_t & factory )
+	{
+		return std::make_shared< channel_t >( io_ctx, std::move(params), factory );
+	}
+
+//
+// make_channel
+//
+/*!
+ * \brief Create a channel with an ordinary mchain from SObjectizer.
+ *
+ * \since
+ * v.1.7.0
+ */
+[[nodiscard]] inline channel_shptr_t
+make_channel(
+	so_5::environment_t & env,
+	::asio::io_context & io_ctx,
+	so_5::mchain_params_t params )
+	{
+		return make_channel( io_ctx, std::move(params),
+				[&env]( const so_5::mchain_params_t & p ) {
+					return env.create_mchain( p );
+				} );
+	}
+
+namespace details
+{
+
+//
+// drainer_t
+//
+/*!
+ * \brief Implementation of draining of a channel on io_context.
+ *
+ * \since
+ * v.1.7.0
+ */
+template< typename... Handlers >
+class drainer_t
+	: public std::enable_shared_from_this< drainer_t< Handlers... > >
+	{
+		//! Channel to be drained.
+		const channel_shptr_t m_channel;
+
+		//! Max count of messages to be extracted at once.
+		const std::size_t m_batch_size;
+
+		//! Message handlers.
+		std::tuple< Handlers... > m_handlers;
+
+		void
+		wait()
+			{
+				m_channel->async_wait(
+						[self = this->shared_from_this()](
+							const ::asio::error_code & ec ) {
+							if( !ec )
+								self->drain();
+						} );
+			}
+
+		void
+		drain()
+			{
+				const auto r = std::apply(
+						[this]( auto &... handlers ) {
+							return so_5::receive(
+									so_5::from( m_channel->chain() )
+										.extract_n( m_batch_size )
+										.no_wait_on_empty(),
+									handlers... );
+						},
+						m_handlers );
+
+				if( so_5::mchain_props::extraction_status_t::chain_closed
+						== r.status() )
+					return;
+
+				if( 0u == r.extracted() )
+					// The mchain is empty, the next message will make
+					// the eventfd readable.
+					wait();
+				else
+					// There can be more messages in the mchain. The next batch
+					// will be handled after other handlers on io_context.
+					//
+					// NOTE: the mchain can be closed during the handling of
+					// the batch. The closed status will be detected by the
+					// next call to receive.
+					::asio::post( m_channel->get_executor(),
+							[self = this->shared_from_this()] { self->drain(); } );
+			}
+
+	public :
+		template< typename... Actual_Handlers >
+		drainer_t(
+			channel_shptr_t channel,
+			std::size_t batch_size,
+			Actual_Handlers &&... handlers )
+			:	m_channel{ std::move(channel) }
+			,	m_batch_size{ batch_size }
+			,	m_handlers{ std::forward< Actual_Handlers >( handlers )... }
+			{}
+
+		void
+		start()
+			{
+				// There can be messages in the mchain already.
+				::asio::post( m_channel->get_executor(),
+						[self = this->shared_from_this()] { self->drain(); } );
+			}
+	};
+
+} /* namespace details */
+
+//
+// start_draining
+//
+/*!
+ * \brief Start handling of messages from a channel on io_context.
+ *
+ * Messages are extracted and handled in batches of up to \a batch_size
+ * messages on the io_context's thread. The draining stops when the mchain
+ * is closed and all its content is handled (see channel_t::close()),
+ * or when io_context is stopped.
+ *
+ * Usage example:
+ * \code
+	asio::io_context io_ctx;
+	auto ch = so_5::extra::mchains::asio_eventfd::make_channel(
+			env, io_ctx, so_5::make_unlimited_mchain_params() );
+
+	so_5::extra::mchains::asio_eventfd::start_draining(
+			ch, 32u,
+			[](const market_data & md) {...},
+			[](so_5::mhood_t<heartbeat>) {...} );
+
+	io_ctx.run();
+ * \endcode
+ *
+ * \since
+ * v.1.7.0
+ */
+template< typename... Handlers >
+void
+start_draining(
+	channel_shptr_t channel,
+	std::size_t batch_size,
+	Handlers &&... handlers )
+	{
+		using drainer_type = details::drainer_t< std::decay_t< Handlers >... >;
+
+		std::make_shared< drainer_type >(
+				std::move(channel),
+				batch_size,
+				std::forward< Handlers >( handlers )... )->start();
+	}
+
+} /* namespace asio_eventfd */
+
+} /* namespace mchains */
+
+} /* namespace extra */
+
+} /* namespace so_5 */
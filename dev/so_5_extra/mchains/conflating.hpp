@@ -0,0 +1,412 @@
+/*!
+ * \file
+ * \brief Implementation of conflating mchain.
+ *
+ * \since
+ * v.1.7.0
+ */
+
+#pragma once
+
+#include <so_5_extra/error_ranges.hpp>
+
+#include <so_5/impl/mchain_details.hpp>
+#include <so_5/impl/make_mchain.hpp>
+#include <so_5/impl/internal_env_iface.hpp>
+
+#include <so_5/details/rollback_on_exception.hpp>
+
+#include <so_5/exception.hpp>
+
+#include <functional>
+#include <list>
+#include <optional>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+
+namespace so_5
+{
+
+namespace extra
+{
+
+namespace mchains
+{
+
+namespace conflating
+{
+
+namespace errors
+{
+
+/*!
+ * \brief An attempt to create a conflating mchain with limited capacity.
+ *
+ * \since
+ * v.1.7.0
+ */
+const int rc_limited_capacity_not_supported =
+		so_5::extra::errors::mchains_conflating_errors + 1;
+
+} /* namespace errors */
+
+//
+// by_type_t
+//
+/*!
+ * \brief Indicator that messages should be conflated by type only.
+ *
+ * \since
+ * v.1.7.0
+ */
+struct by_type_t {};
+
+//
+// by_key_t
+//
+/*!
+ * \brief Description of conflation by a key from a message of type Msg.
+ *
+ * Key_Extractor should be a default-constructible type with operator()
+ * that accepts a const reference to the payload of Msg and returns a key.
+ * The key should be copyable, equality comparable and hashable by
+ * std::hash.
+ *
+ * \attention
+ * An instance of Key_Extractor can't be passed to create_mchain().
+ * The queue of the mchain is created by SObjectizer with the capacity
+ * of the mchain only, so the queue default-constructs its own instance
+ * of Key_Extractor and uses it for all messages. The extractor can have
+ * a state (operator() can be non-const), but that state can't be
+ * initialized by the user. An extractor that needs external data should
+ * get it from a static or global object.
+ *
+ * Messages of other types are conflated by type only.
+ *
+ * \since
+ * v.1.7.0
+ */
+template< typename Msg, typename Key_Extractor >
+struct by_key_t {};
+
+namespace details
+{
+
+//
+// conflation_traits_t
+//
+/*!
+ * \brief Traits for a conflation policy.
+ *
+ * \since
+ * v.1.7.0
+ */
+template< typename Policy >
+struct conflation_traits_t
+	{
+		static_assert( !std::is_same_v< Policy, Policy >,
+				"by_type_t or by_key_t<Msg, Key_Extractor> is expected" );
+	};
+
+template<>
+struct conflation_traits_t< by_type_t >
+	{
+		//! Type of extractor of keys.
+		/*!
+		 * There is no need for an extractor for conflation by type.
+		 */
+		struct extractor_t {};
+
+		//! Type of key.
+		using key_t = std::type_index;
+
+		//! Type of hash for key.
+		using hash_t = std::hash< std::type_index >;
+
+		//! Get key for a demand.
+		/*!
+		 * \return empty value if the demand should not be conflated.
+		 */
+		[[nodiscard]] static std::optional< key_t >
+		key_of(
+			extractor_t & /*extractor*/,
+			const so_5::mchain_props::demand_t & demand )
+			{
+				if( demand.m_message_ref &&
+						message_t::kind_t::enveloped_msg ==
+								message_kind( demand.m_message_ref ) )
+					return std::nullopt;
+
+				return demand.m_msg_type;
+			}
+	};
+
+template< typename Msg, typename Key_Extractor >
+struct conflation_traits_t< by_key_t< Msg, Key_Extractor > >
+	{
+		//! Type of payload of the message.
+		using payload_type = typename message_payload_type< Msg >::payload_type;
+
+		static_assert( !is_signal< payload_type >::value,
+				"a key can't be extracted from a signal" );
+
+		//! Type of extractor of keys.
+		using extractor_t = Key_Extractor;
+
+		static_assert( std::is_default_constructible_v< extractor_t >,
+				"Key_Extractor should be default constructible" );
+
+		//! Type of user's key.
+		using user_key_t = std::decay_t<
+				std::invoke_result_t< extractor_t &, const payload_type & > >;
+
+		//! Type of key.
+		/*!
+		 * User's key is present only for messages of type Msg.
+		 */
+		using key_t = std::pair< std::type_index, std::optional< user_key_t > >;
+
+		//! Type of hash for key.
+		struct hash_t
+			{
+				[[nodiscard]] std::size_t
+				operator()( const key_t & k ) const
+					{
+						std::size_t h = std::hash< std::type_index >{}( k.first );
+						if( k.second )
+							h ^= std::hash< user_key_t >{}( *(k.second) )
+									+ 0x9e3779b9u + (h << 6) + (h >> 2);
+						return h;
+					}
+			};
+
+		//! Get key for a demand.
+		/*!
+		 * \return empty value if the demand should not be conflated.
+		 */
+		[[nodiscard]] static std::optional< key_t >
+		key_of(
+			extractor_t & extractor,
+			const so_5::mchain_props::demand_t & demand )
+			{
+				if( demand.m_message_ref &&
+						message_t::kind_t::enveloped_msg ==
+								message_kind( demand.m_message_ref ) )
+					return std::nullopt;
+
+				if( message_payload_type< Msg >::subscription_type_index()
+						!= demand.m_msg_type )
+					return key_t{ demand.m_msg_type, std::nullopt };
+
+				const payload_type & payload =
+						message_payload_type< Msg >::payload_reference(
+								*(demand.m_message_ref) );
+
+				return key_t{ demand.m_msg_type, extractor( payload ) };
+			}
+	};
+
+//
+// demand_queue_t
+//
+/*!
+ * \brief Implementation of demands queue that holds only the latest demand
+ * for every key.
+ *
+ * If a demand with the same key is already in the queue then it is
+ * replaced by the new one. The replaced demand keeps its place in the
+ * queue.
+ *
+ * The size of the queue is limited by the count of distinct keys. Because
+ * of that the queue is never full.
+ *
+ * \note
+ * Enveloped messages are never conflated.
+ *
+ * \since
+ * v.1.7.0
+ */
+template< typename Policy >
+class demand_queue_t
+	{
+		using traits_type = conflation_traits_t< Policy >;
+		using key_type = typename traits_type::key_t;
+
+		//! Type of item of the queue.
+		struct item_t
+			{
+				//! The key of the demand (if the demand can be conflated).
+				std::optional< key_type > m_key;
+
+				//! The demand itself.
+				so_5::mchain_props::demand_t m_demand;
+			};
+
+		using items_container_t = std::list< item_t >;
+
+	public :
+		// NOTE: constructor of this format is necessary
+		// because the standard implementation of mchain from SO-5
+		// requires it.
+		demand_queue_t( so_5::mchain_props::capacity_t /*capacity*/ ) {}
+
+		//! Is queue full?
+		/*!
+		 * \note
+		 * Always returns false: the size of the queue is limited by the
+		 * count of distinct keys.
+		 */
+		[[nodiscard]] bool
+		is_full() const { return false; }
+
+		//! Is queue empty?
+		[[nodiscard]] bool
+		is_empty() const { return m_items.empty(); }
+
+		//! Access to front item of the queue.
+		[[nodiscard]] so_5::mchain_props::demand_t &
+		front()
+			{
+				so_5::mchain_props::details::ensure_queue_not_empty( *this );
+				return m_items.front().m_demand;
+			}
+
+		//! Remove the front item from queue.
+		void
+		pop_front()
+			{
+				so_5::mchain_props::details::ensure_queue_not_empty( *this );
+				auto & item = m_items.front();
+				if( item.m_key )
+					m_index.erase( *(item.m_key) );
+				m_items.pop_front();
+			}
+
+		//! Add a new item to the end of the queue or replace an item with
+		//! the same key.
+		void
+		push_back( so_5::mchain_props::demand_t && demand )
+			{
+				auto key = traits_type::key_of( m_extractor, demand );
+				if( key )
+					{
+						const auto it = m_index.find( *key );
+						if( it != m_index.end() )
+							{
+								it->second->m_demand = std::move(demand);
+								return;
+							}
+					}
+
+				m_items.push_back( item_t{ key, std::move(demand) } );
+				if( key )
+					{
+						so_5::details::do_with_rollback_on_exception(
+								[&] {
+									m_index.emplace( std::move(*key),
+											std::prev( m_items.end() ) );
+								},
+								[&] { m_items.pop_back(); } );
+					}
+			}
+
+		//! Size of the queue.
+		std::size_t
+		size() const { return m_items.size(); }
+
+	private :
+		//! Extractor of keys.
+		/*!
+		 * It is created once and used for all demands.
+		 */
+		typename traits_type::extractor_t m_extractor;
+
+		//! Items in the order of arrival of their keys.
+		items_container_t m_items;
+
+		//! Index of items by keys.
+		std::unordered_map<
+						key_type,
+						typename items_container_t::iterator,
+						typename traits_type::hash_t >
+				m_index;
+	};
+
+} /* namespace details */
+
+//
+// create_mchain
+//
+/*!
+ * \brief Helper function for creation of conflating mchain.
+ *
+ * A conflating mchain holds only the latest message for every key.
+ * If a new message is sent and a message with the same key is still
+ * waiting in the mchain, the old message is replaced by the new one.
+ * The new message takes the place of the old message in the queue.
+ *
+ * It is useful for streams like market data where a slow consumer should
+ * see only the newest value.
+ *
+ * The key is defined by Policy:
+ * - by_type_t: the key is the type of a message;
+ * - by_key_t<Msg, Key_Extractor>: the key for messages of type Msg is
+ *   the type and a value returned by Key_Extractor. Messages of other
+ *   types are conflated by type.
+ *
+ * Usage example:
+ * \code
+	namespace conflating_ns = so_5::extra::mchains::conflating;
+
+	struct quote_key {
+		std::string operator()(const quote & q) const { return q.m_symbol; }
+	};
+
+	so_5::wrapped_env_t sobj;
+
+	auto ch = conflating_ns::create_mchain<
+			conflating_ns::by_key_t< quote, quote_key > >(
+				sobj.environment() );
+ * \endcode
+ *
+ * \attention
+ * Only \a params with unlimited capacity are accepted (like ones from
+ * so_5::make_unlimited_mchain_params()). The size of the mchain is
+ * limited by the count of distinct keys, so neither a capacity nor an
+ * overflow reaction can be applied. An exception with
+ * errors::rc_limited_capacity_not_supported is thrown for params with
+ * limited capacity.
+ *
+ * \note
+ * Enveloped messages are never conflated.
+ *
+ * \since
+ * v.1.7.0
+ */
+template< typename Policy = by_type_t >
+[[nodiscard]] mchain_t
+create_mchain(
+	environment_t & env,
+	const so_5::mchain_params_t & params = so_5::make_unlimited_mchain_params() )
+	{
+		if( !params.capacity().unlimited() )
+			SO_5_THROW_EXCEPTION( errors::rc_limited_capacity_not_supported,
+					"conflating mchain can't have limited capacity" );
+
+		so_5::impl::internal_env_iface_t env_iface{ env };
+
+		return so_5::impl::make_mchain< details::demand_queue_t< Policy > >(
+				outliving_mutable( env_iface.msg_tracing_stuff_nonchecked() ),
+				params,
+				env,
+				env_iface.allocate_mbox_id() );
+	}
+
+} /* namespace conflating */
+
+} /* namespace mchains */
+
+} /* namespace extra */
+
+} /* namespace so_5 */
@@ -0,0 +1,1023 @@
+/*!
+ * \file
+ * \brief Implementation of a lock-free fixed-size channel between threads.
+ *
+ * \since
+ * v.1.7.0
+ */
+
+#pragma once
+
+#include <so_5_extra/error_ranges.hpp>
+
+#include <so_5/details/at_scope_exit.hpp>
+
+#include <so_5/mchain.hpp>
+#include <so_5/exception.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <iterator>
+#include <mutex>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace so_5
+{
+
+namespace extra
+{
+
+namespace mchains
+{
+
+namespace lock_free
+{
+
+namespace errors
+{
+
+/*!
+ * \brief There is no place in a channel for all payloads from send_bulk().
+ *
+ * \since
+ * v.1.7.0
+ */
+const int rc_channel_overflow =
+		so_5::extra::errors::mchains_lock_free_errors + 1;
+
+/*!
+ * \brief The overflow reaction isn't supported by a channel.
+ *
+ * \since
+ * v.1.7.0
+ */
+const int rc_unsupported_overflow_reaction =
+		so_5::extra::errors::mchains_lock_free_errors + 2;
+
+} /* namespace errors */
+
+//
+// producers_t
+//
+/*!
+ * \brief Count of producers those can write into a channel at the same time.
+ *
+ * \since
+ * v.1.7.0
+ */
+enum class producers_t
+	{
+		//! Only one producer thread at a time.
+		single,
+		//! Any count of producer threads.
+		multiple
+	};
+
+namespace details
+{
+
+//! Size of cache line to be used for separation of hot fields.
+constexpr std::size_t cache_line_size = 64u;
+
+//
+// storage_t
+//
+/*!
+ * \brief Raw storage for one payload.
+ *
+ * \since
+ * v.1.7.0
+ */
+template< typename Payload >
+struct storage_t
+	{
+		alignas(Payload) unsigned char m_data[ sizeof(Payload) ];
+
+		//! Construct a payload in the storage.
+		void
+		construct( Payload && payload ) noexcept
+			{
+				::new( static_cast< void * >( m_data ) ) Payload{ std::move(payload) };
+			}
+
+		//! Access to the constructed payload.
+		[[nodiscard]] Payload &
+		get() noexcept
+			{
+				return *std::launder( reinterpret_cast< Payload * >( m_data ) );
+			}
+
+		//! Move the payload out and destroy it.
+		[[nodiscard]] Payload
+		extract() noexcept
+			{
+				Payload & payload = get();
+				Payload result{ std::move(payload) };
+				payload.~Payload();
+				return result;
+			}
+	};
+
+//
+// spsc_ring_t
+//
+/*!
+ * \brief A ring for one producer and one consumer.
+ *
+ * Positions of the producer and the consumer are placed into different
+ * cache lines. Every side also has a cached copy of the other side's
+ * position, so the other side's cache line is read only when the cached
+ * value says that the ring is full (or empty).
+ *
+ * \since
+ * v.1.7.0
+ */
+template< typename Payload, std::size_t Capacity >
+class spsc_ring_t
+	{
+		static constexpr std::uint64_t index_mask = Capacity - 1u;
+
+		//! Position for the next push. Modified only by the producer.
+		alignas(cache_line_size) std::atomic< std::uint64_t > m_tail{ 0u };
+		//! Last known position of the consumer.
+		std::uint64_t m_cached_head{ 0u };
+
+		//! Position for the next pop. Modified only by the consumer.
+		alignas(cache_line_size) std::atomic< std::uint64_t > m_head{ 0u };
+		//! Last known position of the producer.
+		std::uint64_t m_cached_tail{ 0u };
+
+		//! Slots.
+		alignas(cache_line_size) storage_t< Payload > m_slots[ Capacity ];
+
+	public :
+		//! Try to push a payload.
+		[[nodiscard]] bool
+		try_push( Payload && payload ) noexcept
+			{
+				const auto tail = m_tail.load( std::memory_order_relaxed );
+				if( tail - m_cached_head == Capacity )
+					{
+						m_cached_head = m_head.load( std::memory_order_acquire );
+						if( tail - m_cached_head == Capacity )
+							return false;
+					}
+
+				m_slots[ tail & index_mask ].construct( std::move(payload) );
+				m_tail.store( tail + 1u, std::memory_order_release );
+				return true;
+			}
+
+		//! Try to push up to \a count payloads from \a first.
+		/*!
+		 * The position of the producer is published only once for all
+		 * pushed payloads.
+		 *
+		 * \return count of pushed payloads. If \a partial is false then
+		 * it is 0 or \a count.
+		 */
+		template< typename Input_It >
+		[[nodiscard]] std::size_t
+		try_push_bulk( Input_It first, std::size_t count, bool partial ) noexcept
+			{
+				const auto tail = m_tail.load( std::memory_order_relaxed );
+				if( Capacity - (tail - m_cached_head) < count )
+					m_cached_head = m_head.load( std::memory_order_acquire );
+
+				const auto free_slots = static_cast< std::size_t >(
+						Capacity - (tail - m_cached_head) );
+				if( free_slots < count )
+					{
+						if( !partial )
+							return 0u;
+						count = free_slots;
+					}
+
+				for( std::size_t i = 0u; i != count; ++i, ++first )
+					m_slots[ (tail + i) & index_mask ].construct( Payload( *first ) );
+
+				if( count )
+					m_tail.store( tail + count, std::memory_order_release );
+				return count;
+			}
+
+		//! Try to pop a payload and pass it to \a consumer.
+		/*!
+		 * The slot is released before the call to \a consumer, so
+		 * an exception from \a consumer doesn't break the ring.
+		 */
+		template< typename Consumer >
+		[[nodiscard]] bool
+		try_pop( Consumer && consumer )
+			{
+				const auto head = m_head.load( std::memory_order_relaxed );
+				if( head == m_cached_tail )
+					{
+						m_cached_tail = m_tail.load( std::memory_order_acquire );
+						if( head == m_cached_tail )
+							return false;
+					}
+
+				Payload payload = m_slots[ head & index_mask ].extract();
+				m_head.store( head + 1u, std::memory_order_release );
+				consumer( std::move(payload) );
+				return true;
+			}
+
+		//! Try to pop up to \a max_count payloads into \a out.
+		/*!
+		 * The position of the consumer is published only once for all
+		 * extracted payloads (even if an assignment to \a out throws).
+		 *
+		 * \return count of extracted payloads.
+		 */
+		template< typename Output_It >
+		[[nodiscard]] std::size_t
+		try_pop_bulk( Output_It & out, std::size_t max_count )
+			{
+				const auto head = m_head.load( std::memory_order_relaxed );
+				if( m_cached_tail - head < max_count )
+					m_cached_tail = m_tail.load( std::memory_order_acquire );
+
+				const auto available = static_cast< std::size_t >(
+						m_cached_tail - head );
+				const auto count = (std::min)( available, max_count );
+
+				std::size_t extracted = 0u;
+				const auto publisher = so_5::details::at_scope_exit( [&] {
+						if( extracted )
+							m_head.store( head + extracted, std::memory_order_release );
+					} );
+
+				while( extracted != count )
+					{
+						Payload payload = m_slots[ (head + extracted) & index_mask ].extract();
+						++extracted;
+						*out = std::move(payload);
+						++out;
+					}
+
+				return extracted;
+			}
+
+		//! Approximate count of payloads in the ring.
+		[[nodiscard]] std::size_t
+		size_approx() const noexcept
+			{
+				const auto head = m_head.load( std::memory_order_acquire );
+				const auto tail = m_tail.load( std::memory_order_acquire );
+				return tail > head ? static_cast< std::size_t >( tail - head ) : 0u;
+			}
+	};
+
+//
+// mpsc_ring_t
+//
+/*!
+ * \brief A ring for several producers and one consumer.
+ *
+ * Every slot has a sequence number. A producer claims a position by CAS
+ * on m_enqueue_pos, constructs the payload and then publishes the slot
+ * by storing a new sequence number. The consumer checks the sequence
+ * number of the next slot, so it never sees a partially constructed
+ * payload.
+ *
+ * \since
+ * v.1.7.0
+ */
+template< typename Payload, std::size_t Capacity >
+class mpsc_ring_t
+	{
+		static constexpr std::uint64_t index_mask = Capacity - 1u;
+
+		//! Slot of the ring.
+		struct slot_t
+			{
+				std::atomic< std::uint64_t > m_sequence;
+				storage_t< Payload > m_storage;
+			};
+
+		//! Position for the next push.
+		alignas(cache_line_size) std::atomic< std::uint64_t > m_enqueue_pos{ 0u };
+
+		//! Position for the next pop. Modified only by the consumer.
+		alignas(cache_line_size) std::atomic< std::uint64_t > m_dequeue_pos{ 0u };
+
+		//! Slots.
+		alignas(cache_line_size) slot_t m_slots[ Capacity ];
+
+	public :
+		mpsc_ring_t() noexcept
+			{
+				for( std::uint64_t i = 0u; i != Capacity; ++i )
+					m_slots[ i ].m_sequence.store( i, std::memory_order_relaxed );
+			}
+
+		//! Try to push a payload.
+		[[nodiscard]] bool
+		try_push( Payload && payload ) noexcept
+			{
+				std::uint64_t pos = m_enqueue_pos.load( std::memory_order_relaxed );
+				for(;;)
+					{
+						auto & slot = m_slots[ pos & index_mask ];
+						const std::uint64_t seq = slot.m_sequence.load(
+								std::memory_order_acquire );
+						const auto diff = static_cast< std::int64_t >( seq - pos );
+						if( 0 == diff )
+							{
+								if( m_enqueue_pos.compare_exchange_weak(
+										pos, pos + 1u, std::memory_order_relaxed ) )
+									{
+										slot.m_storage.construct( std::move(payload) );
+										slot.m_sequence.store( pos + 1u,
+												std::memory_order_release );
+										return true;
+									}
+							}
+						else if( diff < 0 )
+							// The slot isn't released by the consumer yet.
+							return false;
+						else
+							pos = m_enqueue_pos.load( std::memory_order_relaxed );
+					}
+			}
+
+		//! Try to push up to \a count payloads from \a first.
+		/*!
+		 * Positions for all payloads are claimed by one CAS. Slots before
+		 * the published position of the consumer plus Capacity are
+		 * already released, so they can be claimed without the check of
+		 * their sequence numbers.
+		 *
+		 * \return count of pushed payloads. If \a partial is false then
+		 * it is 0 or \a count.
+		 */
+		template< typename Input_It >
+		[[nodiscard]] std::size_t
+		try_push_bulk( Input_It first, std::size_t count, bool partial ) noexcept
+			{
+				std::uint64_t pos = m_enqueue_pos.load( std::memory_order_relaxed );
+				std::size_t to_push;
+				do
+					{
+						const auto dequeue_pos = m_dequeue_pos.load(
+								std::memory_order_acquire );
+						const auto limit = dequeue_pos + Capacity;
+						// pos can be ahead of limit because try_push() checks
+						// sequence numbers those are released before
+						// m_dequeue_pos is published.
+						const auto free_slots = limit > pos ?
+								static_cast< std::size_t >( limit - pos ) : 0u;
+
+						to_push = (std::min)( count, free_slots );
+						if( 0u == to_push || (!partial && to_push != count) )
+							return 0u;
+					}
+				while( !m_enqueue_pos.compare_exchange_weak(
+						pos, pos + to_push, std::memory_order_relaxed ) );
+
+				for( std::size_t i = 0u; i != to_push; ++i, ++first )
+					{
+						auto & slot = m_slots[ (pos + i) & index_mask ];
+						slot.m_storage.construct( Payload( *first ) );
+						slot.m_sequence.store( pos + i + 1u, std::memory_order_release );
+					}
+
+				return to_push;
+			}
+
+		//! Try to pop a payload and pass it to \a consumer.
+		/*!
+		 * The slot is released before the call to \a consumer, so
+		 * an exception from \a consumer doesn't break the ring.
+		 */
+		template< typename Consumer >
+		[[nodiscard]] bool
+		try_pop( Consumer && consumer )
+			{
+				const auto pos = m_dequeue_pos.load( std::memory_order_relaxed );
+				auto & slot = m_slots[ pos & index_mask ];
+				if( pos + 1u != slot.m_sequence.load( std::memory_order_acquire ) )
+					return false;
+
+				Payload payload = slot.m_storage.extract();
+				slot.m_sequence.store( pos + Capacity, std::memory_order_release );
+				m_dequeue_pos.store( pos + 1u, std::memory_order_release );
+				consumer( std::move(payload) );
+				return true;
+			}
+
+		//! Try to pop up to \a max_count payloads into \a out.
+		/*!
+		 * Every slot is released just after the extraction of its payload,
+		 * but the position of the consumer is published only once for all
+		 * extracted payloads (even if an assignment to \a out throws).
+		 *
+		 * \return count of extracted payloads.
+		 */
+		template< typename Output_It >
+		[[nodiscard]] std::size_t
+		try_pop_bulk( Output_It & out, std::size_t max_count )
+			{
+				const auto pos = m_dequeue_pos.load( std::memory_order_relaxed );
+
+				std::size_t extracted = 0u;
+				const auto publisher = so_5::details::at_scope_exit( [&] {
+						if( extracted )
+							m_dequeue_pos.store( pos + extracted,
+									std::memory_order_release );
+					} );
+
+				while( extracted != max_count )
+					{
+						const auto current = pos + extracted;
+						auto & slot = m_slots[ current & index_mask ];
+						if( current + 1u != slot.m_sequence.load(
+								std::memory_order_acquire ) )
+							break;
+
+						Payload payload = slot.m_storage.extract();
+						slot.m_sequence.store( current + Capacity,
+								std::memory_order_release );
+						++extracted;
+						*out = std::move(payload);
+						++out;
+					}
+
+				return extracted;
+			}
+
+		//! Approximate count of payloads in the ring.
+		[[nodiscard]] std::size_t
+		size_approx() const noexcept
+			{
+				const auto dequeue_pos = m_dequeue_pos.load(
+						std::memory_order_acquire );
+				const auto enqueue_pos = m_enqueue_pos.load(
+						std::memory_order_acquire );
+				return enqueue_pos > dequeue_pos ?
+						static_cast< std::size_t >( enqueue_pos - dequeue_pos ) : 0u;
+			}
+	};
+
+//
+// parking_lot_t
+//
+/*!
+ * \brief A place where the consumer sleeps while the channel is empty.
+ *
+ * It is a futex-like scheme built from standard primitives. The consumer
+ * raises m_consumer_parked before the last check of the ring. A producer
+ * checks that flag after the publishing of a payload and touches
+ * the mutex and the condition variable only if the consumer is parked.
+ * So there is no system calls on the producer side while the consumer
+ * is busy.
+ *
+ * \since
+ * v.1.7.0
+ */
+class parking_lot_t
+	{
+		//! Is the consumer parked (or going to park)?
+		alignas(cache_line_size) std::atomic< bool > m_consumer_parked{ false };
+
+		//! Has the channel been closed?
+		std::atomic< bool > m_closed{ false };
+
+		std::mutex m_lock;
+		std::condition_variable m_wakeup_cv;
+
+	public :
+		//! Wake the consumer up if it is parked.
+		/*!
+		 * Should be called by a producer after the publishing of a payload.
+		 */
+		void
+		notify() noexcept
+			{
+				// This fence pairs with the fence in park(). Either the producer
+				// sees the flag or the consumer sees the published payload.
+				std::atomic_thread_fence( std::memory_order_seq_cst );
+				if( m_consumer_parked.load( std::memory_order_relaxed ) )
+					{
+						// The lock is necessary to avoid the lost wakeup if
+						// the consumer is between the check and the waiting.
+						{ std::lock_guard< std::mutex > lock{ m_lock }; }
+						m_wakeup_cv.notify_one();
+					}
+			}
+
+		//! Mark the channel as closed and wake the consumer up.
+		void
+		close() noexcept
+			{
+				{
+					std::lock_guard< std::mutex > lock{ m_lock };
+					m_closed.store( true, std::memory_order_release );
+				}
+				m_wakeup_cv.notify_one();
+			}
+
+		//! Has the channel been closed?
+		[[nodiscard]] bool
+		is_closed() const noexcept
+			{
+				return m_closed.load( std::memory_order_acquire );
+			}
+
+		//! Park the consumer until \a ready returns true or the deadline.
+		/*!
+		 * \retval true \a ready returned true or the channel was closed.
+		 * \retval false the deadline was reached.
+		 */
+		template< typename Ready >
+		bool
+		park(
+			const Ready & ready,
+			so_5::mchain_props::duration_t wait_timeout )
+			{
+				using clock = std::chrono::steady_clock;
+
+				const auto now = clock::now();
+				// Very big timeouts (like so_5::infinite_wait) mean
+				// waiting without a deadline.
+				const bool has_deadline =
+						wait_timeout < clock::time_point::max() - now;
+				const auto deadline = has_deadline ?
+						now + wait_timeout : clock::time_point::max();
+
+				std::unique_lock< std::mutex > lock{ m_lock };
+				m_consumer_parked.store( true, std::memory_order_relaxed );
+				std::atomic_thread_fence( std::memory_order_seq_cst );
+
+				const auto predicate = [&] {
+						return ready() || m_closed.load( std::memory_order_acquire );
+					};
+
+				bool result;
+				if( has_deadline )
+					result = m_wakeup_cv.wait_until( lock, deadline, predicate );
+				else
+					{
+						m_wakeup_cv.wait( lock, predicate );
+						result = true;
+					}
+
+				m_consumer_parked.store( false, std::memory_order_relaxed );
+				return result;
+			}
+	};
+
+} /* namespace details */
+
+//
+// bulk_receive_result_t
+//
+/*!
+ * \brief Result of channel_t::receive_bulk().
+ *
+ * \since
+ * v.1.7.0
+ */
+class bulk_receive_result_t
+	{
+		//! Count of extracted payloads.
+		std::size_t m_extracted;
+		//! Status of the extraction.
+		so_5::mchain_props::extraction_status_t m_status;
+
+	public :
+		bulk_receive_result_t(
+			std::size_t extracted,
+			so_5::mchain_props::extraction_status_t status ) noexcept
+			:	m_extracted{ extracted }
+			,	m_status{ status }
+			{}
+
+		//! Count of extracted payloads.
+		[[nodiscard]] std::size_t
+		extracted() const noexcept { return m_extracted; }
+
+		//! Status of the extraction.
+		[[nodiscard]] so_5::mchain_props::extraction_status_t
+		status() const noexcept { return m_status; }
+	};
+
+//
+// channel_t
+//
+/*!
+ * \brief A lock-free fixed-size channel between threads.
+ *
+ * The channel is a ring of Capacity slots. Producers and the consumer
+ * don't acquire any locks while the channel is neither empty nor full.
+ * The consumer sleeps only if the channel is empty, and a producer
+ * wakes it up only if it sleeps (see receive()). The consumer can extract
+ * several payloads at once by receive_bulk().
+ *
+ * Positions of producers and of the consumer are placed into different
+ * cache lines. Capacity should be a power of two, so a position is
+ * converted into the index of a slot by a mask.
+ *
+ * A producer never blocks. If the channel is full then try_send()
+ * returns false and the producer decides what to do (retry, drop the
+ * payload, and so on). Several payloads can be sent at once by
+ * send_bulk().
+ *
+ * Usage example:
+ * \code
+	namespace lf_ns = so_5::extra::mchains::lock_free;
+
+	struct tick { std::uint64_t m_seq; double m_price; };
+
+	lf_ns::channel_t< tick, 1024 > ch;
+
+	// Producer thread.
+	std::thread producer{ [&ch] {
+		for( std::uint64_t i = 0u; i != 1000000u; ++i )
+			while( !ch.try_send( tick{ i, 1.5 } ) )
+				std::this_thread::yield();
+		ch.close();
+	} };
+
+	// Consumer thread.
+	tick t;
+	while( so_5::mchain_props::extraction_status_t::chain_closed !=
+			ch.receive( t, so_5::infinite_wait ) )
+		handle( t );
+ * \endcode
+ *
+ * \note
+ * This isn't a mchain. The channel has one type of payload and doesn't
+ * hold demands with message handlers, so it can't be used with
+ * so_5::receive and so_5::select and can't be used as a mbox. It is
+ * a replacement for a mchain in pipelines between threads where
+ * the cost of the mchain's lock and the demand's allocation is too high.
+ * Use fixed_size::create_mchain() if a mchain is needed.
+ *
+ * \attention
+ * Only one thread at a time can receive from the channel.
+ *
+ * \tparam Payload type of data to be transferred. Its move constructor
+ * must not throw.
+ * \tparam Capacity the count of slots in the ring. Must be a power of two.
+ * \tparam Producers the count of producers those can send at the same time.
+ * The channel for a single producer is cheaper.
+ *
+ * \since
+ * v.1.7.0
+ */
+template<
+	typename Payload,
+	std::size_t Capacity,
+	producers_t Producers = producers_t::single >
+class channel_t
+	{
+		static_assert( std::is_nothrow_move_constructible_v< Payload >,
+				"Payload should be nothrow move constructible" );
+		static_assert( 0u != Capacity && 0u == (Capacity & (Capacity - 1u)),
+				"Capacity should be a power of two" );
+		static_assert( std::atomic< std::uint64_t >::is_always_lock_free,
+				"lock-free 64-bit atomics are required" );
+
+		using ring_type = std::conditional_t<
+				producers_t::single == Producers,
+				details::spsc_ring_t< Payload, Capacity >,
+				details::mpsc_ring_t< Payload, Capacity > >;
+
+		//! Payloads.
+		ring_type m_ring;
+
+		//! The place for the sleeping consumer.
+		details::parking_lot_t m_parking;
+
+		//! Make a consumer for ring_type::try_pop() that assigns
+		//! a payload to \a receiver.
+		[[nodiscard]] static auto
+		make_assigner( Payload & receiver ) noexcept
+			{
+				return [&receiver]( Payload && payload ) {
+						receiver = std::move(payload);
+					};
+			}
+
+	public :
+		channel_t() = default;
+		channel_t( const channel_t & ) = delete;
+		channel_t & operator=( const channel_t & ) = delete;
+
+		~channel_t()
+			{
+				// Payloads left in the channel should be destroyed.
+				while( m_ring.try_pop( []( Payload && ) {} ) )
+					{}
+			}
+
+		//! Try to send a payload into the channel.
+		/*!
+		 * \retval true the payload is in the channel.
+		 * \retval false the channel is full or closed. The payload isn't
+		 * changed in that case.
+		 */
+		[[nodiscard]] bool
+		try_send( Payload && payload ) noexcept
+			{
+				if( m_parking.is_closed() || !m_ring.try_push( std::move(payload) ) )
+					return false;
+
+				m_parking.notify();
+				return true;
+			}
+
+		//! Try to send a copy of a payload into the channel.
+		/*!
+		 * \retval true the payload is in the channel.
+		 * \retval false the channel is full or closed.
+		 */
+		[[nodiscard]] bool
+		try_send( const Payload & payload )
+			{
+				Payload copy{ payload };
+				return try_send( std::move(copy) );
+			}
+
+		//! Send payloads from a range into the channel.
+		/*!
+		 * Places for all payloads are claimed at once, the producer's
+		 * position is published once and the consumer is woken up only
+		 * once for the whole range. Every payload is received as
+		 * a separate Payload by the consumer.
+		 *
+		 * The overflow reaction is applied to the whole range:
+		 *
+		 * - overflow_reaction_t::drop_newest: payloads those fit into
+		 *   the channel are sent, the rest are dropped;
+		 * - overflow_reaction_t::throw_exception: if there is no place for
+		 *   all payloads then nothing is sent and an exception with
+		 *   errors::rc_channel_overflow is thrown;
+		 * - overflow_reaction_t::abort_app: if there is no place for all
+		 *   payloads then the application is aborted by std::abort();
+		 * - overflow_reaction_t::remove_oldest isn't supported because
+		 *   producers can't remove payloads from the channel. An exception
+		 *   with errors::rc_unsupported_overflow_reaction is thrown.
+		 *
+		 * Nothing is sent to a closed channel.
+		 *
+		 * Usage example:
+		 * \code
+			std::vector< tick > ticks = ...;
+			const auto sent = ch.send_bulk(
+					std::make_move_iterator( ticks.begin() ),
+					std::make_move_iterator( ticks.end() ),
+					so_5::mchain_props::overflow_reaction_t::drop_newest );
+		 * \endcode
+		 *
+		 * \note
+		 * Payload should be nothrow constructible from items of the range.
+		 * Use std::make_move_iterator if the copy constructor of Payload
+		 * can throw.
+		 *
+		 * \return count of sent payloads.
+		 */
+		template< typename Forward_It >
+		std::size_t
+		send_bulk(
+			//! The first item of the range.
+			Forward_It first,
+			//! The item after the last item of the range.
+			Forward_It last,
+			//! What to do if there is no place for all payloads.
+			so_5::mchain_props::overflow_reaction_t overflow_reaction )
+			{
+				using so_5::mchain_props::overflow_reaction_t;
+
+				static_assert( std::is_nothrow_constructible_v< Payload,
+						typename std::iterator_traits< Forward_It >::reference >,
+						"Payload should be nothrow constructible from items of "
+						"the range" );
+
+				if( overflow_reaction_t::remove_oldest == overflow_reaction )
+					SO_5_THROW_EXCEPTION( errors::rc_unsupported_overflow_reaction,
+							"remove_oldest isn't supported by lock_free::channel_t" );
+
+				const auto count = static_cast< std::size_t >(
+						std::distance( first, last ) );
+				if( 0u == count || m_parking.is_closed() )
+					return 0u;
+
+				const auto sent = m_ring.try_push_bulk( first, count,
+						overflow_reaction_t::drop_newest == overflow_reaction );
+				if( sent )
+					m_parking.notify();
+				else if( overflow_reaction_t::throw_exception == overflow_reaction )
+					SO_5_THROW_EXCEPTION( errors::rc_channel_overflow,
+							"there is no place in lock_free::channel_t for "
+							+ std::to_string( count ) + " payloads" );
+				else if( overflow_reaction_t::abort_app == overflow_reaction )
+					std::abort();
+
+				return sent;
+			}
+
+		//! Try to receive a payload without waiting.
+		/*!
+		 * \attention
+		 * Must be called by only one consumer at a time.
+		 *
+		 * \retval true a payload is moved into \a receiver.
+		 * \retval false the channel is empty.
+		 */
+		[[nodiscard]] bool
+		try_receive( Payload & receiver )
+			{
+				return m_ring.try_pop( make_assigner( receiver ) );
+			}
+
+		//! Receive a payload with waiting if the channel is empty.
+		/*!
+		 * Payloads those were sent before close() are received before
+		 * extraction_status_t::chain_closed is returned.
+		 *
+		 * \attention
+		 * Must be called by only one consumer at a time.
+		 *
+		 * \retval msg_extracted a payload is moved into \a receiver.
+		 * \retval no_messages the channel is still empty after \a wait_timeout.
+		 * \retval chain_closed the channel is closed and empty.
+		 */
+		[[nodiscard]] so_5::mchain_props::extraction_status_t
+		receive(
+			//! Receiver for the payload.
+			Payload & receiver,
+			//! Max time of waiting. Can be so_5::infinite_wait.
+			so_5::mchain_props::duration_t wait_timeout )
+			{
+				using so_5::mchain_props::extraction_status_t;
+
+				const auto assigner = make_assigner( receiver );
+				for(;;)
+					{
+						if( m_ring.try_pop( assigner ) )
+							return extraction_status_t::msg_extracted;
+
+						if( m_parking.is_closed() )
+							// A payload can be published just before close().
+							return m_ring.try_pop( assigner ) ?
+									extraction_status_t::msg_extracted :
+									extraction_status_t::chain_closed;
+
+						if( !m_parking.park(
+								[this]{ return 0u != m_ring.size_approx(); },
+								wait_timeout ) )
+							return m_ring.try_pop( assigner ) ?
+									extraction_status_t::msg_extracted :
+									extraction_status_t::no_messages;
+					}
+			}
+
+		//! Try to receive up to \a max_count payloads without waiting.
+		/*!
+		 * Payloads are moved into \a out (for example, an iterator of
+		 * a caller's buffer or std::back_inserter). The consumer's position
+		 * is published only once for all extracted payloads, so the cost
+		 * of the synchronization with producers is amortized.
+		 *
+		 * \attention
+		 * Must be called by only one consumer at a time.
+		 *
+		 * \return count of extracted payloads.
+		 */
+		template< typename Output_It >
+		[[nodiscard]] std::size_t
+		try_receive_bulk(
+			//! Destination for payloads.
+			Output_It out,
+			//! Max count of payloads to be extracted.
+			std::size_t max_count )
+			{
+				return m_ring.try_pop_bulk( out, max_count );
+			}
+
+		//! Receive up to \a max_count payloads with waiting if the channel
+		//! is empty.
+		/*!
+		 * The consumer waits (no longer than \a wait_timeout) only if
+		 * the channel is empty. Then up to \a max_count payloads those are
+		 * already in the channel are moved into \a out at once. Payloads
+		 * are handled by the caller after the return, so producers aren't
+		 * delayed by handling of payloads.
+		 *
+		 * Usage example:
+		 * \code
+			lf_ns::channel_t< tick, 4096 > ch;
+			std::array< tick, 64 > buffer;
+			for(;;)
+			{
+				const auto r = ch.receive_bulk(
+						buffer.begin(), buffer.size(), so_5::infinite_wait );
+				if( so_5::mchain_props::extraction_status_t::chain_closed == r.status() )
+					break;
+				for( std::size_t i = 0u; i != r.extracted(); ++i )
+					handle( buffer[ i ] );
+			}
+		 * \endcode
+		 *
+		 * \attention
+		 * Must be called by only one consumer at a time.
+		 *
+		 * \return count of extracted payloads and the status. The status is
+		 * msg_extracted if at least one payload was extracted.
+		 */
+		template< typename Output_It >
+		[[nodiscard]] bulk_receive_result_t
+		receive_bulk(
+			//! Destination for payloads.
+			Output_It out,
+			//! Max count of payloads to be extracted.
+			std::size_t max_count,
+			//! Max time of waiting. Can be so_5::infinite_wait.
+			so_5::mchain_props::duration_t wait_timeout )
+			{
+				using so_5::mchain_props::extraction_status_t;
+
+				if( 0u == max_count )
+					return { 0u, extraction_status_t::no_messages };
+
+				const auto try_extract = [&] {
+						return bulk_receive_result_t{
+								m_ring.try_pop_bulk( out, max_count ),
+								extraction_status_t::msg_extracted };
+					};
+
+				for(;;)
+					{
+						if( const auto r = try_extract(); r.extracted() )
+							return r;
+
+						if( m_parking.is_closed() )
+							{
+								// Payloads can be published just before close().
+								const auto r = try_extract();
+								return r.extracted() ? r :
+										bulk_receive_result_t{
+												0u, extraction_status_t::chain_closed };
+							}
+
+						if( !m_parking.park(
+								[this]{ return 0u != m_ring.size_approx(); },
+								wait_timeout ) )
+							{
+								const auto r = try_extract();
+								return r.extracted() ? r :
+										bulk_receive_result_t{
+												0u, extraction_status_t::no_messages };
+							}
+					}
+			}
+
+		//! Close the channel.
+		/*!
+		 * New payloads aren't accepted after that. The consumer is woken up.
+		 *
+		 * \note
+		 * A payload sent at the same time with close() can be accepted
+		 * after the consumer has got extraction_status_t::chain_closed.
+		 * Such a payload is destroyed with the channel.
+		 */
+		void
+		close() noexcept
+			{
+				m_parking.close();
+			}
+
+		//! Has the channel been closed?
+		[[nodiscard]] bool
+		is_closed() const noexcept
+			{
+				return m_parking.is_closed();
+			}
+
+		//! Approximate count of payloads in the channel.
+		[[nodiscard]] std::size_t
+		size_approx() const noexcept
+			{
+				return m_ring.size_approx();
+			}
+	};
+
+} /* namespace lock_free */
+
+} /* namespace mchains */
+
+} /* namespace extra */
+
+} /* namespace so_5 */
+
@@ -0,0 +1,304 @@
+/*!
+ * \file
+ * \brief Implementation of mchain with several priority lanes.
+ *
+ * \since
+ * v.1.7.0
+ */
+
+#pragma once
+
+#include <so_5_extra/error_ranges.hpp>
+#include <so_5_extra/mchains/segmented.hpp>
+
+#include <so_5/impl/mchain_details.hpp>
+#include <so_5/impl/make_mchain.hpp>
+#include <so_5/impl/internal_env_iface.hpp>
+
+#include <so_5/exception.hpp>
+
+#include <array>
+#include <type_traits>
+
+namespace so_5
+{
+
+namespace extra
+{
+
+namespace mchains
+{
+
+namespace priority
+{
+
+namespace errors
+{
+
+/*!
+ * \brief overflow_reaction_t::remove_oldest can't be used for
+ * mchain with priority lanes.
+ *
+ * \since
+ * v.1.7.0
+ */
+const int rc_remove_oldest_not_supported =
+		so_5::extra::errors::mchains_priority_errors + 1;
+
+} /* namespace errors */
+
+//
+// lane_t
+//
+/*!
+ * \brief Description of one priority lane.
+ *
+ * Enumerates message types that go to that lane. Message types should
+ * be specified the same way as for so_5::send (for example,
+ * `so_5::mutable_msg<M>` for mutable messages).
+ *
+ * \since
+ * v.1.7.0
+ */
+template< typename... Msgs >
+struct lane_t {};
+
+namespace details
+{
+
+//! Size of chunks for queues of lanes.
+constexpr std::size_t lane_chunk_size = 64u;
+
+//
+// lane_queue_t
+//
+/*!
+ * \brief Type of queue for one lane.
+ *
+ * \since
+ * v.1.7.0
+ */
+using lane_queue_t = so_5::extra::mchains::segmented::details::demand_queue_t<
+		lane_chunk_size, 1u >;
+
+//
+// lane_matcher_t
+//
+/*!
+ * \brief Helper for checking that a message type belongs to a lane.
+ *
+ * \since
+ * v.1.7.0
+ */
+template< typename Lane >
+struct lane_matcher_t
+	{
+		static_assert( !std::is_same_v< Lane, Lane >,
+				"lane_t<Msgs...> is expected as description of a lane" );
+	};
+
+template< typename... Msgs >
+struct lane_matcher_t< lane_t< Msgs... > >
+	{
+		[[nodiscard]] static bool
+		matches( const std::type_index & msg_type ) noexcept
+			{
+				return ( ... || (msg_type ==
+						so_5::message_payload_type< Msgs >::subscription_type_index()) );
+			}
+	};
+
+//
+// demand_queue_t
+//
+/*!
+ * \brief Implementation of demands queue with several priority lanes.
+ *
+ * Every lane from Lanes has its own FIFO queue. The first lane has the
+ * highest priority. Messages of types not listed in Lanes go to an
+ * additional lane with the lowest priority.
+ *
+ * The front item is always taken from the highest priority lane that
+ * isn't empty.
+ *
+ * The capacity from mchain's params limits the total size of all lanes.
+ *
+ * \since
+ * v.1.7.0
+ */
+template< typename... Lanes >
+class demand_queue_t
+	{
+		//! Count of lanes (including the lane for all other messages).
+		static constexpr std::size_t lane_count = sizeof...(Lanes) + 1u;
+
+	public :
+		demand_queue_t( so_5::mchain_props::capacity_t capacity )
+			:	m_unlimited{ capacity.unlimited() }
+			,	m_max_size{ capacity.unlimited() ? 0u : capacity.max_size() }
+			,	m_lanes{ make_lanes( std::make_index_sequence< lane_count >{} ) }
+			{}
+
+		//! Is queue full?
+		[[nodiscard]] bool
+		is_full() const { return !m_unlimited && m_max_size == m_size; }
+
+		//! Is queue empty?
+		[[nodiscard]] bool
+		is_empty() const { return 0u == m_size; }
+
+		//! Access to front item of the queue.
+		[[nodiscard]] so_5::mchain_props::demand_t &
+		front()
+			{
+				so_5::mchain_props::details::ensure_queue_not_empty( *this );
+				return top_lane().front();
+			}
+
+		//! Remove the front item from queue.
+		void
+		pop_front()
+			{
+				so_5::mchain_props::details::ensure_queue_not_empty( *this );
+				top_lane().pop_front();
+				--m_size;
+			}
+
+		//! Add a new item to the end of the queue.
+		void
+		push_back( so_5::mchain_props::demand_t && demand )
+			{
+				so_5::mchain_props::details::ensure_queue_not_full( *this );
+				m_lanes[ lane_index( demand.m_msg_type ) ].push_back(
+						std::move(demand) );
+				++m_size;
+			}
+
+		//! Size of the queue.
+		std::size_t
+		size() const { return m_size; }
+
+		//! Get the index of lane for a message type.
+		[[nodiscard]] static std::size_t
+		lane_index( const std::type_index & msg_type ) noexcept
+			{
+				std::size_t index = 0u;
+				// The index will be sizeof...(Lanes) if there is no match.
+				(void)( ... || (lane_matcher_t< Lanes >::matches( msg_type )
+						|| (++index, false)) );
+				return index;
+			}
+
+	private :
+		//! Is the queue unlimited?
+		const bool m_unlimited;
+
+		//! Max size of the queue (if the queue isn't unlimited).
+		const std::size_t m_max_size;
+
+		//! Queues for all lanes.
+		std::array< lane_queue_t, lane_count > m_lanes;
+
+		//! The current size of the queue.
+		std::size_t m_size{ 0u };
+
+		template< std::size_t... Indexes >
+		[[nodiscard]] static std::array< lane_queue_t, lane_count >
+		make_lanes( std::index_sequence< Indexes... > )
+			{
+				return { ( (void)Indexes, lane_queue_t{
+						so_5::mchain_props::capacity_t::make_unlimited() } )... };
+			}
+
+		//! Get the highest priority lane that isn't empty.
+		/*!
+		 * \attention
+		 * The queue should not be empty.
+		 */
+		[[nodiscard]] lane_queue_t &
+		top_lane() noexcept
+			{
+				std::size_t i = 0u;
+				while( m_lanes[ i ].is_empty() )
+					++i;
+				return m_lanes[ i ];
+			}
+	};
+
+} /* namespace details */
+
+//
+// create_mchain
+//
+/*!
+ * \brief Helper function for creation of mchain with priority lanes.
+ *
+ * Messages are extracted from the mchain in the order of priorities of
+ * their lanes. Messages in the same lane are extracted in FIFO order.
+ * It allows urgent messages (like cancellation or shutdown commands)
+ * to bypass a long backlog of ordinary messages.
+ *
+ * The capacity of the mchain and the overflow reaction are taken from
+ * \a params. The capacity limits the total count of messages in all lanes.
+ * Value of params.capacity().memory_usage() is ignored.
+ *
+ * Usage example:
+ * \code
+	namespace priority_ns = so_5::extra::mchains::priority;
+
+	so_5::wrapped_env_t sobj;
+
+	auto ch = priority_ns::create_mchain<
+			// The highest priority.
+			priority_ns::lane_t< msg_cancel, msg_shutdown >,
+			priority_ns::lane_t< so_5::mutable_msg< msg_config > >
+			// All other messages go to the lane with the lowest priority.
+		>(
+			sobj.environment(),
+			so_5::make_unlimited_mchain_params() );
+ * \endcode
+ *
+ * \attention
+ * If the mchain is full then a message of any priority is handled
+ * according to the overflow reaction.
+ *
+ * \attention
+ * overflow_reaction_t::remove_oldest isn't supported. The oldest message
+ * is removed from the front of the queue, and it is the front of the
+ * highest priority lane that isn't empty. So a burst of low priority
+ * messages would evict urgent messages those the mchain should protect.
+ * An exception is thrown if \a params contain that overflow reaction.
+ *
+ * \since
+ * v.1.7.0
+ */
+template< typename... Lanes >
+[[nodiscard]] mchain_t
+create_mchain(
+	environment_t & env,
+	const so_5::mchain_params_t & params )
+	{
+		if( !params.capacity().unlimited() &&
+				so_5::mchain_props::overflow_reaction_t::remove_oldest ==
+						params.capacity().overflow_reaction() )
+			SO_5_THROW_EXCEPTION(
+					errors::rc_remove_oldest_not_supported,
+					"overflow_reaction_t::remove_oldest can't be used for "
+					"mchain with priority lanes" );
+
+		so_5::impl::internal_env_iface_t env_iface{ env };
+
+		return so_5::impl::make_mchain< details::demand_queue_t< Lanes... > >(
+				outliving_mutable( env_iface.msg_tracing_stuff_nonchecked() ),
+				params,
+				env,
+				env_iface.allocate_mbox_id() );
+	}
+
+} /* namespace priority */
+
+} /* namespace mchains */
+
+} /* namespace extra */
+
+} /* namespace so_5 */
@@ -0,0 +1,349 @@
+/*!
+ * \file
+ * \brief Implementation of mchain with segmented growable queue.
+ *
+ * \since
+ * v.1.7.0
+ */
+
+#pragma once
+
+#include <so_5/impl/mchain_details.hpp>
+#include <so_5/impl/make_mchain.hpp>
+#include <so_5/impl/internal_env_iface.hpp>
+
+#include <array>
+
+namespace so_5
+{
+
+namespace extra
+{
+
+namespace mchains
+{
+
+namespace segmented
+{
+
+namespace details
+{
+
+//
+// chunk_t
+//
+/*!
+ * \brief A chunk of storage for demands.
+ *
+ * \since
+ * v.1.7.0
+ */
+template< std::size_t Chunk_Size >
+struct chunk_t
+	{
+		//! Storage for demands.
+		std::array< so_5::mchain_props::demand_t, Chunk_Size > m_items;
+
+		//! The next chunk in the queue (or in the list of spare chunks).
+		chunk_t * m_next{ nullptr };
+	};
+
+//
+// demand_queue_t
+//
+/*!
+ * \brief Implementation of demands queue that consists of fixed-size
+ * chunks.
+ *
+ * New chunks are added when the backlog grows and are returned back
+ * when the backlog shrinks. Up to Max_Spare_Chunks of released chunks
+ * are kept for reuse, all other chunks are deallocated. So the memory used
+ * follows the actual size of the queue, but there is no allocation
+ * for every demand.
+ *
+ * The capacity of the queue is taken from mchain's params. The queue
+ * is unlimited if mchain's capacity is unlimited.
+ *
+ * \since
+ * v.1.7.0
+ */
+template< std::size_t Chunk_Size, std::size_t Max_Spare_Chunks >
+class demand_queue_t
+	{
+		static_assert( 0u != Chunk_Size, "Chunk_Size can't be 0" );
+
+		using chunk_type = chunk_t< Chunk_Size >;
+
+	public :
+		demand_queue_t( so_5::mchain_props::capacity_t capacity )
+			:	m_unlimited{ capacity.unlimited() }
+			,	m_max_size{ capacity.unlimited() ? 0u : capacity.max_size() }
+			{}
+
+		demand_queue_t( const demand_queue_t & ) = delete;
+		demand_queue_t & operator=( const demand_queue_t & ) = delete;
+
+		~demand_queue_t() noexcept
+			{
+				delete_list( m_head_chunk );
+				delete_list( m_spare_chunks );
+			}
+
+		//! Is queue full?
+		[[nodiscard]] bool
+		is_full() const { return !m_unlimited && m_max_size == m_size; }
+
+		//! Is queue empty?
+		[[nodiscard]] bool
+		is_empty() const { return 0u == m_size; }
+
+		//! Access to front item of the queue.
+		[[nodiscard]] so_5::mchain_props::demand_t &
+		front()
+			{
+				so_5::mchain_props::details::ensure_queue_not_empty( *this );
+				return m_head_chunk->m_items[ m_head_index ];
+			}
+
+		//! Remove the front item from queue.
+		void
+		pop_front()
+			{
+				so_5::mchain_props::details::ensure_queue_not_empty( *this );
+				m_head_chunk->m_items[ m_head_index ] =
+						so_5::mchain_props::demand_t{};
+				++m_head_index;
+				--m_size;
+
+				if( 0u == m_size )
+					{
+						// The last chunk is kept in the queue, it will be
+						// reused from the beginning.
+						release_chunks_after( m_head_chunk );
+						m_tail_chunk = m_head_chunk;
+						m_head_index = 0u;
+						m_tail_index = 0u;
+					}
+				else if( Chunk_Size == m_head_index )
+					{
+						chunk_type * next = m_head_chunk->m_next;
+						release_chunk( m_head_chunk );
+						m_head_chunk = next;
+						m_head_index = 0u;
+					}
+			}
+
+		//! Add a new item to the end of the queue.
+		void
+		push_back( so_5::mchain_props::demand_t && demand )
+			{
+				so_5::mchain_props::details::ensure_queue_not_full( *this );
+
+				if( !m_tail_chunk )
+					{
+						m_head_chunk = m_tail_chunk = acquire_chunk();
+					}
+				else if( Chunk_Size == m_tail_index )
+					{
+						chunk_type * chunk = acquire_chunk();
+						m_tail_chunk->m_next = chunk;
+						m_tail_chunk = chunk;
+						m_tail_index = 0u;
+					}
+
+				m_tail_chunk->m_items[ m_tail_index ] = std::move(demand);
+				++m_tail_index;
+				++m_size;
+			}
+
+		//! Size of the queue.
+		std::size_t
+		size() const { return m_size; }
+
+		//! Count of allocated chunks (including spare ones).
+		/*!
+		 * This method is intended for testing purposes.
+		 */
+		[[nodiscard]] std::size_t
+		allocated_chunks() const noexcept { return m_allocated_chunks; }
+
+	private :
+		//! Is the queue unlimited?
+		const bool m_unlimited;
+
+		//! Max size of the queue (if the queue isn't unlimited).
+		const std::size_t m_max_size;
+
+		//! The first chunk with items.
+		chunk_type * m_head_chunk{ nullptr };
+		//! The last chunk with items.
+		chunk_type * m_tail_chunk{ nullptr };
+
+		//! Index of the head item in the head chunk.
+		std::size_t m_head_index{ 0u };
+		//! Index of the place for the next item in the tail chunk.
+		std::size_t m_tail_index{ 0u };
+
+		//! The current size of the queue.
+		std::size_t m_size{ 0u };
+
+		//! List of spare chunks.
+		chunk_type * m_spare_chunks{ nullptr };
+		//! Count of spare chunks.
+		std::size_t m_spare_count{ 0u };
+
+		//! Count of allocated chunks.
+		std::size_t m_allocated_chunks{ 0u };
+
+		//! Get a chunk from the list of spare chunks or allocate a new one.
+		[[nodiscard]] chunk_type *
+		acquire_chunk()
+			{
+				if( m_spare_chunks )
+					{
+						chunk_type * chunk = m_spare_chunks;
+						m_spare_chunks = chunk->m_next;
+						chunk->m_next = nullptr;
+						--m_spare_count;
+						return chunk;
+					}
+
+				chunk_type * chunk = new chunk_type{};
+				++m_allocated_chunks;
+				return chunk;
+			}
+
+		//! Return a chunk to the list of spare chunks or deallocate it.
+		/*!
+		 * \attention
+		 * All items in the chunk should be empty.
+		 */
+		void
+		release_chunk( chunk_type * chunk ) noexcept
+			{
+				if( m_spare_count < Max_Spare_Chunks )
+					{
+						chunk->m_next = m_spare_chunks;
+						m_spare_chunks = chunk;
+						++m_spare_count;
+					}
+				else
+					{
+						delete chunk;
+						--m_allocated_chunks;
+					}
+			}
+
+		//! Release all chunks that follow \a chunk.
+		void
+		release_chunks_after( chunk_type * chunk ) noexcept
+			{
+				chunk_type * next = chunk->m_next;
+				chunk->m_next = nullptr;
+				while( next )
+					{
+						chunk_type * current = next;
+						next = current->m_next;
+						release_chunk( current );
+					}
+			}
+
+		static void
+		delete_list( chunk_type * chunk ) noexcept
+			{
+				while( chunk )
+					{
+						chunk_type * next = chunk->m_next;
+						delete chunk;
+						chunk = next;
+					}
+			}
+	};
+
+} /* namespace details */
+
+//
+// create_mchain
+//
+/*!
+ * \brief Helper function for creation of mchain with segmented queue.
+ *
+ * The queue of this mchain grows by chunks of Chunk_Size demands. Chunks
+ * that are no more needed are deallocated (up to Max_Spare_Chunks of them
+ * are kept for reuse). It makes the mchain suitable for bursty traffic:
+ * a big backlog is possible, but memory isn't held after the burst,
+ * and there is no allocation for every message.
+ *
+ * The capacity of the mchain and the overflow reaction are taken from
+ * \a params. Value of params.capacity().memory_usage() is ignored.
+ *
+ * Usage example:
+ * \code
+	so_5::wrapped_env_t sobj;
+
+	auto ch = so_5::extra::mchains::segmented::create_mchain<256>(
+			sobj.environment(),
+			so_5::make_limited_without_waiting_mchain_params(
+					100000,
+					so_5::mchain_props::memory_usage_t::dynamic, // Will be ignored.
+					so_5::mchain_props::overflow_reaction_t::drop_newest) );
+ * \endcode
+ *
+ * \tparam Chunk_Size the count of demands in one chunk.
+ * \tparam Max_Spare_Chunks the max count of released chunks to be kept
+ * for reuse.
+ *
+ * \since
+ * v.1.7.0
+ */
+template< std::size_t Chunk_Size, std::size_t Max_Spare_Chunks = 1u >
+[[nodiscard]] mchain_t
+create_mchain(
+	environment_t & env,
+	const so_5::mchain_params_t & params )
+	{
+		so_5::impl::internal_env_iface_t env_iface{ env };
+
+		return so_5::impl::make_mchain<
+						details::demand_queue_t< Chunk_Size, Max_Spare_Chunks > >(
+				outliving_mutable( env_iface.msg_tracing_stuff_nonchecked() ),
+				params,
+				env,
+				env_iface.allocate_mbox_id() );
+	}
+
+//
+// create_mchain
+//
+/*!
+ * \brief Helper function for creation of size-unlimited mchain with
+ * segmented queue.
+ *
+ * Usage example:
+ * \code
+	so_5::wrapped_env_t sobj;
+
+	auto ch = so_5::extra::mchains::segmented::create_mchain<256>(
+			sobj.environment() );
+ * \endcode
+ *
+ * \since
+ * v.1.7.0
+ */
+template< std::size_t Chunk_Size, std::size_t Max_Spare_Chunks = 1u >
+[[nodiscard]] mchain_t
+create_mchain(
+	environment_t & env )
+	{
+		return create_mchain< Chunk_Size, Max_Spare_Chunks >(
+				env,
+				so_5::make_unlimited_mchain_params() );
+	}
+
+} /* namespace segmented */
+
+} /* namespace mchains */
+
+} /* namespace extra */
+
+} /* namespace so_5 */
@@ -0,0 +1,604 @@
+/*!
+ * \file
+ * \brief Implementation of a channel for inter-process messaging via
+ * POSIX shared memory.
+ *
+ * \note
+ * This module is available on POSIX platforms only.
+ *
+ * \since
+ * v.1.7.0
+ */
+
+#pragma once
+
+#if !defined(__unix__) && !defined(__APPLE__)
+	#error "so_5_extra/mchains/shared_memory.hpp can be used on POSIX platforms only"
+#endif
+
+#include <so_5_extra/error_ranges.hpp>
+
+#include <so_5/send_functions.hpp>
+#include <so_5/exception.hpp>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace so_5
+{
+
+namespace extra
+{
+
+namespace mchains
+{
+
+namespace shared_memory
+{
+
+namespace errors
+{
+
+/*!
+ * \brief shm_open failed.
+ *
+ * \since
+ * v.1.7.0
+ */
+const int rc_shm_open_failed =
+		so_5::extra::errors::mchains_shared_memory_errors + 1;
+
+/*!
+ * \brief Setting the size of shared memory object failed.
+ *
+ * \since
+ * v.1.7.0
+ */
+const int rc_shm_truncate_failed =
+		so_5::extra::errors::mchains_shared_memory_errors + 2;
+
+/*!
+ * \brief mmap of shared memory object failed.
+ *
+ * \since
+ * v.1.7.0
+ */
+const int rc_mmap_failed =
+		so_5::extra::errors::mchains_shared_memory_errors + 3;
+
+/*!
+ * \brief Shared memory object isn't initialized or was created for
+ * a channel with different Payload or Capacity.
+ *
+ * \since
+ * v.1.7.0
+ */
+const int rc_incompatible_shared_memory =
+		so_5::extra::errors::mchains_shared_memory_errors + 4;
+
+/*!
+ * \brief Shared memory object already exists.
+ *
+ * It can be left by a creator that has crashed. Such an object can be
+ * removed by channel_t::remove().
+ *
+ * \since
+ * v.1.7.0
+ */
+const int rc_shm_already_exists =
+		so_5::extra::errors::mchains_shared_memory_errors + 5;
+
+} /* namespace errors */
+
+namespace details
+{
+
+//! Size of cache line to be used for separation of hot fields.
+constexpr std::size_t cache_line_size = 64u;
+
+//! Value of state of the initialized ring.
+constexpr std::uint32_t ring_ready_mark = 0x53354d43u;
+
+//
+// ring_t
+//
+/*!
+ * \brief Layout of the ring in shared memory.
+ *
+ * It is a bounded queue with a sequence number in every slot. A producer
+ * claims a position by CAS on m_enqueue_pos, copies the payload into the
+ * slot and then publishes the slot by storing a new sequence number.
+ * The consumer checks the sequence number of the next slot, so it never
+ * sees a partially written payload.
+ *
+ * \since
+ * v.1.7.0
+ */
+template< typename Payload, std::size_t Capacity >
+struct ring_t
+	{
+		//! Slot of the ring.
+		struct slot_t
+			{
+				std::atomic< std::uint64_t > m_sequence;
+				alignas(Payload) unsigned char m_payload[ sizeof(Payload) ];
+			};
+
+		//! State of the ring.
+		/*!
+		 * Is set to ring_ready_mark when the ring is initialized.
+		 */
+		std::atomic< std::uint32_t > m_state;
+
+		//! Size of the payload (for the check of compatibility).
+		std::uint64_t m_payload_size;
+		//! Capacity of the ring (for the check of compatibility).
+		std::uint64_t m_capacity;
+
+		//! Position for the next enqueue.
+		alignas(cache_line_size) std::atomic< std::uint64_t > m_enqueue_pos;
+		//! Position for the next dequeue.
+		alignas(cache_line_size) std::atomic< std::uint64_t > m_dequeue_pos;
+
+		//! Slots.
+		alignas(cache_line_size) slot_t m_slots[ Capacity ];
+	};
+
+//
+// mapping_t
+//
+/*!
+ * \brief Owner of mapped shared memory object.
+ *
+ * The creator of the object unlinks it in the destructor.
+ *
+ * \since
+ * v.1.7.0
+ */
+class mapping_t
+	{
+		//! Address of mapped memory.
+		void * m_address{ nullptr };
+		//! Size of mapped memory.
+		std::size_t m_size{ 0u };
+		//! Name of the object to be unlinked (empty if not an owner).
+		std::string m_name_to_unlink;
+
+		mapping_t(
+			void * address,
+			std::size_t size,
+			std::string name_to_unlink ) noexcept
+			:	m_address{ address }
+			,	m_size{ size }
+			,	m_name_to_unlink{ std::move(name_to_unlink) }
+			{}
+
+		[[noreturn]] static void
+		throw_errno( int error_code, const char * what, const std::string & name )
+			{
+				const int e = errno;
+				SO_5_THROW_EXCEPTION( error_code,
+						std::string{ what } + " failed for '" + name + "': "
+								+ std::strerror( e ) );
+			}
+
+		[[nodiscard]] static void *
+		map( int fd, std::size_t size, const std::string & name )
+			{
+				void * address = ::mmap( nullptr, size,
+						PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+				if( MAP_FAILED == address )
+					{
+						::close( fd );
+						throw_errno( errors::rc_mmap_failed, "mmap", name );
+					}
+
+				// The mapping remains valid after closing of the descriptor.
+				::close( fd );
+				return address;
+			}
+
+	public :
+		mapping_t( const mapping_t & ) = delete;
+		mapping_t & operator=( const mapping_t & ) = delete;
+
+		mapping_t( mapping_t && o ) noexcept
+			:	m_address{ std::exchange( o.m_address, nullptr ) }
+			,	m_size{ std::exchange( o.m_size, 0u ) }
+			,	m_name_to_unlink{ std::move(o.m_name_to_unlink) }
+			{
+				o.m_name_to_unlink.clear();
+			}
+
+		mapping_t &
+		operator=( mapping_t && o ) noexcept
+			{
+				mapping_t tmp{ std::move(o) };
+				swap( *this, tmp );
+				return *this;
+			}
+
+		friend void
+		swap( mapping_t & a, mapping_t & b ) noexcept
+			{
+				using std::swap;
+				swap( a.m_address, b.m_address );
+				swap( a.m_size, b.m_size );
+				swap( a.m_name_to_unlink, b.m_name_to_unlink );
+			}
+
+		~mapping_t() noexcept
+			{
+				if( m_address )
+					::munmap( m_address, m_size );
+				if( !m_name_to_unlink.empty() )
+					::shm_unlink( m_name_to_unlink.c_str() );
+			}
+
+		//! Create a new shared memory object and map it.
+		/*!
+		 * \attention
+		 * It is an error if the object already exists.
+		 */
+		[[nodiscard]] static mapping_t
+		create( const std::string & name, std::size_t size )
+			{
+				const int fd = ::shm_open( name.c_str(),
+						O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR );
+				if( -1 == fd )
+					throw_errno(
+							EEXIST == errno ?
+									errors::rc_shm_already_exists :
+									errors::rc_shm_open_failed,
+							"shm_open",
+							name );
+
+				if( -1 == ::ftruncate( fd, static_cast< off_t >( size ) ) )
+					{
+						const int e = errno;
+						::close( fd );
+						::shm_unlink( name.c_str() );
+						errno = e;
+						throw_errno( errors::rc_shm_truncate_failed, "ftruncate", name );
+					}
+
+				void * address = nullptr;
+				try
+					{
+						address = map( fd, size, name );
+					}
+				catch( ... )
+					{
+						::shm_unlink( name.c_str() );
+						throw;
+					}
+
+				return { address, size, name };
+			}
+
+		//! Open and map an existing shared memory object.
+		[[nodiscard]] static mapping_t
+		open( const std::string & name, std::size_t size )
+			{
+				const int fd = ::shm_open( name.c_str(), O_RDWR, 0 );
+				if( -1 == fd )
+					throw_errno( errors::rc_shm_open_failed, "shm_open", name );
+
+				struct stat st;
+				if( -1 == ::fstat( fd, &st ) ||
+						static_cast< std::size_t >( st.st_size ) < size )
+					{
+						::close( fd );
+						SO_5_THROW_EXCEPTION( errors::rc_incompatible_shared_memory,
+								"shared memory object '" + name
+										+ "' is too small for the channel" );
+					}
+
+				return { map( fd, size, name ), size, std::string{} };
+			}
+
+		//! Address of mapped memory.
+		[[nodiscard]] void *
+		address() const noexcept { return m_address; }
+	};
+
+} /* namespace details */
+
+//
+// channel_t
+//
+/*!
+ * \brief A channel between processes on the same host.
+ *
+ * The channel is a fixed-size ring of Capacity slots in a POSIX shared
+ * memory object. Any count of producers (in any processes) can write
+ * into the channel. There should be only one consumer.
+ *
+ * Writing and reading are lock-free. A producer never blocks: if the
+ * ring is full then try_send() returns false.
+ *
+ * The consumer side usually creates the channel by create() and pumps
+ * messages into the local SObjectizer environment by dispatch().
+ * Producers open the channel by open().
+ *
+ * Usage example:
+ * \code
+	namespace shm_ns = so_5::extra::mchains::shared_memory;
+
+	struct quote { char m_symbol[8]; double m_price; };
+
+	using quotes_channel = shm_ns::channel_t< quote, 4096 >;
+
+	// Consumer process.
+	auto consumer = quotes_channel::create( "/quotes" );
+	auto ch = so_5::create_mchain( env );
+	...
+	for(;;) {
+		if( 0u == shm_ns::dispatch( consumer, ch, 256u ) )
+			std::this_thread::yield();
+	}
+
+	// Producer process.
+	auto producer = quotes_channel::open( "/quotes" );
+	if( !producer.try_send( quote{ "ABC", 1.5 } ) )
+		... // The channel is full.
+ * \endcode
+ *
+ * \tparam Payload type of data to be transferred. Must be trivially
+ * copyable. Types with pointers (like std::string) can't be used, data
+ * should be serialized into a fixed-size buffer for them.
+ * \tparam Capacity the count of slots in the ring. Must be a power of two.
+ *
+ * \attention
+ * If a producer process dies between the reservation of a slot and
+ * the publishing of the data then the consumer will stop on that slot.
+ *
+ * \attention
+ * If the creator process dies then the shared memory object isn't removed.
+ * Producers still can open it, but the next create() with the same name
+ * fails with errors::rc_shm_already_exists. The stale object should be
+ * removed by remove() before the creation of a new channel.
+ *
+ * \since
+ * v.1.7.0
+ */
+template< typename Payload, std::size_t Capacity >
+class channel_t
+	{
+		static_assert( std::is_trivially_copyable_v< Payload >,
+				"Payload should be trivially copyable" );
+		static_assert( 0u != Capacity && 0u == (Capacity & (Capacity - 1u)),
+				"Capacity should be a power of two" );
+		static_assert( std::atomic< std::uint64_t >::is_always_lock_free,
+				"lock-free 64-bit atomics are required for shared memory" );
+
+		using ring_type = details::ring_t< Payload, Capacity >;
+
+		static constexpr std::uint64_t index_mask = Capacity - 1u;
+
+		//! Mapped shared memory.
+		details::mapping_t m_mapping;
+
+		//! The ring in the shared memory.
+		ring_type * m_ring;
+
+		channel_t( details::mapping_t mapping, ring_type * ring ) noexcept
+			:	m_mapping{ std::move(mapping) }
+			,	m_ring{ ring }
+			{}
+
+	public :
+		//! Create a new shared memory object for the channel.
+		/*!
+		 * The object is removed when the returned channel is destroyed.
+		 */
+		[[nodiscard]] static channel_t
+		create( const std::string & name )
+			{
+				auto mapping = details::mapping_t::create( name, sizeof(ring_type) );
+
+				// The memory is already zero-filled by ftruncate.
+				auto * ring = ::new( mapping.address() ) ring_type;
+				ring->m_payload_size = sizeof(Payload);
+				ring->m_capacity = Capacity;
+				ring->m_enqueue_pos.store( 0u, std::memory_order_relaxed );
+				ring->m_dequeue_pos.store( 0u, std::memory_order_relaxed );
+				for( std::uint64_t i = 0u; i != Capacity; ++i )
+					ring->m_slots[ i ].m_sequence.store( i, std::memory_order_relaxed );
+
+				ring->m_state.store( details::ring_ready_mark, std::memory_order_release );
+
+				return { std::move(mapping), ring };
+			}
+
+		//! Remove a shared memory object of a channel.
+		/*!
+		 * It is intended for the removal of an object left by a crashed
+		 * creator. Processes those have opened the object can use it
+		 * until they close the channel.
+		 *
+		 * \retval true the object is removed.
+		 * \retval false there is no such object.
+		 */
+		static bool
+		remove( const std::string & name ) noexcept
+			{
+				return 0 == ::shm_unlink( name.c_str() );
+			}
+
+		//! Open an existing channel.
+		/*!
+		 * \throw so_5::exception_t if the channel isn't initialized yet
+		 * or was created with different Payload or Capacity.
+		 */
+		[[nodiscard]] static channel_t
+		open( const std::string & name )
+			{
+				auto mapping = details::mapping_t::open( name, sizeof(ring_type) );
+
+				auto * ring = std::launder(
+						reinterpret_cast< ring_type * >( mapping.address() ) );
+				if( details::ring_ready_mark !=
+						ring->m_state.load( std::memory_order_acquire ) )
+					SO_5_THROW_EXCEPTION( errors::rc_incompatible_shared_memory,
+							"shared memory object '" + name + "' isn't initialized" );
+
+				if( sizeof(Payload) != ring->m_payload_size ||
+						Capacity != ring->m_capacity )
+					SO_5_THROW_EXCEPTION( errors::rc_incompatible_shared_memory,
+							"shared memory object '" + name
+									+ "' was created for a different channel" );
+
+				return { std::move(mapping), ring };
+			}
+
+		//! Try to write a payload into the channel.
+		/*!
+		 * Can be called by several producers at the same time.
+		 *
+		 * \retval true the payload is written.
+		 * \retval false the channel is full.
+		 */
+		[[nodiscard]] bool
+		try_send( const Payload & payload ) noexcept
+			{
+				std::uint64_t pos = m_ring->m_enqueue_pos.load(
+						std::memory_order_relaxed );
+				for(;;)
+					{
+						auto & slot = m_ring->m_slots[ pos & index_mask ];
+						const std::uint64_t seq = slot.m_sequence.load(
+								std::memory_order_acquire );
+						const auto diff = static_cast< std::int64_t >( seq - pos );
+						if( 0 == diff )
+							{
+								if( m_ring->m_enqueue_pos.compare_exchange_weak(
+										pos, pos + 1u, std::memory_order_relaxed ) )
+									{
+										std::memcpy( slot.m_payload, &payload, sizeof(Payload) );
+										slot.m_sequence.store( pos + 1u,
+												std::memory_order_release );
+										return true;
+									}
+							}
+						else if( diff < 0 )
+							// The slot isn't released by the consumer yet.
+							return false;
+						else
+							pos = m_ring->m_enqueue_pos.load( std::memory_order_relaxed );
+					}
+			}
+
+		//! Try to read a payload from the channel.
+		/*!
+		 * \attention
+		 * Must be called by only one consumer at a time.
+		 *
+		 * \retval true a payload is read into \a receiver.
+		 * \retval false the channel is empty.
+		 */
+		[[nodiscard]] bool
+		try_receive( Payload & receiver ) noexcept
+			{
+				return try_receive_raw( &receiver );
+			}
+
+		//! Try to read a payload from the channel into raw memory.
+		/*!
+		 * The payload is copied by memcpy, so \a receiver can point to
+		 * uninitialized storage suitable for Payload. It allows to receive
+		 * payloads those aren't default constructible.
+		 *
+		 * \attention
+		 * Must be called by only one consumer at a time.
+		 *
+		 * \retval true a payload is read into \a receiver.
+		 * \retval false the channel is empty.
+		 */
+		[[nodiscard]] bool
+		try_receive_raw( void * receiver ) noexcept
+			{
+				const std::uint64_t pos = m_ring->m_dequeue_pos.load(
+						std::memory_order_relaxed );
+				auto & slot = m_ring->m_slots[ pos & index_mask ];
+				if( pos + 1u != slot.m_sequence.load( std::memory_order_acquire ) )
+					return false;
+
+				std::memcpy( receiver, slot.m_payload, sizeof(Payload) );
+				slot.m_sequence.store( pos + Capacity, std::memory_order_release );
+				m_ring->m_dequeue_pos.store( pos + 1u, std::memory_order_relaxed );
+				return true;
+			}
+
+		//! Approximate count of payloads in the channel.
+		[[nodiscard]] std::size_t
+		size_approx() const noexcept
+			{
+				const auto dequeue_pos = m_ring->m_dequeue_pos.load(
+						std::memory_order_relaxed );
+				const auto enqueue_pos = m_ring->m_enqueue_pos.load(
+						std::memory_order_relaxed );
+				return enqueue_pos > dequeue_pos ?
+						static_cast< std::size_t >( enqueue_pos - dequeue_pos ) : 0u;
+			}
+	};
+
+//
+// dispatch
+//
+/*!
+ * \brief Read payloads from a channel and send them to a local
+ * mbox or mchain.
+ *
+ * Every payload is sent as a message of type Payload by so_5::send.
+ *
+ * \attention
+ * Must be called by only one consumer at a time.
+ *
+ * \return count of dispatched payloads. It is zero if the channel is empty.
+ *
+ * \since
+ * v.1.7.0
+ */
+template< typename Payload, std::size_t Capacity, typename Target >
+std::size_t
+dispatch(
+	//! The channel to read from.
+	channel_t< Payload, Capacity > & from,
+	//! The destination (mbox or mchain).
+	const Target & to,
+	//! Max count of payloads to be dispatched.
+	std::size_t max_count )
+	{
+		std::size_t dispatched = 0u;
+		// Payload isn't required to be default constructible.
+		alignas(Payload) unsigned char storage[ sizeof(Payload) ];
+		while( dispatched != max_count && from.try_receive_raw( storage ) )
+			{
+				so_5::send< Payload >( to,
+						*std::launder( reinterpret_cast< const Payload * >( storage ) ) );
+				++dispatched;
+			}
+
+		return dispatched;
+	}
+
+} /* namespace shared_memory */
+
+} /* namespace mchains */
+
+} /* namespace extra */
+
+} /* namespace so_5 */
+
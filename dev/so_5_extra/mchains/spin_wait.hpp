@@ -0,0 +1,378 @@
+/*!
+ * \file
+ * \brief Spin-then-park waiting strategy for mchains.
+ *
+ * \since
+ * v.1.7.0
+ */
+
+#pragma once
+
+#include <so_5/mchain.hpp>
+#include <so_5/environment.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+	#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+	#include <immintrin.h>
+#endif
+
+namespace so_5
+{
+
+namespace extra
+{
+
+namespace mchains
+{
+
+namespace spin_wait
+{
+
+//
+// strategy_t
+//
+/*!
+ * \brief Description of waiting strategy.
+ *
+ * A consumer at first checks the mchain \a spins times with a pause
+ * instruction between checks. Then it checks the mchain \a yields times
+ * with std::this_thread::yield() between checks. If the mchain is still
+ * empty then the consumer goes to the ordinary waiting (parks on the
+ * mchain's condition variable).
+ *
+ * Checks during spinning and yielding don't acquire the mchain's lock.
+ *
+ * The default strategy has no spinning and no yielding.
+ *
+ * \since
+ * v.1.7.0
+ */
+class strategy_t
+	{
+		//! Count of spins with pause instruction.
+		std::uint32_t m_spins{ 0u };
+
+		//! Count of spins with yield.
+		std::uint32_t m_yields{ 0u };
+
+	public :
+		strategy_t() noexcept = default;
+
+		[[nodiscard]] std::uint32_t
+		spins() const noexcept { return m_spins; }
+
+		strategy_t &
+		spins( std::uint32_t v ) noexcept
+			{
+				m_spins = v;
+				return *this;
+			}
+
+		[[nodiscard]] std::uint32_t
+		yields() const noexcept { return m_yields; }
+
+		strategy_t &
+		yields( std::uint32_t v ) noexcept
+			{
+				m_yields = v;
+				return *this;
+			}
+	};
+
+namespace details
+{
+
+//
+// cpu_relax
+//
+/*!
+ * \brief A hint for CPU that the current thread is spinning.
+ *
+ * \since
+ * v.1.7.0
+ */
+inline void
+cpu_relax() noexcept
+	{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+		_mm_pause();
+#elif defined(__x86_64__) || defined(__i386__)
+		_mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+		__asm__ __volatile__( "yield" );
+#endif
+	}
+
+//
+// state_t
+//
+/*!
+ * \brief A state that is shared between mchain's notificator and waiter.
+ *
+ * \since
+ * v.1.7.0
+ */
+struct state_t
+	{
+		//! Count of transitions of mchain from empty to not-empty state.
+		std::atomic< std::uint64_t > m_epoch{ 0u };
+	};
+
+} /* namespace details */
+
+//
+// waiter_t
+//
+/*!
+ * \brief An object that implements spin-then-park waiting for a mchain.
+ *
+ * A waiter should be bound to a mchain at the creation time of the
+ * mchain via tune() method (or via spin_wait::create_mchain function).
+ * tune() installs a not-empty notificator into mchain's params.
+ * That notificator signals the waiter without any locks.
+ *
+ * Usage example:
+ * \code
+	namespace spin_ns = so_5::extra::mchains::spin_wait;
+
+	spin_ns::waiter_t waiter{ spin_ns::strategy_t{}.spins(2000).yields(50) };
+
+	auto ch = so_5::extra::mchains::fixed_size::create_mchain<1024>(
+			env,
+			waiter.tune( so_5::make_limited_without_waiting_mchain_params(
+					1024, // Will be ignored.
+					so_5::mchain_props::memory_usage_t::preallocated, // Will be ignored.
+					so_5::mchain_props::overflow_reaction_t::drop_newest ) ) );
+	...
+	// Consumer's loop. It is finished when the mchain is closed.
+	waiter.receive(
+			so_5::from(ch).handle_all(),
+			[](const market_data & md) {...} );
+ * \endcode
+ *
+ * \note
+ * A waiter can be copied. All copies share the same state.
+ *
+ * \attention
+ * One waiter should be used with one mchain only.
+ *
+ * \since
+ * v.1.7.0
+ */
+class waiter_t
+	{
+		//! Shared state.
+		std::shared_ptr< details::state_t > m_state;
+
+		//! Waiting strategy.
+		strategy_t m_strategy;
+
+	public :
+		waiter_t( strategy_t strategy )
+			:	m_state{ std::make_shared< details::state_t >() }
+			,	m_strategy{ strategy }
+			{}
+
+		//! Get a copy of mchain's params with notificator for the waiter.
+		/*!
+		 * A not-empty notificator from \a params (if any) will be called
+		 * too.
+		 */
+		[[nodiscard]] so_5::mchain_params_t
+		tune( so_5::mchain_params_t params ) const
+			{
+				params.not_empty_notificator(
+						[state = m_state, old = params.not_empty_notificator()] {
+							state->m_epoch.fetch_add( 1u, std::memory_order_release );
+							if( old )
+								old();
+						} );
+
+				return params;
+			}
+
+		//! Spin and yield until the mchain becomes not empty.
+		/*!
+		 * \retval true the mchain isn't empty.
+		 * \retval false the mchain is still empty after all spins and
+		 * yields.
+		 */
+		[[nodiscard]] bool
+		wait_not_empty( const so_5::mchain_t & ch ) const
+			{
+				// The epoch should be read before the check of the mchain.
+				// Otherwise a notification between the check and the read
+				// will be lost.
+				const auto epoch = m_state->m_epoch.load( std::memory_order_acquire );
+				if( !ch->empty() )
+					return true;
+
+				const auto changed = [&] {
+						return epoch != m_state->m_epoch.load(
+								std::memory_order_acquire );
+					};
+
+				for( std::uint32_t i = 0u; i != m_strategy.spins(); ++i )
+					{
+						if( changed() )
+							return true;
+						details::cpu_relax();
+					}
+
+				for( std::uint32_t i = 0u; i != m_strategy.yields(); ++i )
+					{
+						if( changed() )
+							return true;
+						std::this_thread::yield();
+					}
+
+				return changed();
+			}
+
+		//! Receive and handle messages with spin-then-park waiting.
+		/*!
+		 * It is a loop. Every iteration spins and yields by wait_not_empty()
+		 * and then extracts and handles all messages those are already in
+		 * the mchain by so_5::receive with no_wait_on_empty(). If the mchain
+		 * is still empty after all spins and yields then the iteration
+		 * parks on mchain's condition variable until the first message
+		 * (but no longer than params.empty_timeout()).
+		 *
+		 * The loop is finished when:
+		 *
+		 * - params.to_extract() messages are extracted or params.to_handle()
+		 *   messages are handled (if those limits are set);
+		 * - params.total_time() is elapsed (if it is set);
+		 * - there is no messages after params.empty_timeout();
+		 * - params.stop_on() returns true;
+		 * - the mchain is closed.
+		 *
+		 * \note
+		 * The time of spinning and yielding isn't counted in
+		 * params.empty_timeout().
+		 */
+		template< typename Receive_Params, typename... Handlers >
+		mchain_receive_result_t
+		receive(
+			Receive_Params && params,
+			Handlers &&... handlers ) const
+			{
+				using so_5::mchain_props::extraction_status_t;
+				using clock = std::chrono::steady_clock;
+
+				using params_type = std::decay_t< Receive_Params >;
+
+				// Very big total time (like so_5::infinite_wait) means
+				// no limit for total time.
+				const auto started_at = clock::now();
+				const bool has_deadline =
+						params.total_time() < clock::time_point::max() - started_at;
+				const auto deadline = has_deadline ?
+						started_at + params.total_time() : clock::time_point::max();
+
+				// Zero limit means no limit.
+				const auto remaining = []( std::size_t limit, std::size_t done ) {
+						return 0u == limit ? 0u : limit - done;
+					};
+				const auto is_reached = []( std::size_t limit, std::size_t done ) {
+						return 0u != limit && done >= limit;
+					};
+
+				std::size_t extracted = 0u;
+				std::size_t handled = 0u;
+				extraction_status_t status = extraction_status_t::no_messages;
+
+				for(;;)
+					{
+						if( is_reached( params.to_extract(), extracted ) ||
+								is_reached( params.to_handle(), handled ) ||
+								( params.stop_on() && params.stop_on()() ) )
+							break;
+
+						params_type step{ params };
+						step.extract_n( remaining( params.to_extract(), extracted ) )
+							.handle_n( remaining( params.to_handle(), handled ) );
+
+						if( has_deadline )
+							{
+								const auto now = clock::now();
+								if( now >= deadline )
+									break;
+								step.total_time( deadline - now );
+							}
+
+						const bool not_empty = wait_not_empty( params.chain() );
+						if( not_empty )
+							step.no_wait_on_empty();
+						else
+							// Park until the first message or empty_timeout.
+							// The spinning will be resumed after that.
+							step.extract_n( 1u );
+
+						const auto r = so_5::receive( step, handlers... );
+						extracted += r.extracted();
+						handled += r.handled();
+
+						if( extraction_status_t::chain_closed == r.status() )
+							{
+								status = extraction_status_t::chain_closed;
+								break;
+							}
+
+						if( 0u != r.extracted() )
+							status = extraction_status_t::msg_extracted;
+						else if( !not_empty )
+							// There is no messages after empty_timeout.
+							break;
+					}
+
+				return mchain_receive_result_t{ extracted, handled, status };
+			}
+	};
+
+//
+// create_mchain
+//
+/*!
+ * \brief Helper function for creation of mchain with spin-then-park
+ * waiting.
+ *
+ * Usage example:
+ * \code
+	namespace spin_ns = so_5::extra::mchains::spin_wait;
+
+	spin_ns::waiter_t waiter{ spin_ns::strategy_t{}.spins(5000) };
+	auto ch = spin_ns::create_mchain(
+			env, waiter, so_5::make_unlimited_mchain_params() );
+	...
+	waiter.receive( so_5::from(ch).handle_n(1), ... );
+ * \endcode
+ *
+ * \since
+ * v.1.7.0
+ */
+[[nodiscard]] inline mchain_t
+create_mchain(
+	environment_t & env,
+	const waiter_t & waiter,
+	so_5::mchain_params_t params )
+	{
+		return env.create_mchain( waiter.tune( std::move(params) ) );
+	}
+
+} /* namespace spin_wait */
+
+} /* namespace mchains */
+
+} /* namespace extra */
+
+} /* namespace so_5 */
@@ -0,0 +1,200 @@
+/*!
+ * \file
+ * \brief Implementation of non-blocking request-reply interaction.
+ *
+ * \since
+ * v.1.7.0
+ */
+
+#pragma once
+
+#include <so_5_extra/sync/pub.hpp>
+
+#include <so_5_extra/async_op/time_limited.hpp>
+
+#include <so_5/details/rollback_on_exception.hpp>
+
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <type_traits>
+
+namespace so_5 {
+
+namespace extra {
+
+namespace sync {
+
+namespace details {
+
+//
+// async_ask_timeout_t
+//
+/*!
+ * \brief A signal to be used as timeout signal for async_ask.
+ *
+ * \since v.1.7.0
+ */
+struct async_ask_timeout_t final : public so_5::signal_t {};
+
+} /* namespace details */
+
+//
+// async_ask
+//
+/*!
+ * \brief Issue a request without blocking and handle the reply as
+ * an event of the agent.
+ *
+ * An instance of request_reply_t<Request, Reply> is sent to \a target.
+ * The reply is sent to a new direct mbox of \a owner. When the reply
+ * arrives the \a continuation is called as an event handler of \a owner
+ * in the \a state. If there is no reply for \a timeout then \a continuation
+ * is called with an empty optional.
+ *
+ * The \a continuation should be a callable with the following prototype:
+ * \code
+ * void(std::optional<Reply>)
+ * \endcode
+ *
+ * The continuation is called at most once. Late replies are ignored.
+ *
+ * The timeout is implemented by so_5::extra::async_op::time_limited.
+ * No thread is blocked during waiting for the reply. Because of that
+ * async_ask can be used by agents bound to any dispatcher (including
+ * thread pool dispatchers).
+ *
+ * Usage example:
+ * \code
+ * using check_user = so_5::extra::sync::request_reply_t<check_user_request, check_user_result>;
+ *
+ * class frontend final : public so_5::agent_t {
+ * 	...
+ * 	void on_login(mhood_t<login> cmd) {
+ * 		so_5::extra::sync::async_ask<check_user_request, check_user_result>(
+ * 				*this,
+ * 				so_default_state(),
+ * 				users_service_mbox_,
+ * 				5s,
+ * 				[this, user = cmd->m_user](std::optional<check_user_result> r) {
+ * 					if(r) ... // Handle the result.
+ * 					else ... // There is no reply.
+ * 				},
+ * 				// Arguments for check_user_request's constructor.
+ * 				cmd->m_user, cmd->m_password );
+ * 	}
+ * };
+ * \endcode
+ *
+ * \attention
+ * This function should be called from an event handler of \a owner
+ * (or from so_define_agent()/so_evt_start()) because it makes
+ * subscriptions for \a owner.
+ *
+ * \note
+ * If the request is destroyed without a reply then the continuation
+ * will be called on timeout only.
+ *
+ * \return cancellation_point for the operation. It can be used to cancel
+ * the waiting for the reply. The continuation won't be called in that case.
+ *
+ * \since v.1.7.0
+ */
+template<
+	typename Request, typename Reply,
+	typename Target, typename Continuation, typename... Args >
+so_5::extra::async_op::time_limited::cancellation_point_t<>
+async_ask(
+	//! The agent that will receive the reply.
+	agent_t & owner,
+	//! The state in that the reply should be handled.
+	const state_t & state,
+	//! The destination for the request.
+	const Target & target,
+	//! Max time to wait for the reply.
+	std::chrono::steady_clock::duration timeout,
+	//! A handler for the reply.
+	Continuation && continuation,
+	//! Arguments for the construction of Request.
+	Args && ...args )
+	{
+		using request_reply_type = request_reply_t< Request, Reply >;
+		using reply_t = typename request_reply_type::reply_t;
+		using continuation_t = std::decay_t< Continuation >;
+
+		// The continuation is shared between the completion handler
+		// and the timeout handler.
+		auto cont = std::make_shared< continuation_t >(
+				std::forward< Continuation >( continuation ) );
+
+		const auto reply_mbox = owner.so_make_new_direct_mbox();
+
+		auto cp = so_5::extra::async_op::time_limited::make<
+						details::async_ask_timeout_t >( owner )
+				.completed_on( reply_mbox, state,
+					[cont]( typename request_reply_type::reply_mhood_t cmd ) {
+						if constexpr( std::is_move_constructible_v< reply_t > )
+							(*cont)( std::optional< reply_t >( std::move(*cmd) ) );
+						else
+							(*cont)( std::optional< reply_t >( *cmd ) );
+					} )
+				.timeout_handler( state,
+					[cont]( mhood_t< details::async_ask_timeout_t > ) {
+						(*cont)( std::optional< reply_t >{} );
+					} )
+				.activate( timeout );
+
+		so_5::details::do_with_rollback_on_exception(
+				[&] {
+					request_reply_type::initiate_with_custom_reply_to(
+							target,
+							reply_mbox,
+							std::forward< Args >( args )... );
+				},
+				[&cp] { cp.cancel(); } );
+
+		return cp;
+	}
+
+//
+// async_ask
+//
+/*!
+ * \brief Issue a request without blocking and handle the reply as
+ * an event of the agent in the default state.
+ *
+ * The same as async_ask(owner, owner.so_default_state(), target, ...).
+ *
+ * \since v.1.7.0
+ */
+template<
+	typename Request, typename Reply,
+	typename Target, typename Continuation, typename... Args >
+so_5::extra::async_op::time_limited::cancellation_point_t<>
+async_ask(
+	//! The agent that will receive the reply.
+	agent_t & owner,
+	//! The destination for the request.
+	const Target & target,
+	//! Max time to wait for the reply.
+	std::chrono::steady_clock::duration timeout,
+	//! A handler for the reply.
+	Continuation && continuation,
+	//! Arguments for the construction of Request.
+	Args && ...args )
+	{
+		return async_ask< Request, Reply >(
+				owner,
+				owner.so_default_state(),
+				target,
+				timeout,
+				std::forward< Continuation >( continuation ),
+				std::forward< Args >( args )... );
+	}
+
+} /* namespace sync */
+
+} /* namespace extra */
+
+} /* namespace so_5 */
+
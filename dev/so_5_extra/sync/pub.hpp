@@ -20,8 +20,18 @@
 #include <so_5/send_functions.hpp>
 
 #include <so_5/details/always_false.hpp>
-
+#include <so_5/details/rollback_on_exception.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <typeindex>
+#include <utility>
 #include <variant>
+#include <vector>
 
 namespace so_5 {
 
@@ -89,6 +99,355 @@ template< typename T >
 using ensure_no_mutability_modificators_t =
 	typename ensure_no_mutability_modificators<T>::type;
 
+//
+// basic_reply_slot_t
+//
+/*!
+ * \brief The basic part of a single-shot storage for the reply.
+ *
+ * The state of a slot is an atomic variable. The waiting side checks
+ * that variable first and blocks on the condition variable only if the
+ * reply isn't ready yet. The replying side touches the mutex only if
+ * there is a blocked waiter.
+ *
+ * \since v.1.7.0
+ */
+class basic_reply_slot_t
+	{
+	protected :
+		//! State of the slot.
+		enum class state_t : unsigned char
+			{
+				//! There is no reply yet.
+				empty,
+				//! The reply is stored in the slot.
+				ready,
+				//! The request has been destroyed without a reply.
+				abandoned
+			};
+
+		//! The current state.
+		std::atomic< state_t > m_state{ state_t::empty };
+
+	private :
+		//! Is there a blocked waiter?
+		std::atomic< bool > m_waiting{ false };
+
+		//! Lock for the condition variable.
+		std::mutex m_lock;
+		//! Condition variable for the blocked waiter.
+		std::condition_variable m_wakeup;
+
+	protected :
+		//! Change the state and wake up the waiter if it exists.
+		void
+		set_state( state_t new_state ) noexcept
+			{
+				// NOTE: seq_cst order is used for both m_state and
+				// m_waiting. So either the waiter sees the new state or
+				// we see that the waiter is going to sleep.
+				m_state.store( new_state );
+				if( m_waiting.load() )
+					{
+						std::lock_guard< std::mutex > lock{ m_lock };
+						m_wakeup.notify_one();
+					}
+			}
+
+	public :
+		basic_reply_slot_t() = default;
+		basic_reply_slot_t( const basic_reply_slot_t & ) = delete;
+		basic_reply_slot_t & operator=( const basic_reply_slot_t & ) = delete;
+
+		virtual ~basic_reply_slot_t() noexcept = default;
+
+		//! Inform the waiter that there won't be a reply.
+		void
+		abandon() noexcept
+			{
+				set_state( state_t::abandoned );
+			}
+
+		//! Is the slot filled by the reply or abandoned?
+		/*!
+		 * If it's true then the request doesn't use the slot anymore
+		 * and the slot can be reset for a new request.
+		 */
+		[[nodiscard]]
+		bool
+		is_finished() const noexcept
+			{
+				return state_t::empty != m_state.load();
+			}
+
+		//! Prepare the slot for a new request.
+		/*!
+		 * \attention
+		 * Should be called only if is_finished() returned true.
+		 */
+		virtual void
+		reset() noexcept
+			{
+				m_waiting.store( false );
+				m_state.store( state_t::empty );
+			}
+
+		//! Wait for the reply or the abandonment.
+		/*!
+		 * \return true if the reply is stored in the slot.
+		 */
+		template< typename Duration >
+		[[nodiscard]]
+		bool
+		wait_for( Duration duration )
+			{
+				if( state_t::empty == m_state.load() )
+					{
+						m_waiting.store( true );
+
+						std::unique_lock< std::mutex > lock{ m_lock };
+						m_wakeup.wait_for( lock, duration, [this] {
+								return state_t::empty != m_state.load();
+							} );
+					}
+
+				return state_t::ready == m_state.load();
+			}
+	};
+
+//
+// reply_slot_t
+//
+/*!
+ * \brief A single-shot storage for the reply of type Reply.
+ *
+ * The reply is stored inside the slot, there is no additional allocation
+ * for it.
+ *
+ * \since v.1.7.0
+ */
+template< typename Reply >
+class reply_slot_t final : public basic_reply_slot_t
+	{
+		//! The storage for the reply.
+		std::optional< Reply > m_reply;
+
+	public :
+		//! Construct the reply and wake up the waiter.
+		/*!
+		 * \attention
+		 * Should be called at most once.
+		 */
+		template< typename... Args >
+		void
+		emplace( Args && ...args )
+			{
+				m_reply.emplace( std::forward<Args>(args)... );
+				set_state( state_t::ready );
+			}
+
+		//! Get the reply.
+		/*!
+		 * \attention
+		 * Should be called only if wait_for() returned true.
+		 */
+		[[nodiscard]]
+		Reply &
+		reply() noexcept { return *m_reply; }
+
+		void
+		reset() noexcept override
+			{
+				m_reply.reset();
+				basic_reply_slot_t::reset();
+			}
+	};
+
+//
+// reply_slot_shptr_t
+//
+/*!
+ * \brief Type of pointer to a reply slot.
+ *
+ * The slot is shared between the waiting side and request_reply_t instance.
+ *
+ * \since v.1.7.0
+ */
+using reply_slot_shptr_t = std::shared_ptr< basic_reply_slot_t >;
+
+//
+// basic_gather_slot_t
+//
+/*!
+ * \brief The basic part of a storage for replies from several requests.
+ *
+ * Every request sent to a gather slot is finished either by a reply or
+ * by abandonment (when the request is destroyed without a reply).
+ * The waiting is finished when the required count of replies is received
+ * or when all requests are finished.
+ *
+ * When the waiting is finished the slot is revoked. Late replies for
+ * a revoked slot are discarded even without construction of the reply
+ * object.
+ *
+ * \since v.1.7.0
+ */
+class basic_gather_slot_t
+	{
+	protected :
+		//! Lock for the slot.
+		std::mutex m_lock;
+		//! Condition variable for the waiter.
+		std::condition_variable m_wakeup;
+
+		//! Count of requests that are not finished yet.
+		std::size_t m_pending;
+		//! Count of replies necessary to finish the waiting.
+		const std::size_t m_required;
+		//! Count of received replies.
+		std::size_t m_received{ 0u };
+
+		//! Is the waiting finished?
+		std::atomic< bool > m_revoked{ false };
+
+		//! Can the waiting be finished?
+		/*!
+		 * \attention
+		 * Should be called when m_lock is acquired.
+		 */
+		[[nodiscard]]
+		bool
+		is_completed() const noexcept
+			{
+				return m_received >= m_required || 0u == m_pending;
+			}
+
+		//! Count a finished request and wake up the waiter if necessary.
+		/*!
+		 * \attention
+		 * Should be called when m_lock is acquired.
+		 */
+		void
+		request_finished( bool with_reply ) noexcept
+			{
+				--m_pending;
+				if( with_reply )
+					++m_received;
+				if( is_completed() )
+					m_wakeup.notify_one();
+			}
+
+	public :
+		basic_gather_slot_t(
+			//! Count of requests to be sent.
+			std::size_t pending,
+			//! Count of replies necessary to finish the waiting.
+			std::size_t required )
+			:	m_pending{ pending }
+			,	m_required{ required }
+			{}
+
+		basic_gather_slot_t( const basic_gather_slot_t & ) = delete;
+		basic_gather_slot_t & operator=( const basic_gather_slot_t & ) = delete;
+
+		virtual ~basic_gather_slot_t() noexcept = default;
+
+		//! Inform the slot that one of requests won't be replied.
+		void
+		abandon() noexcept
+			{
+				std::lock_guard< std::mutex > lock{ m_lock };
+				request_finished( false );
+			}
+
+		//! Is the waiting already finished?
+		[[nodiscard]]
+		bool
+		is_revoked() const noexcept
+			{
+				return m_revoked.load( std::memory_order_acquire );
+			}
+
+		//! Finish the waiting and discard all late replies.
+		void
+		revoke() noexcept
+			{
+				m_revoked.store( true, std::memory_order_release );
+			}
+
+		//! Wait until the waiting can be finished or the timeout elapsed.
+		/*!
+		 * The slot is revoked after the return.
+		 */
+		template< typename Duration >
+		void
+		wait_for( Duration duration )
+			{
+				std::unique_lock< std::mutex > lock{ m_lock };
+				m_wakeup.wait_for( lock, duration, [this] {
+						return is_completed();
+					} );
+				revoke();
+			}
+	};
+
+//
+// gather_slot_t
+//
+/*!
+ * \brief A storage for replies of type Reply from several requests.
+ *
+ * \since v.1.7.0
+ */
+template< typename Reply >
+class gather_slot_t final : public basic_gather_slot_t
+	{
+		//! Received replies in the order of arrival.
+		std::vector< Reply > m_replies;
+
+	public :
+		using basic_gather_slot_t::basic_gather_slot_t;
+
+		//! Construct a new reply.
+		/*!
+		 * The reply is discarded if the slot is revoked.
+		 */
+		template< typename... Args >
+		void
+		emplace( Args && ...args )
+			{
+				std::lock_guard< std::mutex > lock{ m_lock };
+				if( is_revoked() )
+					return;
+
+				m_replies.emplace_back( std::forward<Args>(args)... );
+				request_finished( true );
+			}
+
+		//! Get all received replies.
+		/*!
+		 * The slot is revoked after the call.
+		 */
+		[[nodiscard]]
+		std::vector< Reply >
+		take()
+			{
+				std::lock_guard< std::mutex > lock{ m_lock };
+				revoke();
+				return std::move( m_replies );
+			}
+	};
+
+//
+// gather_slot_shptr_t
+//
+/*!
+ * \brief Type of pointer to a gather slot.
+ *
+ * \since v.1.7.0
+ */
+using gather_slot_shptr_t = std::shared_ptr< basic_gather_slot_t >;
+
 //
 // reply_target_t
 //
@@ -99,8 +458,15 @@ using ensure_no_mutability_modificators_t =
  * a target then it should be closed.
  *
  * This type allow to distinguish between mchain and mbox cases.
+ *
+ * Since v.1.7.0 a reply can also be stored directly into a reply slot
+ * or into a gather slot.
  */
-using reply_target_t = std::variant< mchain_t, mbox_t >;
+using reply_target_t = std::variant<
+		mchain_t,
+		mbox_t,
+		reply_slot_shptr_t,
+		gather_slot_shptr_t >;
 
 //
 // reply_target_holder_t
@@ -120,6 +486,12 @@ class reply_target_holder_t final
 		//! The target for the reply message.
 		reply_target_t m_target;
 
+		//! The flag for detection of repeated replies.
+		/*!
+		 * Recives `true` when the first reply is sent.
+		 */
+		bool m_reply_sent{ false };
+
 	public :
 		reply_target_holder_t( reply_target_t target ) noexcept
 			:	m_target{ std::move(target) }
@@ -128,6 +500,8 @@ class reply_target_holder_t final
 		~reply_target_holder_t() noexcept
 			{
 				struct closer_t final {
+					bool m_reply_sent;
+
 					void operator()( const mchain_t & ch ) const noexcept {
 						// Close the reply chain.
 						// If there is no reply but someone is waiting
@@ -140,9 +514,20 @@ class reply_target_holder_t final
 					void operator()( const mbox_t & ) const noexcept {
 						// Nothing to do.
 					}
+					void operator()(
+						const reply_slot_shptr_t & slot ) const noexcept {
+						// The waiting side should be awakened if there is no reply.
+						if( !m_reply_sent )
+							slot->abandon();
+					}
+					void operator()(
+						const gather_slot_shptr_t & slot ) const noexcept {
+						if( !m_reply_sent )
+							slot->abandon();
+					}
 				};
 
-				std::visit( closer_t{}, m_target );
+				std::visit( closer_t{ m_reply_sent }, m_target );
 			}
 
 		reply_target_holder_t( const reply_target_holder_t & ) = delete;
@@ -151,6 +536,14 @@ class reply_target_holder_t final
 		//! Getter.
 		const auto &
 		target() const noexcept { return m_target; }
+
+		//! Has the reply been sent?
+		bool
+		reply_sent() const noexcept { return m_reply_sent; }
+
+		//! Mark the reply as sent.
+		void
+		mark_reply_sent() noexcept { m_reply_sent = true; }
 	};
 
 //
@@ -173,6 +566,15 @@ query_actual_reply_target( const reply_target_t & rt ) noexcept
 			mbox_t operator()( const mbox_t & mbox ) const noexcept {
 				return mbox;
 			}
+			mbox_t operator()( const reply_slot_shptr_t & ) const noexcept {
+				// A reply slot has no mbox, the reply is stored
+				// into the slot directly.
+				return {};
+			}
+			mbox_t operator()( const gather_slot_shptr_t & ) const noexcept {
+				// A gather slot has no mbox too.
+				return {};
+			}
 		};
 
 		return std::visit( extractor_t{}, rt );
@@ -208,12 +610,10 @@ class basic_request_reply_part_t : public so_5::message_t
 				"Reply type should be MoveAssignable or CopyAssignable" );
 
 		//! The target for the reply.
-		reply_target_holder_t m_reply_target;
-		//! The flag for detection of repeated replies.
 		/*!
-		 * Recives `true` when the first reply is sent.
+		 * It also holds the flag for detection of repeated replies.
 		 */
-		bool m_reply_sent{ false };
+		reply_target_holder_t m_reply_target;
 
 		//! Initializing constructor.
 		basic_request_reply_part_t( reply_target_t reply_target ) noexcept
@@ -358,6 +758,112 @@ constexpr const close_reply_chain_flag_t close_reply_chain =
 constexpr const close_reply_chain_flag_t do_not_close_reply_chain =
 		close_reply_chain_flag_t::do_not_close;
 
+//
+// reply_slot_cache_t
+//
+/*!
+ * \brief A cache of reply slots to be reused by several requests.
+ *
+ * By default every call to request_reply_t::ask_value() and
+ * request_reply_t::ask_opt_value() allocates a new reply slot. An instance
+ * of reply_slot_cache_t can be passed to ask_value() and ask_opt_value()
+ * to avoid that allocation if synchronous requests are issued at high
+ * rate. A reply slot will be taken from the cache and will be returned
+ * back after receiving the reply.
+ *
+ * A reply slot is returned to the cache only if the request has finished
+ * with it: the reply has been stored or the request has been destroyed
+ * without a reply. If the waiting for the reply is finished by timeout
+ * then the reply slot is thrown away. It means that a late reply for
+ * a timed out request can't be received as a reply for the next request.
+ *
+ * One cache can be used for requests with different types of replies.
+ *
+ * Usage example:
+ * \code
+ * using check_user = so_5::extra::sync::request_reply_t<check_user_request, check_user_result>;
+ *
+ * // Should be used by one thread only.
+ * so_5::extra::sync::reply_slot_cache_t cache;
+ * for(const auto & u : users) {
+ * 	auto result = check_user::ask_value(cache, target, 10s, u);
+ * 	...
+ * }
+ * \endcode
+ *
+ * \attention
+ * This class is not thread safe. An instance of reply_slot_cache_t
+ * should be used by one thread only (for example, it can be a member of
+ * an object that is owned by a worker thread).
+ *
+ * \since v.1.7.0
+ */
+class reply_slot_cache_t final
+	{
+		//! Max count of slots to be kept in the cache.
+		const std::size_t m_max_size;
+
+		//! Slots to be reused with the types of their replies.
+		std::vector< std::pair< std::type_index, details::reply_slot_shptr_t > >
+				m_slots;
+
+	public :
+		explicit reply_slot_cache_t(
+			//! Max count of slots to be kept in the cache.
+			//! More than one slot is necessary only for nested requests
+			//! or for different types of replies.
+			std::size_t max_size = 4u )
+			:	m_max_size{ max_size }
+			{}
+
+		reply_slot_cache_t( const reply_slot_cache_t & ) = delete;
+		reply_slot_cache_t & operator=( const reply_slot_cache_t & ) = delete;
+
+		//! Get an empty reply slot from the cache or create a new one.
+		template< typename Reply >
+		[[nodiscard]]
+		std::shared_ptr< details::reply_slot_t< Reply > >
+		acquire()
+			{
+				const std::type_index reply_type{ typeid(Reply) };
+				for( auto it = m_slots.rbegin(); it != m_slots.rend(); ++it )
+					if( reply_type == it->first )
+						{
+							auto slot = std::static_pointer_cast<
+									details::reply_slot_t< Reply > >(
+											std::move(it->second) );
+							m_slots.erase( std::next(it).base() );
+							return slot;
+						}
+
+				return std::make_shared< details::reply_slot_t< Reply > >();
+			}
+
+		//! Return a reply slot to the cache.
+		/*!
+		 * The slot is reset before it is stored in the cache.
+		 *
+		 * \attention
+		 * The request should have finished with the slot
+		 * (see details::basic_reply_slot_t::is_finished()).
+		 */
+		template< typename Reply >
+		void
+		release( std::shared_ptr< details::reply_slot_t< Reply > > slot )
+			{
+				if( m_slots.size() < m_max_size )
+					{
+						slot->reset();
+						m_slots.emplace_back( typeid(Reply), std::move(slot) );
+					}
+			}
+
+		//! Count of slots in the cache.
+		[[nodiscard]]
+		std::size_t
+		size() const noexcept { return m_slots.size(); }
+	};
+
 //
 // request_reply_t
 //
@@ -532,10 +1038,12 @@ auto v2 = so_5::extra::sync::request_value<Q, so_5::mutable_msg<A>>(...);
 
 \par A custom destination for the reply message
 
-By default the reply message is sent to a separate mchain created inside
-request_value() and request_opt_value() functions (strictly speacking
-this mchain is created inside request_reply_t::initiate() function and
-then used by request_value() and request_opt_value() functions).
+By default the reply is stored into a single-shot reply slot created inside
+request_value() and request_opt_value() functions. The reply isn't sent as
+a message in that case: the reply object is constructed directly in the
+slot and the waiting thread is awakened. If request_reply_t::initiate() is
+used then the reply message is sent to a separate mchain created inside
+initiate() function.
 
 But sometimes it can be necessary to have an ability to specify a custom
 destination for the reply message. It can be done via
@@ -686,72 +1194,6 @@ class request_reply_t final
 					result = *cmd;
 			}
 
-		//! An actual implementation of ask_value for the case when
-		//! reply object is DefaultConstructible.
-		template<typename Target, typename Duration, typename... Args>
-		[[nodiscard]]
-		static auto
-		ask_default_constructible_value(
-			Target && target,
-			Duration duration,
-			Args && ...args )
-			{
-				// Because reply object is default constructible we can create it
-				// on the stack. And this can be the subject of NRVO.
-				reply_t result;
-
-				auto reply_ch = initiate(
-						std::forward<Target>(target),
-						std::forward<Args>(args)... );
-
-				bool result_received{false};
-				receive(
-						from(reply_ch).handle_n(1).empty_timeout(duration),
-						[&result, &result_received]( reply_mhood_t cmd ) {
-							result_received = true;
-							borrow_from_reply_mhood( cmd, result );
-						} );
-
-				if( !result_received )
-					{
-						SO_5_THROW_EXCEPTION( errors::rc_no_reply,
-								std::string{ "no reply received, request_reply type: " } +
-								typeid(request_reply_t).name() );
-					}
-
-				return result;
-			}
-
-		//! An actual implementation of request_value for the case when
-		//! reply object is not DefaultConstructible.
-		template<typename Target, typename Duration, typename... Args>
-		[[nodiscard]]
-		static auto
-		ask_not_default_constructible_value(
-			Target && target,
-			Duration duration,
-			Args && ...args )
-			{
-				// For the case when Reply is not default constructible we
-				// will use request_opt_value that can handle then case.
-				auto result = ask_opt_value(
-						std::forward<Target>(target),
-						duration,
-						std::forward<Args>(args)... );
-
-				if( !result )
-					{
-						SO_5_THROW_EXCEPTION( errors::rc_no_reply,
-								std::string{ "no reply received, request_reply type: " } +
-								typeid(request_reply_t).name() );
-					}
-
-				if constexpr( is_reply_moveable )
-					return std::move(*result);
-				else
-					return *result;
-			}
-
 	public :
 		/*!
 		 * \brief Initiate a request by sending request_reply_t message instance.
@@ -955,18 +1397,36 @@ class request_reply_t final
 		void
 		make_reply( Args && ...args )
 			{
-				if( this->m_reply_sent )
+				if( this->m_reply_target.reply_sent() )
 					SO_5_THROW_EXCEPTION( errors::rc_reply_was_sent,
 							std::string{ "reply has already been sent, "
 									"request_reply type: " } +
 							typeid(request_reply_t).name() );
 
-				so_5::send< so_5::mutable_msg<reply_t> >(
-						details::query_actual_reply_target(
-								this->m_reply_target.target() ),
-						std::forward<Args>(args)... );
+				if( const auto * slot = std::get_if< details::reply_slot_shptr_t >(
+						&(this->m_reply_target.target()) ) )
+					{
+						// The waiting side is waiting on the reply slot.
+						static_cast< details::reply_slot_t< reply_t > & >( **slot )
+								.emplace( std::forward<Args>(args)... );
+					}
+				else if( const auto * gather =
+						std::get_if< details::gather_slot_shptr_t >(
+								&(this->m_reply_target.target()) ) )
+					{
+						// A late reply is discarded without construction of
+						// the reply object.
+						if( !(*gather)->is_revoked() )
+							static_cast< details::gather_slot_t< reply_t > & >( **gather )
+									.emplace( std::forward<Args>(args)... );
+					}
+				else
+					so_5::send< so_5::mutable_msg<reply_t> >(
+							details::query_actual_reply_target(
+									this->m_reply_target.target() ),
+							std::forward<Args>(args)... );
 
-				this->m_reply_sent = true;
+				this->m_reply_target.mark_reply_sent();
 			}
 
 		/*!
@@ -1015,16 +1475,27 @@ class request_reply_t final
 			Duration duration,
 			Args && ...args )
 			{
-				auto reply_ch = initiate(
-						std::forward<Target>(target),
-						std::forward<Args>(args)... );
+				// The reply will be stored directly into the slot.
+				auto slot = std::make_shared< details::reply_slot_t< reply_t > >();
+
+				msg_holder_t msg{
+					// Calling 'new' directly because request_reply_t has
+					// private constructor.
+					new request_reply_t{
+							details::reply_slot_shptr_t{ slot },
+							std::forward<Args>(args)... }
+				};
+
+				send( std::forward<Target>(target), std::move(msg) );
 
 				optional<reply_t> result;
-				receive(
-						from(reply_ch).handle_n(1).empty_timeout(duration),
-						[&result]( reply_mhood_t cmd ) {
-							borrow_from_reply_mhood( cmd, result );
-						} );
+				if( slot->wait_for( duration ) )
+					{
+						if constexpr( is_reply_moveable )
+							result.emplace( std::move( slot->reply() ) );
+						else
+							result.emplace( slot->reply() );
+					}
 
 				return result;
 			}
@@ -1072,16 +1543,262 @@ class request_reply_t final
 			Duration duration,
 			Args && ...args )
 			{
-				if constexpr( std::is_default_constructible_v<reply_t> )
-					return ask_default_constructible_value(
-							std::forward<Target>(target),
-							duration,
-							std::forward<Args>(args)... );
+				auto result = ask_opt_value(
+						std::forward<Target>(target),
+						duration,
+						std::forward<Args>(args)... );
+
+				if( !result )
+					{
+						SO_5_THROW_EXCEPTION( errors::rc_no_reply,
+								std::string{ "no reply received, request_reply type: " } +
+								typeid(request_reply_t).name() );
+					}
+
+				if constexpr( is_reply_moveable )
+					return std::move(*result);
 				else
-					return ask_not_default_constructible_value(
-							std::forward<Target>(target),
-							duration,
-							std::forward<Args>(args)... );
+					return *result;
+			}
+
+		/*!
+		 * \brief Send a request and wait for the reply using a reply slot
+		 * from the cache.
+		 *
+		 * The same as ask_opt_value(target, duration, args...), but the reply
+		 * slot is taken from \a cache and is returned back if it can be
+		 * reused.
+		 *
+		 * Usage example:
+		 * \code
+		 * so_5::extra::sync::reply_slot_cache_t cache;
+		 * ...
+		 * std::optional<check_user_result> result = check_user::ask_opt_value(
+		 * 		cache,
+		 * 		target,
+		 * 		10s,
+		 * 		... );
+		 * \endcode
+		 *
+		 * \since v.1.7.0
+		 */
+		template<typename Target, typename Duration, typename... Args>
+		[[nodiscard]]
+		static auto
+		ask_opt_value(
+			reply_slot_cache_t & cache,
+			Target && target,
+			Duration duration,
+			Args && ...args )
+			{
+				auto slot = cache.acquire< reply_t >();
+
+				msg_holder_t msg{
+					// Calling 'new' directly because request_reply_t has
+					// private constructor.
+					new request_reply_t{
+							details::reply_slot_shptr_t{ slot },
+							std::forward<Args>(args)... }
+				};
+
+				send( std::forward<Target>(target), std::move(msg) );
+
+				optional<reply_t> result;
+				if( slot->wait_for( duration ) )
+					{
+						if constexpr( is_reply_moveable )
+							result.emplace( std::move( slot->reply() ) );
+						else
+							result.emplace( slot->reply() );
+					}
+
+				// If there is no reply yet then the reply can be stored into
+				// the slot later. Because of that the slot can be reused
+				// only if the request has finished with it.
+				if( slot->is_finished() )
+					cache.release( std::move(slot) );
+
+				return result;
+			}
+
+		/*!
+		 * \brief Send a request and wait for the reply using a reply slot
+		 * from the cache.
+		 *
+		 * The same as ask_value(target, duration, args...), but the reply
+		 * slot is taken from \a cache and is returned back if it can be
+		 * reused.
+		 *
+		 * \since v.1.7.0
+		 */
+		template<typename Target, typename Duration, typename... Args>
+		[[nodiscard]]
+		static auto
+		ask_value(
+			reply_slot_cache_t & cache,
+			Target && target,
+			Duration duration,
+			Args && ...args )
+			{
+				auto result = ask_opt_value(
+						cache,
+						std::forward<Target>(target),
+						duration,
+						std::forward<Args>(args)... );
+
+				if( !result )
+					{
+						SO_5_THROW_EXCEPTION( errors::rc_no_reply,
+								std::string{ "no reply received, request_reply type: " } +
+								typeid(request_reply_t).name() );
+					}
+
+				if constexpr( is_reply_moveable )
+					return std::move(*result);
+				else
+					return *result;
+			}
+
+		/*!
+		 * \brief Send the same request to several targets and wait for
+		 * the first reply.
+		 *
+		 * A separate instance of request_reply_t is sent to every target
+		 * from \a targets. Every instance is constructed from copies of
+		 * \a args. The first reply is returned, all other replies are
+		 * discarded. This is a kind of request hedging: the latency of
+		 * the request is the latency of the fastest replica.
+		 *
+		 * An empty std::optional is returned if there is no reply for
+		 * \a duration or if all requests are destroyed without a reply.
+		 *
+		 * Usage example:
+		 * \code
+		 * const std::vector<so_5::mbox_t> replicas{ ... };
+		 * std::optional<check_user_result> result =
+		 * 		check_user::ask_first_opt_value( replicas, 100ms, user, password );
+		 * \endcode
+		 *
+		 * \note
+		 * Late replies are discarded without construction of a reply object.
+		 *
+		 * \note
+		 * \a targets should be listed explicitly. A broadcasting mbox can't
+		 * be used as a target because request_reply_t is a mutable message.
+		 *
+		 * \since v.1.7.0
+		 */
+		template<typename Targets, typename Duration, typename... Args>
+		[[nodiscard]]
+		static auto
+		ask_first_opt_value(
+			const Targets & targets,
+			Duration duration,
+			const Args & ...args )
+			{
+				auto replies = gather_values( targets, 1u, duration, args... );
+
+				optional<reply_t> result;
+				if( !replies.empty() )
+					{
+						if constexpr( is_reply_moveable )
+							result.emplace( std::move( replies.front() ) );
+						else
+							result.emplace( replies.front() );
+					}
+
+				return result;
+			}
+
+		/*!
+		 * \brief Send the same request to several targets and collect
+		 * replies.
+		 *
+		 * A separate instance of request_reply_t is sent to every target
+		 * from \a targets. Every instance is constructed from copies of
+		 * \a args. This method waits until all requests are replied
+		 * (or destroyed without a reply), but no more than \a duration.
+		 *
+		 * Returns replies received before the deadline in the order of
+		 * arrival. Late replies are discarded without construction of
+		 * a reply object.
+		 *
+		 * Usage example:
+		 * \code
+		 * struct shard_stats_request final : public so_5::signal_t {};
+		 * using shard_stats = so_5::extra::sync::request_reply_t<shard_stats_request, stats>;
+		 * ...
+		 * std::vector<stats> all = shard_stats::ask_all_values( shards, 50ms );
+		 * \endcode
+		 *
+		 * \since v.1.7.0
+		 */
+		template<typename Targets, typename Duration, typename... Args>
+		[[nodiscard]]
+		static std::vector< reply_t >
+		ask_all_values(
+			const Targets & targets,
+			Duration duration,
+			const Args & ...args )
+			{
+				using std::begin;
+				using std::end;
+
+				return gather_values(
+						targets,
+						static_cast< std::size_t >(
+								std::distance( begin(targets), end(targets) ) ),
+						duration,
+						args... );
+			}
+
+	private :
+		//! Send requests to all targets and wait for \a required replies.
+		/*!
+		 * \since v.1.7.0
+		 */
+		template<typename Targets, typename Duration, typename... Args>
+		[[nodiscard]]
+		static std::vector< reply_t >
+		gather_values(
+			const Targets & targets,
+			std::size_t required,
+			Duration duration,
+			const Args & ...args )
+			{
+				using std::begin;
+				using std::end;
+
+				const auto count = static_cast< std::size_t >(
+						std::distance( begin(targets), end(targets) ) );
+				if( 0u == count )
+					return {};
+
+				auto slot = std::make_shared< details::gather_slot_t< reply_t > >(
+						count, required );
+
+				so_5::details::do_with_rollback_on_exception(
+						[&] {
+							for( const auto & target : targets )
+								{
+									msg_holder_t msg{
+										// Calling 'new' directly because request_reply_t
+										// has private constructor.
+										new request_reply_t{
+												details::gather_slot_shptr_t{ slot },
+												args... }
+									};
+
+									send( target, std::move(msg) );
+								}
+						},
+						// Requests that are already sent shouldn't store
+						// their replies.
+						[&slot] { slot->revoke(); } );
+
+				slot->wait_for( duration );
+
+				return slot->take();
 			}
 	};
 
@@ -1190,6 +1907,138 @@ request_opt_reply(
 				std::forward<Args>(args)... );
 	}
 
+//
+// request_reply
+//
+/*!
+ * \brief A helper function for performing request_reply-iteraction
+ * with a reply slot from the cache.
+ *
+ * Usage example:
+ * \code
+ * so_5::extra::sync::reply_slot_cache_t cache;
+ * ...
+ * auto r = so_5::extra::sync::request_reply<my_request, my_reply>(
+ * 		cache,
+ * 		some_mchain,
+ * 		10s,
+ * 		...);
+ * \endcode
+ *
+ * Returns an instance of Reply object.
+ *
+ * \since v.1.7.0
+ */
+template<
+	typename Request, typename Reply,
+	typename Target, typename Duration, typename... Args>
+[[nodiscard]]
+auto
+request_reply(
+	reply_slot_cache_t & cache,
+	Target && target,
+	Duration duration,
+	Args && ...args )
+	{
+		return request_reply_t<Request, Reply>::ask_value(
+				cache,
+				std::forward<Target>(target),
+				duration,
+				std::forward<Args>(args)... );
+	}
+
+//
+// request_opt_reply
+//
+/*!
+ * \brief A helper function for performing request_reply-iteraction
+ * with a reply slot from the cache.
+ *
+ * Returns an instance of std::optional<Reply> object.
+ *
+ * \since v.1.7.0
+ */
+template<
+	typename Request, typename Reply,
+	typename Target, typename Duration, typename... Args>
+[[nodiscard]]
+auto
+request_opt_reply(
+	reply_slot_cache_t & cache,
+	Target && target,
+	Duration duration,
+	Args && ...args )
+	{
+		return request_reply_t<Request, Reply>::ask_opt_value(
+				cache,
+				std::forward<Target>(target),
+				duration,
+				std::forward<Args>(args)... );
+	}
+
+//
+// request_first_opt_reply
+//
+/*!
+ * \brief A helper function for sending the same request to several
+ * targets and waiting for the first reply.
+ *
+ * Usage example:
+ * \code
+ * std::optional<check_user_result> result =
+ * 	so_5::extra::sync::request_first_opt_reply<check_user_request, check_user_result>(
+ * 		replicas,
+ * 		100ms,
+ * 		...);
+ * \endcode
+ *
+ * Returns an instance of std::optional<Reply> object.
+ *
+ * \since v.1.7.0
+ */
+template<
+	typename Request, typename Reply,
+	typename Targets, typename Duration, typename... Args>
+[[nodiscard]]
+auto
+request_first_opt_reply(
+	const Targets & targets,
+	Duration duration,
+	const Args & ...args )
+	{
+		return request_reply_t<Request, Reply>::ask_first_opt_value(
+				targets,
+				duration,
+				args... );
+	}
+
+//
+// request_all_replies
+//
+/*!
+ * \brief A helper function for sending the same request to several
+ * targets and collecting replies received before the deadline.
+ *
+ * Returns an instance of std::vector<Reply> object.
+ *
+ * \since v.1.7.0
+ */
+template<
+	typename Request, typename Reply,
+	typename Targets, typename Duration, typename... Args>
+[[nodiscard]]
+auto
+request_all_replies(
+	const Targets & targets,
+	Duration duration,
+	const Args & ...args )
+	{
+		return request_reply_t<Request, Reply>::ask_all_values(
+				targets,
+				duration,
+				args... );
+	}
+
 } /* namespace sync */
 
 } /* namespace extra */
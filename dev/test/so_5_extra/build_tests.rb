@@ -21,4 +21,9 @@ MxxRu::Cpp::composite_target {
 	required_prj( "#{path}/revocable_timer/build_tests.rb" )
 
 	required_prj( "#{path}/enveloped_msg/build_tests.rb" )
+
+	# Coroutines require C++20.
+	if 'cpp20' == ENV.fetch( 'SO5EXTRA_CPP_STD', 'cpp17' )
+		required_prj( "#{path}/coroutines/build_tests.rb" )
+	end
 }
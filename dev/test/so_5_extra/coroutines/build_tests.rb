@@ -0,0 +1,9 @@
+#!/usr/bin/ruby
+require 'mxx_ru/cpp'
+
+MxxRu::Cpp::composite_target {
+	path = 'test/so_5_extra/coroutines'
+
+	required_prj( "#{path}/simple/prj.ut.rb" )
+	required_prj( "#{path}/simple/prj_s.ut.rb" )
+}
@@ -0,0 +1,161 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN 
+#include <doctest/doctest.h>
+
+#include <so_5_extra/coroutines/pub.hpp>
+
+#include <so_5/all.hpp>
+
+#include <test/3rd_party/various_helpers/time_limited_execution.hpp>
+
+namespace coro_ns = so_5::extra::coroutines;
+
+using namespace std::chrono_literals;
+
+struct ping final
+	{
+		int m_value;
+	};
+
+class service_t final : public so_5::agent_t
+	{
+	public :
+		service_t( context_t ctx ) : so_5::agent_t{ std::move(ctx) }
+			{
+				so_subscribe_self().event(
+					[]( so_5::extra::sync::request_mhood_t< int, int > cmd ) {
+						cmd->make_reply( cmd->request() * 2 );
+					} );
+			}
+	};
+
+class client_t final
+	:	public so_5::agent_t
+	,	public coro_ns::frame_pool_t
+	{
+		const so_5::mbox_t m_service;
+		std::vector< std::string > & m_trace;
+		std::thread::id m_thread_id;
+
+		void
+		check_thread()
+			{
+				REQUIRE( m_thread_id == std::this_thread::get_id() );
+			}
+
+		coro_ns::task_t
+		scenario()
+			{
+				auto r1 = co_await coro_ns::ask< int, int >(
+						*this, m_service, 5s, 21 );
+				check_thread();
+				m_trace.push_back( r1 ? std::to_string( *r1 ) : "<none>" );
+
+				// Nobody handles that request.
+				auto r2 = co_await coro_ns::ask< int, int >(
+						*this, so_environment().create_mbox(), 50ms, 1 );
+				check_thread();
+				m_trace.push_back( r2 ? std::to_string( *r2 ) : "<none>" );
+
+				// The message will be handled after the suspension.
+				so_5::send< ping >( *this, 3 );
+				auto r3 = co_await coro_ns::receive< ping >(
+						*this, so_default_state(), so_direct_mbox(), 5s );
+				check_thread();
+				m_trace.push_back( r3 ? std::to_string( (*r3)->m_value ) : "<none>" );
+
+				auto r4 = co_await coro_ns::receive< ping >(
+						*this, so_direct_mbox(), 50ms );
+				check_thread();
+				m_trace.push_back( r4 ? std::to_string( (*r4)->m_value ) : "<none>" );
+
+				so_deregister_agent_coop_normally();
+			}
+
+	public :
+		client_t(
+			context_t ctx,
+			so_5::mbox_t service,
+			std::vector< std::string > & trace )
+			:	so_5::agent_t{ std::move(ctx) }
+			,	m_service{ std::move(service) }
+			,	m_trace{ trace }
+			{}
+
+		void
+		so_evt_start() override
+			{
+				m_thread_id = std::this_thread::get_id();
+				coro_ns::start( scenario() );
+			}
+	};
+
+TEST_CASE( "ask and receive" )
+{
+	std::vector< std::string > trace;
+
+	run_with_time_limit( [&trace] {
+			so_5::launch( [&trace]( so_5::environment_t & env ) {
+					env.introduce_coop(
+							so_5::disp::active_obj::make_dispatcher( env ).binder(),
+							[&trace]( so_5::coop_t & coop ) {
+								auto svc = coop.make_agent< service_t >();
+								coop.make_agent< client_t >(
+										svc->so_direct_mbox(), trace );
+							} );
+				} );
+		},
+		5 );
+
+	REQUIRE( std::vector< std::string >{ "42", "<none>", "3", "<none>" } == trace );
+}
+
+class sleeper_t final
+	:	public so_5::agent_t
+	,	public coro_ns::frame_pool_t
+	{
+		struct guard_t
+			{
+				bool & m_destroyed;
+				~guard_t() { m_destroyed = true; }
+			};
+
+		bool & m_destroyed;
+
+		coro_ns::task_t
+		scenario()
+			{
+				guard_t guard{ m_destroyed };
+				// That coroutine will never be resumed.
+				co_await coro_ns::receive< ping >( *this, so_direct_mbox(), 1h );
+			}
+
+	public :
+		sleeper_t( context_t ctx, bool & destroyed )
+			:	so_5::agent_t{ std::move(ctx) }
+			,	m_destroyed{ destroyed }
+			{}
+
+		void
+		so_evt_start() override
+			{
+				coro_ns::start( scenario() );
+				so_deregister_agent_coop_normally();
+			}
+	};
+
+TEST_CASE( "suspended coroutine is destroyed with the agent" )
+{
+	bool destroyed = false;
+
+	run_with_time_limit( [&destroyed] {
+			so_5::launch( [&destroyed]( so_5::environment_t & env ) {
+					env.introduce_coop( [&destroyed]( so_5::coop_t & coop ) {
+							coop.make_agent< sleeper_t >( destroyed );
+						} );
+				} );
+		},
+		5 );
+
+	REQUIRE( destroyed );
+}
+
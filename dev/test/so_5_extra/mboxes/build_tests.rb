@@ -8,8 +8,11 @@ MxxRu::Cpp::composite_target {
 	required_prj( "#{path}/collecting_mbox/build_tests.rb" )
 	required_prj( "#{path}/retained_msg/build_tests.rb" )
 	required_prj( "#{path}/proxy/build_tests.rb" )
+	required_prj( "#{path}/metrics_proxy/build_tests.rb" )
+	required_prj( "#{path}/sampling_tracer/build_tests.rb" )
 	required_prj( "#{path}/broadcast/build_tests.rb" )
 	required_prj( "#{path}/first_last_subscriber_notification/build_tests.rb" )
 	required_prj( "#{path}/composite/build_tests.rb" )
 	required_prj( "#{path}/inflight_limit/build_tests.rb" )
+	required_prj( "#{path}/content_router/build_tests.rb" )
 }
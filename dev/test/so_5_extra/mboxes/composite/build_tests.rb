@@ -12,4 +12,7 @@ MxxRu::Cpp::composite_target {
 
 	required_prj( "#{path}/mbox_type/prj.ut.rb" )
 	required_prj( "#{path}/mbox_type/prj_s.ut.rb" )
+
+	required_prj( "#{path}/hot_swappable/prj.ut.rb" )
+	required_prj( "#{path}/hot_swappable/prj_s.ut.rb" )
 }
@@ -0,0 +1,259 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include <so_5_extra/mboxes/composite.hpp>
+#include <so_5_extra/mboxes/proxy.hpp>
+
+#include <so_5/all.hpp>
+
+#include <test/3rd_party/various_helpers/time_limited_execution.hpp>
+
+namespace composite_ns = so_5::extra::mboxes::composite;
+
+struct msg_data final : public so_5::message_t
+{};
+
+struct msg_unknown final : public so_5::message_t
+{};
+
+// Destination mbox that records subscriptions and its own destruction.
+class tracking_mbox_t final : public so_5::extra::mboxes::proxy::simple_t
+{
+	using base_type_t = so_5::extra::mboxes::proxy::simple_t;
+
+	const std::string m_name;
+	std::string & m_trace;
+
+public:
+	tracking_mbox_t(
+		so_5::mbox_t underlying,
+		std::string name,
+		std::string & trace )
+		:	base_type_t{ std::move(underlying) }
+		,	m_name{ std::move(name) }
+		,	m_trace{ trace }
+	{}
+
+	~tracking_mbox_t() override
+	{
+		m_trace += m_name + ".destroyed;";
+	}
+
+	void
+	subscribe_event_handler(
+		const std::type_index & msg_type,
+		so_5::abstract_message_sink_t & subscriber ) override
+	{
+		m_trace += m_name + ".sub;";
+		base_type_t::subscribe_event_handler( msg_type, subscriber );
+	}
+
+	void
+	unsubscribe_event_handler(
+		const std::type_index & msg_type,
+		so_5::abstract_message_sink_t & subscriber ) noexcept override
+	{
+		m_trace += m_name + ".unsub;";
+		base_type_t::unsubscribe_event_handler( msg_type, subscriber );
+	}
+};
+
+[[nodiscard]]
+so_5::mbox_t
+make_tracking_mbox(
+	so_5::environment_t & env,
+	std::string name,
+	std::string & trace )
+{
+	return so_5::mbox_t{ std::make_unique< tracking_mbox_t >(
+			env.create_mbox(), std::move(name), trace ) };
+}
+
+class test_agent final : public so_5::agent_t
+{
+	const so_5::mbox_t m_second_mbox;
+	composite_ns::hot_swappable_mbox_t m_router;
+
+	bool m_routes_replaced{ false };
+
+public:
+	test_agent( context_t ctx )
+		:	so_5::agent_t{ std::move(ctx) }
+		,	m_second_mbox{ so_make_new_direct_mbox() }
+		,	m_router{
+				composite_ns::multi_consumer_builder(
+						composite_ns::throw_if_not_found() )
+					.add< msg_data >( so_direct_mbox() )
+					.make_hot_swappable( so_environment() )
+			}
+	{}
+
+	void
+	so_define_agent() override
+	{
+		so_subscribe_self()
+			.event( [this]( mhood_t<msg_data> ) {
+					if( m_routes_replaced )
+						throw std::runtime_error{
+								"msg_data shouldn't go to the old destination" };
+
+					m_router.replace_routes(
+							composite_ns::multi_consumer_builder(
+									composite_ns::drop_if_not_found() )
+								.add< msg_data >( m_second_mbox ) );
+					m_routes_replaced = true;
+
+					// This message should be dropped by the new routes.
+					so_5::send< msg_unknown >( m_router.as_mbox() );
+
+					so_5::send< msg_data >( m_router.as_mbox() );
+				} )
+			.event( []( mhood_t<msg_unknown> ) {
+					throw std::runtime_error{
+							"msg_unknown shouldn't be delivered" };
+				} )
+			;
+
+		so_subscribe( m_second_mbox )
+			.event( [this]( mhood_t<msg_data> ) {
+					so_deregister_agent_coop_normally();
+				} )
+			;
+	}
+
+	void
+	so_evt_start() override
+	{
+		so_5::send< msg_data >( m_router.as_mbox() );
+	}
+};
+
+TEST_CASE( "replace routes" )
+{
+	run_with_time_limit( [] {
+			so_5::launch( [](so_5::environment_t & env) {
+						env.register_agent_as_coop(
+								env.make_agent< test_agent >() );
+					},
+					[](so_5::environment_params_t & params) {
+						params.message_delivery_tracer(
+								so_5::msg_tracing::std_cout_tracer() );
+					} );
+		},
+		5 );
+}
+
+TEST_CASE( "different mbox type for new routes" )
+{
+	bool exception_caught = false;
+
+	run_with_time_limit( [&exception_caught] {
+			so_5::launch( [&exception_caught](so_5::environment_t & env) {
+						auto router = composite_ns::multi_consumer_builder(
+								composite_ns::drop_if_not_found() )
+							.add< msg_data >( env.create_mbox() )
+							.make_hot_swappable( env );
+
+						try
+						{
+							router.replace_routes(
+									composite_ns::single_consumer_builder(
+											composite_ns::drop_if_not_found() )
+										.add< msg_data >( env.create_mbox() ) );
+						}
+						catch( const so_5::exception_t & x )
+						{
+							if( composite_ns::errors::rc_different_mbox_type_for_new_routes
+									== x.error_code() )
+								exception_caught = true;
+						}
+
+						env.stop();
+					} );
+		},
+		5 );
+
+	REQUIRE( exception_caught );
+}
+
+TEST_CASE( "old routes are destroyed" )
+{
+	std::string trace;
+
+	run_with_time_limit( [&trace] {
+			so_5::launch( [&trace](so_5::environment_t & env) {
+						auto router = composite_ns::multi_consumer_builder(
+								composite_ns::drop_if_not_found() )
+							.add< msg_data >( make_tracking_mbox( env, "old", trace ) )
+							.make_hot_swappable( env );
+
+						router.replace_routes(
+								composite_ns::multi_consumer_builder(
+										composite_ns::drop_if_not_found() )
+									.add< msg_data >(
+											make_tracking_mbox( env, "new", trace ) ) );
+						trace += "replaced;";
+
+						env.stop();
+					} );
+		},
+		5 );
+
+	REQUIRE( trace == "old.destroyed;replaced;new.destroyed;" );
+}
+
+class unsubscriber_t final : public so_5::agent_t
+{
+	std::string & m_trace;
+	composite_ns::hot_swappable_mbox_t m_router;
+
+public:
+	unsubscriber_t( context_t ctx, std::string & trace )
+		:	so_5::agent_t{ std::move(ctx) }
+		,	m_trace{ trace }
+		,	m_router{
+				composite_ns::multi_consumer_builder(
+						composite_ns::throw_if_not_found() )
+					.add< msg_data >(
+							make_tracking_mbox( so_environment(), "old", trace ) )
+					.make_hot_swappable( so_environment() )
+			}
+	{}
+
+	void
+	so_evt_start() override
+	{
+		so_subscribe( m_router.as_mbox() )
+			.event( []( mhood_t<msg_data> ) {} );
+
+		m_router.replace_routes(
+				composite_ns::multi_consumer_builder(
+						composite_ns::throw_if_not_found() )
+					.add< msg_data >(
+							make_tracking_mbox( so_environment(), "new", m_trace ) ) );
+		// The old destination is still used by the subscription.
+		m_trace += "replaced;";
+
+		// The subscription has to be removed from the old destination.
+		so_drop_subscription_for_all_states< msg_data >( m_router.as_mbox() );
+		m_trace += "unsubscribed;";
+
+		so_deregister_agent_coop_normally();
+	}
+};
+
+TEST_CASE( "subscription stays on the old destination" )
+{
+	std::string trace;
+
+	run_with_time_limit( [&trace] {
+			so_5::launch( [&trace](so_5::environment_t & env) {
+						env.register_agent_as_coop(
+								env.make_agent< unsubscriber_t >( trace ) );
+					} );
+		},
+		5 );
+
+	REQUIRE( trace == "old.sub;replaced;old.unsub;old.destroyed;"
+			"unsubscribed;new.destroyed;" );
+}
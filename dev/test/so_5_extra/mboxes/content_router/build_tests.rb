@@ -0,0 +1,12 @@
+#!/usr/bin/ruby
+require 'mxx_ru/cpp'
+
+MxxRu::Cpp::composite_target {
+	path = 'test/so_5_extra/mboxes/content_router'
+
+	required_prj( "#{path}/rules/prj.ut.rb" )
+	required_prj( "#{path}/rules/prj_s.ut.rb" )
+
+	required_prj( "#{path}/by_key/prj.ut.rb" )
+	required_prj( "#{path}/by_key/prj_s.ut.rb" )
+}
@@ -0,0 +1,102 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include <so_5_extra/mboxes/content_router.hpp>
+
+#include <so_5/all.hpp>
+
+#include <test/3rd_party/various_helpers/time_limited_execution.hpp>
+
+namespace router_ns = so_5::extra::mboxes::content_router;
+
+struct msg_quote final : public so_5::message_t
+{
+	int m_venue_id;
+
+	explicit msg_quote( int venue_id ) : m_venue_id{ venue_id }
+	{}
+};
+
+struct msg_finish final : public so_5::signal_t
+{};
+
+class test_agent final : public so_5::agent_t
+{
+	std::string & m_trace;
+
+	const so_5::mbox_t m_venue_0;
+	const so_5::mbox_t m_venue_2;
+	const so_5::mbox_t m_router;
+
+public:
+	test_agent( context_t ctx, std::string & trace )
+		:	so_5::agent_t{ std::move(ctx) }
+		,	m_trace{ trace }
+		,	m_venue_0{ so_make_new_direct_mbox() }
+		,	m_venue_2{ so_make_new_direct_mbox() }
+		,	m_router{
+				router_ns::single_consumer_builder(
+						router_ns::drop_if_no_destination() )
+					.add_by_key< so_5::mutable_msg< msg_quote > >(
+							[]( const msg_quote & m ) { return m.m_venue_id; },
+							{ m_venue_0, so_5::mbox_t{}, m_venue_2 } )
+					.make( so_environment() )
+			}
+	{}
+
+	void
+	so_define_agent() override
+	{
+		so_subscribe( m_venue_0 )
+			.event( [this]( mutable_mhood_t<msg_quote> cmd ) {
+					m_trace += "v0:" + std::to_string( cmd->m_venue_id ) + ";";
+				} )
+			;
+
+		so_subscribe( m_venue_2 )
+			.event( [this]( mutable_mhood_t<msg_quote> cmd ) {
+					m_trace += "v2:" + std::to_string( cmd->m_venue_id ) + ";";
+				} )
+			;
+
+		so_subscribe_self()
+			.event( [this]( mhood_t<msg_finish> ) {
+					so_deregister_agent_coop_normally();
+				} )
+			;
+	}
+
+	void
+	so_evt_start() override
+	{
+		so_5::send< so_5::mutable_msg< msg_quote > >( m_router, 0 );
+		// There is no destination for this key.
+		so_5::send< so_5::mutable_msg< msg_quote > >( m_router, 1 );
+		so_5::send< so_5::mutable_msg< msg_quote > >( m_router, 2 );
+		// This key is out of range.
+		so_5::send< so_5::mutable_msg< msg_quote > >( m_router, 7 );
+		// Negative key is out of range too.
+		so_5::send< so_5::mutable_msg< msg_quote > >( m_router, -1 );
+
+		so_5::send< msg_finish >( *this );
+	}
+};
+
+TEST_CASE( "by_key" )
+{
+	std::string trace;
+
+	run_with_time_limit( [&trace] {
+			so_5::launch( [&trace](so_5::environment_t & env) {
+						env.register_agent_as_coop(
+								env.make_agent< test_agent >( trace ) );
+					},
+					[](so_5::environment_params_t & params) {
+						params.message_delivery_tracer(
+								so_5::msg_tracing::std_cout_tracer() );
+					} );
+		},
+		5 );
+
+	REQUIRE( trace == "v0:0;v2:2;" );
+}
@@ -0,0 +1,118 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include <so_5_extra/mboxes/content_router.hpp>
+
+#include <so_5/all.hpp>
+
+#include <test/3rd_party/various_helpers/time_limited_execution.hpp>
+
+namespace router_ns = so_5::extra::mboxes::content_router;
+
+struct msg_order final : public so_5::message_t
+{
+	int m_priority;
+
+	explicit msg_order( int priority ) : m_priority{ priority }
+	{}
+};
+
+struct msg_finish final : public so_5::signal_t
+{};
+
+class test_agent final : public so_5::agent_t
+{
+	std::string & m_trace;
+
+	const so_5::mbox_t m_urgent_mbox;
+	const so_5::mbox_t m_other_mbox;
+	const so_5::mbox_t m_router;
+
+public:
+	test_agent( context_t ctx, std::string & trace )
+		:	so_5::agent_t{ std::move(ctx) }
+		,	m_trace{ trace }
+		,	m_urgent_mbox{ so_make_new_direct_mbox() }
+		,	m_other_mbox{ so_make_new_direct_mbox() }
+		,	m_router{
+				router_ns::multi_consumer_builder(
+						router_ns::redirect_if_no_destination( so_direct_mbox() ) )
+					.add_rule< msg_order >(
+							[]( const msg_order & m ) { return m.m_priority > 5; },
+							m_urgent_mbox )
+					.add_rule< msg_order >(
+							[]( const msg_order & m ) { return m.m_priority > 0; },
+							m_other_mbox )
+					.make( so_environment() )
+			}
+	{}
+
+	void
+	so_define_agent() override
+	{
+		try
+		{
+			so_subscribe( m_router ).event( []( mhood_t<msg_order> ) {} );
+		}
+		catch( const so_5::exception_t & x )
+		{
+			if( router_ns::errors::rc_subscription_to_routed_type
+					== x.error_code() )
+				m_trace += "subscription_rejected;";
+		}
+
+		so_subscribe( m_urgent_mbox )
+			.event( [this]( mhood_t<msg_order> cmd ) {
+					m_trace += "urgent:" + std::to_string( cmd->m_priority ) + ";";
+				} )
+			;
+
+		so_subscribe( m_other_mbox )
+			.event( [this]( mhood_t<msg_order> cmd ) {
+					m_trace += "other:" + std::to_string( cmd->m_priority ) + ";";
+				} )
+			;
+
+		so_subscribe_self()
+			.event( [this]( mhood_t<msg_order> cmd ) {
+					m_trace += "default:" + std::to_string( cmd->m_priority ) + ";";
+				} )
+			;
+
+		// Subscription to a type that isn't routed should be redirected
+		// to the default destination.
+		so_subscribe( m_router )
+			.event( [this]( mhood_t<msg_finish> ) {
+					so_deregister_agent_coop_normally();
+				} )
+			;
+	}
+
+	void
+	so_evt_start() override
+	{
+		so_5::send< msg_order >( m_router, 10 );
+		so_5::send< msg_order >( m_router, 1 );
+		so_5::send< msg_order >( m_router, 0 );
+		so_5::send< msg_finish >( m_router );
+	}
+};
+
+TEST_CASE( "rules" )
+{
+	std::string trace;
+
+	run_with_time_limit( [&trace] {
+			so_5::launch( [&trace](so_5::environment_t & env) {
+						env.register_agent_as_coop(
+								env.make_agent< test_agent >( trace ) );
+					},
+					[](so_5::environment_params_t & params) {
+						params.message_delivery_tracer(
+								so_5::msg_tracing::std_cout_tracer() );
+					} );
+		},
+		5 );
+
+	REQUIRE( trace == "subscription_rejected;urgent:10;other:1;default:0;" );
+}
@@ -0,0 +1,11 @@
+require 'mxx_ru/cpp'
+
+MxxRu::Cpp::exe_target {
+
+	required_prj 'so_5/prj_s.rb'
+
+	target '_unit.test.so_5_extra.mboxes.content_router.rules_s'
+
+	cpp_source 'main.cpp'
+}
+
@@ -18,4 +18,10 @@ MxxRu::Cpp::composite_target {
 
 	required_prj( "#{path}/delivery_filters_and_subscribers/prj.ut.rb" )
 	required_prj( "#{path}/delivery_filters_and_subscribers/prj_s.ut.rb" )
+
+	required_prj( "#{path}/multi_type/prj.ut.rb" )
+	required_prj( "#{path}/multi_type/prj_s.ut.rb" )
+
+	required_prj( "#{path}/grace_period/prj.ut.rb" )
+	required_prj( "#{path}/grace_period/prj_s.ut.rb" )
 }
@@ -0,0 +1,252 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include <so_5_extra/mboxes/first_last_subscriber_notification.hpp>
+
+#include <so_5/all.hpp>
+
+#include <test/3rd_party/various_helpers/time_limited_execution.hpp>
+
+namespace mbox_ns = so_5::extra::mboxes::first_last_subscriber_notification;
+
+struct msg_dummy final : public so_5::message_t {};
+
+struct msg_consumer_started final : public so_5::signal_t {};
+
+class consumer_agent final : public so_5::agent_t
+{
+	const so_5::mbox_t m_main_mbox;
+	const so_5::mbox_t m_test_mbox;
+
+public:
+	consumer_agent(
+		context_t ctx,
+		so_5::mbox_t main_mbox,
+		so_5::mbox_t test_mbox )
+		:	so_5::agent_t{ std::move(ctx) }
+		,	m_main_mbox{ std::move(main_mbox) }
+		,	m_test_mbox{ std::move(test_mbox) }
+	{
+	}
+
+	void
+	so_define_agent() override
+	{
+		so_subscribe( m_test_mbox )
+			.event( []( mhood_t< msg_dummy > ) {} )
+			;
+	}
+
+	void
+	so_evt_start() override
+	{
+		so_5::send< msg_consumer_started >( m_main_mbox );
+	}
+};
+
+class main_agent final : public so_5::agent_t
+{
+	std::string & m_trace;
+
+	const so_5::mbox_t m_test_mbox;
+
+	int m_consumers_started{ 0 };
+
+	so_5::coop_handle_t m_consumer_coop;
+
+public:
+	main_agent( context_t ctx, std::string & trace )
+		:	so_5::agent_t{ std::move(ctx) }
+		,	m_trace{ trace }
+		,	m_test_mbox{
+				mbox_ns::make_mbox< msg_dummy >(
+						so_environment(),
+						so_direct_mbox(),
+						so_5::mbox_type_t::multi_producer_multi_consumer,
+						std::chrono::milliseconds{ 250 } )
+			}
+	{}
+
+	void
+	so_define_agent() override
+	{
+		so_subscribe_self()
+			.event( &main_agent::evt_first_subscriber )
+			.event( &main_agent::evt_last_subscriber )
+			.event( &main_agent::evt_consumer_started )
+			.event( &main_agent::evt_coop_deregistered )
+			;
+	}
+
+	void
+	so_evt_start() override
+	{
+		make_consumer();
+	}
+
+private:
+	void
+	make_consumer()
+	{
+		m_consumer_coop = so_5::introduce_child_coop( *this,
+				[this]( so_5::coop_t & coop ) {
+					coop.make_agent< consumer_agent >(
+							so_direct_mbox(), m_test_mbox );
+
+					coop.add_dereg_notificator(
+							so_5::make_coop_dereg_notificator( so_direct_mbox() ) );
+				} );
+	}
+
+	void
+	evt_first_subscriber( mhood_t< mbox_ns::msg_first_subscriber > )
+	{
+		m_trace += "first;";
+	}
+
+	void
+	evt_last_subscriber( mhood_t< mbox_ns::msg_last_subscriber > )
+	{
+		m_trace += "last;";
+		so_deregister_agent_coop_normally();
+	}
+
+	void
+	evt_consumer_started( mhood_t< msg_consumer_started > )
+	{
+		++m_consumers_started;
+		so_environment().deregister_coop(
+				m_consumer_coop, so_5::dereg_reason::normal );
+	}
+
+	void
+	evt_coop_deregistered( mhood_t< so_5::msg_coop_deregistered > )
+	{
+		// The second consumer is created just after the removal of the
+		// first one, so this flapping shouldn't be visible.
+		if( 1 == m_consumers_started )
+			make_consumer();
+	}
+};
+
+// The receiver of notifications handles only msg_first_subscriber.
+class first_only_agent final : public so_5::agent_t
+{
+	struct msg_make_consumer final : public so_5::signal_t {};
+
+	std::string & m_trace;
+
+	const so_5::mbox_t m_test_mbox;
+
+	int m_first_subscribers{ 0 };
+
+	so_5::coop_handle_t m_consumer_coop;
+
+public:
+	first_only_agent( context_t ctx, std::string & trace )
+		:	so_5::agent_t{ std::move(ctx) }
+		,	m_trace{ trace }
+		,	m_test_mbox{
+				mbox_ns::make_mbox< msg_dummy >(
+						so_environment(),
+						so_direct_mbox(),
+						so_5::mbox_type_t::multi_producer_multi_consumer,
+						std::chrono::milliseconds{ 50 } )
+			}
+	{}
+
+	void
+	so_define_agent() override
+	{
+		so_subscribe_self()
+			.event( &first_only_agent::evt_first_subscriber )
+			.event( &first_only_agent::evt_consumer_started )
+			.event( &first_only_agent::evt_coop_deregistered )
+			.event( &first_only_agent::evt_make_consumer )
+			;
+	}
+
+	void
+	so_evt_start() override
+	{
+		make_consumer();
+	}
+
+private:
+	void
+	make_consumer()
+	{
+		m_consumer_coop = so_5::introduce_child_coop( *this,
+				[this]( so_5::coop_t & coop ) {
+					coop.make_agent< consumer_agent >(
+							so_direct_mbox(), m_test_mbox );
+
+					coop.add_dereg_notificator(
+							so_5::make_coop_dereg_notificator( so_direct_mbox() ) );
+				} );
+	}
+
+	void
+	evt_first_subscriber( mhood_t< mbox_ns::msg_first_subscriber > )
+	{
+		m_trace += "first;";
+		++m_first_subscribers;
+		if( 2 == m_first_subscribers )
+			so_deregister_agent_coop_normally();
+	}
+
+	void
+	evt_consumer_started( mhood_t< msg_consumer_started > )
+	{
+		so_environment().deregister_coop(
+				m_consumer_coop, so_5::dereg_reason::normal );
+	}
+
+	void
+	evt_coop_deregistered( mhood_t< so_5::msg_coop_deregistered > )
+	{
+		// The new consumer is created long after the end of grace period.
+		so_5::send_delayed< msg_make_consumer >( *this,
+				std::chrono::milliseconds{ 250 } );
+	}
+
+	void
+	evt_make_consumer( mhood_t< msg_make_consumer > )
+	{
+		make_consumer();
+	}
+};
+
+TEST_CASE( "grace period" )
+{
+	std::string trace;
+
+	run_with_time_limit( [&trace] {
+			so_5::launch( [&trace](so_5::environment_t & env) {
+						env.register_agent_as_coop(
+								env.make_agent< main_agent >( trace ) );
+					},
+					[](so_5::environment_params_t & params) {
+						params.message_delivery_tracer(
+								so_5::msg_tracing::std_cout_tracer() );
+					} );
+		},
+		5 );
+
+	REQUIRE( trace == "first;last;" );
+}
+
+TEST_CASE( "last subscriber notification isn't handled" )
+{
+	std::string trace;
+
+	run_with_time_limit( [&trace] {
+			so_5::launch( [&trace](so_5::environment_t & env) {
+						env.register_agent_as_coop(
+								env.make_agent< first_only_agent >( trace ) );
+					} );
+		},
+		5 );
+
+	REQUIRE( trace == "first;first;" );
+}
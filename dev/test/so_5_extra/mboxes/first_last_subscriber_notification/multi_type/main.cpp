@@ -0,0 +1,165 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include <so_5_extra/mboxes/first_last_subscriber_notification.hpp>
+
+#include <so_5/all.hpp>
+
+#include <test/3rd_party/various_helpers/time_limited_execution.hpp>
+
+namespace mbox_ns = so_5::extra::mboxes::first_last_subscriber_notification;
+
+struct msg_first final : public so_5::message_t {};
+
+struct msg_second final : public so_5::message_t {};
+
+class consumer_agent final : public so_5::agent_t
+{
+	const so_5::mbox_t m_test_mbox;
+
+	int m_first_received{ 0 };
+
+public:
+	consumer_agent(
+		context_t ctx,
+		so_5::mbox_t test_mbox )
+		:	so_5::agent_t{ std::move(ctx) }
+		,	m_test_mbox{ std::move(test_mbox) }
+	{
+	}
+
+	void
+	so_define_agent() override
+	{
+		so_subscribe( m_test_mbox )
+			.event( &consumer_agent::evt_first )
+			.event( &consumer_agent::evt_second )
+			;
+	}
+
+private:
+	void
+	evt_first( mhood_t< msg_first > )
+	{
+		++m_first_received;
+	}
+
+	void
+	evt_second( mhood_t< msg_second > )
+	{
+		if( 1 != m_first_received )
+			throw std::runtime_error{
+					"unexpected m_first_received value: "
+					+ std::to_string( m_first_received )
+			};
+
+		so_deregister_agent_coop_normally();
+	}
+};
+
+class main_agent final : public so_5::agent_t
+{
+	struct msg_finish final : public so_5::signal_t {};
+
+	std::string & m_trace;
+
+	const so_5::mbox_t m_test_mbox;
+
+	int m_last_msgs_received{ 0 };
+
+public:
+	main_agent( context_t ctx, std::string & trace )
+		:	so_5::agent_t{ std::move(ctx) }
+		,	m_trace{ trace }
+		,	m_test_mbox{
+				mbox_ns::make_multi_type_mbox(
+						so_environment(),
+						so_direct_mbox(),
+						so_5::mbox_type_t::multi_producer_multi_consumer )
+			}
+	{}
+
+	void
+	so_define_agent() override
+	{
+		so_subscribe_self()
+			.event( &main_agent::evt_first_subscriber )
+			.event( &main_agent::evt_last_subscriber )
+			.event( &main_agent::evt_finish )
+			;
+	}
+
+	void
+	so_evt_start() override
+	{
+		// There is no subscribers yet.
+		so_5::send< msg_first >( m_test_mbox );
+
+		so_5::introduce_child_coop( *this,
+				[this]( so_5::coop_t & coop ) {
+					coop.make_agent< consumer_agent >( m_test_mbox );
+				} );
+	}
+
+private:
+	static const char *
+	type_name( const std::type_index & msg_type )
+	{
+		if( typeid(msg_first) == msg_type )
+			return "first";
+		else if( typeid(msg_second) == msg_type )
+			return "second";
+		else
+			return "unknown";
+	}
+
+	void
+	evt_first_subscriber(
+		mhood_t< mbox_ns::msg_first_subscriber_for_type > cmd )
+	{
+		m_trace += std::string{ "subscribed:" } + type_name( cmd->m_msg_type ) + ";";
+
+		if( typeid(msg_second) == cmd->m_msg_type )
+		{
+			so_5::send< msg_first >( m_test_mbox );
+			so_5::send< msg_second >( m_test_mbox );
+		}
+	}
+
+	void
+	evt_last_subscriber(
+		mhood_t< mbox_ns::msg_last_subscriber_for_type > )
+	{
+		++m_last_msgs_received;
+		if( 2 == m_last_msgs_received )
+		{
+			m_trace += "unsubscribed;";
+			so_5::send< msg_finish >( *this );
+		}
+	}
+
+	void
+	evt_finish( mhood_t< msg_finish > )
+	{
+		so_deregister_agent_coop_normally();
+	}
+};
+
+TEST_CASE( "multi type" )
+{
+	std::string trace;
+
+	run_with_time_limit( [&trace] {
+			so_5::launch( [&trace](so_5::environment_t & env) {
+						env.register_agent_as_coop(
+								env.make_agent< main_agent >( trace ) );
+					},
+					[](so_5::environment_params_t & params) {
+						params.message_delivery_tracer(
+								so_5::msg_tracing::std_cout_tracer() );
+					} );
+		},
+		5 );
+
+	REQUIRE( trace == "subscribed:first;subscribed:second;unsubscribed;" );
+}
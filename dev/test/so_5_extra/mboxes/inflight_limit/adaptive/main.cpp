@@ -0,0 +1,152 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include <so_5_extra/mboxes/inflight_limit.hpp>
+
+#include <so_5/all.hpp>
+
+#include <test/3rd_party/various_helpers/time_limited_execution.hpp>
+
+#include <thread>
+
+namespace mbox_ns = so_5::extra::mboxes::inflight_limit;
+
+class test_agent final : public so_5::agent_t
+{
+	struct msg_test final : public so_5::message_t {};
+	struct msg_second_round final : public so_5::signal_t {};
+	struct msg_quit final : public so_5::signal_t {};
+
+	unsigned int & m_messages_received;
+
+	const std::chrono::milliseconds m_handling_time;
+
+	const so_5::mbox_t m_limited_mbox;
+
+	void
+	send_portion()
+	{
+		for( int i = 0; i != 4; ++i )
+			so_5::send< msg_test >( m_limited_mbox );
+	}
+
+public:
+	test_agent(
+		context_t ctx,
+		unsigned int & messages_received,
+		std::chrono::milliseconds handling_time,
+		const mbox_ns::adaptive_limit_params_t & params )
+		:	so_5::agent_t{ std::move(ctx) }
+		,	m_messages_received{ messages_received }
+		,	m_handling_time{ handling_time }
+		,	m_limited_mbox{
+				mbox_ns::make_adaptive_mbox< msg_test >( so_direct_mbox(), params )
+			}
+	{}
+
+	void
+	so_define_agent() override
+	{
+		so_subscribe_self()
+			.event( [this]( mhood_t<msg_test> ) {
+					++m_messages_received;
+					std::this_thread::sleep_for( m_handling_time );
+				} )
+			.event( [this]( mhood_t<msg_second_round> ) {
+					// All messages from the first round are destroyed
+					// at this moment and the limit is already updated.
+					send_portion();
+					so_5::send< msg_quit >( *this );
+				} )
+			.event( [this]( mhood_t<msg_quit> ) {
+					so_deregister_agent_coop_normally();
+				} )
+			;
+	}
+
+	void
+	so_evt_start() override
+	{
+		send_portion();
+		so_5::send< msg_second_round >( *this );
+	}
+};
+
+[[nodiscard]]
+unsigned int
+run_test(
+	std::chrono::milliseconds handling_time,
+	const mbox_ns::adaptive_limit_params_t & params )
+{
+	unsigned int messages_received{};
+
+	run_with_time_limit( [&] {
+			so_5::launch( [&](so_5::environment_t & env) {
+						env.register_agent_as_coop(
+								env.make_agent< test_agent >(
+										messages_received,
+										handling_time,
+										params ) );
+					},
+					[](so_5::environment_params_t & params) {
+						params.message_delivery_tracer(
+								so_5::msg_tracing::std_cout_tracer() );
+					} );
+		},
+		5 );
+
+	return messages_received;
+}
+
+TEST_CASE( "increase" )
+{
+	// The first round: the limit is 2 and it's increased to 3
+	// after the completion of the first message.
+	// The second round: the limit is 3.
+	const auto received = run_test(
+			std::chrono::milliseconds{ 0 },
+			mbox_ns::adaptive_limit_params_t{ 2u, std::chrono::seconds{ 1 } }
+				.max_limit( 10u ) );
+
+	REQUIRE( 5u == received );
+}
+
+TEST_CASE( "decrease" )
+{
+	// The first round: the limit is 4 and it's decreased to 2
+	// after the completion of the first message. Other messages were sent
+	// before the decrease so they don't decrease the limit again.
+	// The second round: the limit is 2.
+	const auto received = run_test(
+			std::chrono::milliseconds{ 25 },
+			mbox_ns::adaptive_limit_params_t{ 4u, std::chrono::milliseconds{ 5 } }
+				.max_limit( 10u ) );
+
+	REQUIRE( 6u == received );
+}
+
+TEST_CASE( "invalid params" )
+{
+	run_with_time_limit( [] {
+			bool exception_thrown = false;
+			so_5::launch( [&](so_5::environment_t & env) {
+						try
+						{
+							auto mbox = mbox_ns::make_adaptive_mbox< int >(
+									env.create_mbox(),
+									mbox_ns::adaptive_limit_params_t{
+											4u, std::chrono::milliseconds{ 5 } }
+										.min_limit( 5u ) );
+						}
+						catch( const so_5::exception_t & x )
+						{
+							if( mbox_ns::errors::rc_invalid_adaptive_limit_params ==
+									x.error_code() )
+								exception_thrown = true;
+						}
+					} );
+
+			REQUIRE( exception_thrown );
+		},
+		5 );
+}
@@ -15,5 +15,20 @@ MxxRu::Cpp::composite_target {
 
 	required_prj( "#{path}/wrong_type/prj.ut.rb" )
 	required_prj( "#{path}/wrong_type/prj_s.ut.rb" )
+
+	required_prj( "#{path}/per_key/prj.ut.rb" )
+	required_prj( "#{path}/per_key/prj_s.ut.rb" )
+
+	required_prj( "#{path}/watermarks/prj.ut.rb" )
+	required_prj( "#{path}/watermarks/prj_s.ut.rb" )
+
+	required_prj( "#{path}/adaptive/prj.ut.rb" )
+	required_prj( "#{path}/adaptive/prj_s.ut.rb" )
+
+	required_prj( "#{path}/shared_budget/prj.ut.rb" )
+	required_prj( "#{path}/shared_budget/prj_s.ut.rb" )
+
+	required_prj( "#{path}/mbox_destroyed_first/prj.ut.rb" )
+	required_prj( "#{path}/mbox_destroyed_first/prj_s.ut.rb" )
 }
 
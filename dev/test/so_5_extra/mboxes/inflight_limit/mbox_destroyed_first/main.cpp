@@ -0,0 +1,84 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include <so_5_extra/mboxes/inflight_limit.hpp>
+
+#include <so_5/all.hpp>
+
+#include <test/3rd_party/various_helpers/time_limited_execution.hpp>
+
+namespace mbox_ns = so_5::extra::mboxes::inflight_limit;
+
+
+class test_agent final : public so_5::agent_t
+{
+	struct msg_test final : public so_5::message_t
+	{
+		int m_round;
+
+		explicit msg_test( int round ) : m_round{ round }
+		{}
+	};
+
+	struct msg_quit final : public so_5::signal_t {};
+
+	std::string & m_trace;
+
+	void
+	send_round( int round )
+	{
+		// The mbox will be destroyed before the messages are processed.
+		const auto mbox = mbox_ns::make_mbox< msg_test >( so_direct_mbox(), 2u );
+
+		so_5::send< msg_test >( mbox, round );
+		so_5::send< msg_test >( mbox, round );
+		so_5::send< msg_test >( mbox, round );
+	}
+
+public:
+	test_agent( context_t ctx, std::string & trace )
+		:	so_5::agent_t{ std::move(ctx) }
+		,	m_trace{ trace }
+	{}
+
+	void
+	so_define_agent() override
+	{
+		so_subscribe_self()
+			.event( [this]( mhood_t<msg_test> cmd ) {
+					m_trace += std::to_string( cmd->m_round ) + ";";
+				} )
+			.event( [this]( mhood_t<msg_quit> ) {
+					so_deregister_agent_coop_normally();
+				} )
+			;
+	}
+
+	void
+	so_evt_start() override
+	{
+		send_round( 1 );
+		send_round( 2 );
+
+		so_5::send< msg_quit >( *this );
+	}
+};
+
+TEST_CASE( "mbox_destroyed_first" )
+{
+	std::string trace;
+
+	run_with_time_limit( [&trace] {
+			so_5::launch( [&trace](so_5::environment_t & env) {
+						env.register_agent_as_coop(
+								env.make_agent< test_agent >( trace ) );
+					},
+					[](so_5::environment_params_t & params) {
+						params.message_delivery_tracer(
+								so_5::msg_tracing::std_cout_tracer() );
+					} );
+		},
+		5 );
+
+	REQUIRE( trace == "1;1;2;2;" );
+}
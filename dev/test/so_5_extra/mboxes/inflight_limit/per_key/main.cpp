@@ -0,0 +1,103 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include <so_5_extra/mboxes/inflight_limit.hpp>
+
+#include <so_5/all.hpp>
+
+#include <test/3rd_party/various_helpers/time_limited_execution.hpp>
+
+namespace mbox_ns = so_5::extra::mboxes::inflight_limit;
+
+
+class test_agent final : public so_5::agent_t
+{
+	struct msg_test final : public so_5::message_t
+	{
+		int m_key;
+
+		explicit msg_test( int key ) : m_key{ key }
+		{}
+	};
+
+	struct msg_second_round final : public so_5::signal_t {};
+	struct msg_quit final : public so_5::signal_t {};
+
+	std::string & m_trace;
+
+	const so_5::mbox_t m_limited_mbox;
+
+	[[nodiscard]]
+	static so_5::mbox_t
+	make_limited_mbox( const so_5::mbox_t & dest_mbox )
+	{
+		return mbox_ns::make_per_key_mbox<msg_test>(
+				dest_mbox,
+				2u,
+				[]( const msg_test & m ) { return m.m_key; } );
+	}
+
+public:
+	test_agent( context_t ctx, std::string & trace )
+		:	so_5::agent_t{ std::move(ctx) }
+		,	m_trace{ trace }
+		,	m_limited_mbox{ make_limited_mbox( so_direct_mbox() ) }
+	{}
+
+	void
+	so_define_agent() override
+	{
+		so_subscribe_self()
+			.event( [this]( mhood_t<msg_test> cmd ) {
+					m_trace += std::to_string( cmd->m_key ) + ";";
+				} )
+			.event( [this]( mhood_t<msg_second_round> ) {
+					// All previous messages are already processed, so
+					// the limits for all keys should be available again.
+					so_5::send< msg_test >( m_limited_mbox, 1 );
+					so_5::send< msg_test >( m_limited_mbox, 1 );
+					so_5::send< msg_test >( m_limited_mbox, 1 );
+
+					so_5::send< msg_quit >( *this );
+				} )
+			.event( [this]( mhood_t<msg_quit> ) {
+					so_deregister_agent_coop_normally();
+				} )
+			;
+	}
+
+	void
+	so_evt_start() override
+	{
+		so_5::send< msg_test >( m_limited_mbox, 1 );
+		so_5::send< msg_test >( m_limited_mbox, 2 );
+		so_5::send< msg_test >( m_limited_mbox, 1 );
+		// Limit for the key 1 is exceeded.
+		so_5::send< msg_test >( m_limited_mbox, 1 );
+		so_5::send< msg_test >( m_limited_mbox, 2 );
+		// Limit for the key 2 is exceeded.
+		so_5::send< msg_test >( m_limited_mbox, 2 );
+		so_5::send< msg_test >( m_limited_mbox, 3 );
+
+		so_5::send< msg_second_round >( *this );
+	}
+};
+
+TEST_CASE( "per_key" )
+{
+	std::string trace;
+
+	run_with_time_limit( [&trace] {
+			so_5::launch( [&trace](so_5::environment_t & env) {
+						env.register_agent_as_coop(
+								env.make_agent< test_agent >( trace ) );
+					},
+					[](so_5::environment_params_t & params) {
+						params.message_delivery_tracer(
+								so_5::msg_tracing::std_cout_tracer() );
+					} );
+		},
+		5 );
+
+	REQUIRE( trace == "1;2;1;2;3;1;1;" );
+}
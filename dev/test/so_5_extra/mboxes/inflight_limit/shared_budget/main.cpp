@@ -0,0 +1,91 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include <so_5_extra/mboxes/inflight_limit.hpp>
+
+#include <so_5/all.hpp>
+
+#include <test/3rd_party/various_helpers/time_limited_execution.hpp>
+
+namespace mbox_ns = so_5::extra::mboxes::inflight_limit;
+
+
+class test_agent final : public so_5::agent_t
+{
+	struct msg_first final : public so_5::message_t {};
+	struct msg_second final : public so_5::message_t {};
+	struct msg_quit final : public so_5::signal_t {};
+
+	std::string & m_trace;
+
+	const mbox_ns::shared_budget_t m_budget;
+
+	const so_5::mbox_t m_first_mbox;
+	const so_5::mbox_t m_second_mbox;
+
+public:
+	test_agent( context_t ctx, std::string & trace )
+		:	so_5::agent_t{ std::move(ctx) }
+		,	m_trace{ trace }
+		,	m_budget{ 3u }
+		,	m_first_mbox{
+				mbox_ns::make_mbox< msg_first >( so_direct_mbox(), m_budget )
+			}
+		,	m_second_mbox{
+				mbox_ns::make_mbox< msg_second >(
+						so_environment().create_mbox(), m_budget )
+			}
+	{}
+
+	void
+	so_define_agent() override
+	{
+		so_subscribe_self()
+			.event( [this]( mhood_t<msg_first> ) {
+					m_trace += "first;";
+				} )
+			.event( [this]( mhood_t<msg_quit> ) {
+					m_trace += "inflight=" + std::to_string( m_budget.inflight() ) + ";";
+					so_deregister_agent_coop_normally();
+				} )
+			;
+
+		so_subscribe( m_second_mbox )
+			.event( [this]( mhood_t<msg_second> ) {
+					m_trace += "second;";
+				} )
+			;
+	}
+
+	void
+	so_evt_start() override
+	{
+		so_5::send< msg_first >( m_first_mbox );
+		so_5::send< msg_second >( m_second_mbox );
+		so_5::send< msg_first >( m_first_mbox );
+		// The budget is exhausted.
+		so_5::send< msg_second >( m_second_mbox );
+		so_5::send< msg_first >( m_first_mbox );
+
+		so_5::send< msg_quit >( *this );
+	}
+};
+
+TEST_CASE( "shared_budget" )
+{
+	std::string trace;
+
+	run_with_time_limit( [&trace] {
+			so_5::launch( [&trace](so_5::environment_t & env) {
+						env.register_agent_as_coop(
+								env.make_agent< test_agent >( trace ) );
+					},
+					[](so_5::environment_params_t & params) {
+						params.message_delivery_tracer(
+								so_5::msg_tracing::std_cout_tracer() );
+					} );
+		},
+		5 );
+
+	REQUIRE( trace == "first;second;first;inflight=0;" );
+}
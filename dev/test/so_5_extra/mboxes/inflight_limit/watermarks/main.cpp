@@ -0,0 +1,125 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include <so_5_extra/mboxes/inflight_limit.hpp>
+
+#include <so_5/all.hpp>
+
+#include <test/3rd_party/various_helpers/time_limited_execution.hpp>
+
+namespace mbox_ns = so_5::extra::mboxes::inflight_limit;
+
+struct msg_dummy final : public so_5::message_t {};
+
+class test_agent final : public so_5::agent_t
+{
+	struct msg_test final : public so_5::message_t {};
+	struct msg_quit final : public so_5::signal_t {};
+
+	std::string & m_trace;
+
+	const so_5::mbox_t m_limited_mbox;
+
+	[[nodiscard]]
+	static so_5::mbox_t
+	make_limited_mbox( const so_5::mbox_t & dest_mbox )
+	{
+		return mbox_ns::make_mbox_with_watermarks<msg_test>(
+				dest_mbox,
+				4u,
+				mbox_ns::watermarks_t{ 3u, 1u },
+				dest_mbox );
+	}
+
+public:
+	test_agent( context_t ctx, std::string & trace )
+		:	so_5::agent_t{ std::move(ctx) }
+		,	m_trace{ trace }
+		,	m_limited_mbox{ make_limited_mbox( so_direct_mbox() ) }
+	{}
+
+	void
+	so_define_agent() override
+	{
+		so_subscribe_self()
+			.event( [this]( mhood_t<msg_test> ) {
+					m_trace += "msg;";
+				} )
+			.event( [this]( mhood_t<mbox_ns::msg_high_watermark> ) {
+					m_trace += "high;";
+				} )
+			.event( [this]( mhood_t<mbox_ns::msg_low_watermark> ) {
+					m_trace += "low;";
+					so_5::send< msg_quit >( *this );
+				} )
+			.event( [this]( mhood_t<msg_quit> ) {
+					so_deregister_agent_coop_normally();
+				} )
+			;
+	}
+
+	void
+	so_evt_start() override
+	{
+		so_5::send< msg_test >( m_limited_mbox );
+		so_5::send< msg_test >( m_limited_mbox );
+		// The high watermark is reached here.
+		so_5::send< msg_test >( m_limited_mbox );
+		so_5::send< msg_test >( m_limited_mbox );
+		// The limit is exceeded, this message is dropped.
+		so_5::send< msg_test >( m_limited_mbox );
+	}
+};
+
+TEST_CASE( "watermarks" )
+{
+	std::string trace;
+
+	run_with_time_limit( [&trace] {
+			so_5::launch( [&trace](so_5::environment_t & env) {
+						env.register_agent_as_coop(
+								env.make_agent< test_agent >( trace ) );
+					},
+					[](so_5::environment_params_t & params) {
+						params.message_delivery_tracer(
+								so_5::msg_tracing::std_cout_tracer() );
+					} );
+		},
+		5 );
+
+	// The low watermark is reached when the third message is destroyed.
+	REQUIRE( trace == "msg;msg;msg;high;msg;low;" );
+}
+
+TEST_CASE( "invalid watermarks" )
+{
+	run_with_time_limit( [] {
+			int errors_caught = 0;
+			so_5::launch( [&](so_5::environment_t & env) {
+						const auto try_make = [&]( mbox_ns::watermarks_t w ) {
+								try
+								{
+									auto mbox = mbox_ns::make_mbox_with_watermarks< msg_dummy >(
+											env.create_mbox(),
+											4u,
+											w,
+											env.create_mbox() );
+								}
+								catch( const so_5::exception_t & x )
+								{
+									if( mbox_ns::errors::rc_invalid_watermarks ==
+											x.error_code() )
+										++errors_caught;
+								}
+							};
+
+						// Low is equal to high.
+						try_make( mbox_ns::watermarks_t{ 2u, 2u } );
+						// High is greater than limit.
+						try_make( mbox_ns::watermarks_t{ 5u, 2u } );
+					} );
+
+			REQUIRE( 2 == errors_caught );
+		},
+		5 );
+}
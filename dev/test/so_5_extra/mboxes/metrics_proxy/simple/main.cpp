@@ -0,0 +1,234 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include <so_5_extra/mboxes/metrics_proxy.hpp>
+
+#include <so_5/all.hpp>
+
+#include <test/3rd_party/various_helpers/time_limited_execution.hpp>
+
+#include <thread>
+#include <vector>
+
+namespace metrics_ns = so_5::extra::mboxes::metrics_proxy;
+
+struct msg_data final : public so_5::message_t
+{
+	int m_value;
+
+	explicit msg_data( int value ) : m_value{ value }
+	{}
+};
+
+class test_agent final : public so_5::agent_t
+{
+	std::string & m_trace;
+	std::string & m_prefix;
+
+	const so_5::mbox_t m_test_mbox;
+
+	int m_received{ 0 };
+
+	std::size_t m_sends{ 0 };
+	std::size_t m_bytes{ 0 };
+
+public:
+	test_agent( context_t ctx, std::string & trace, std::string & prefix )
+		:	so_5::agent_t{ std::move(ctx) }
+		,	m_trace{ trace }
+		,	m_prefix{ prefix }
+		,	m_test_mbox{
+				metrics_ns::make_mbox(
+						so_environment().create_mbox(),
+						"test-metrics",
+						[]( const std::type_index &, const so_5::message_ref_t & ) {
+							return std::size_t{ 10u };
+						} )
+			}
+	{}
+
+	void
+	so_define_agent() override
+	{
+		so_subscribe( m_test_mbox )
+			.event( &test_agent::evt_data );
+
+		so_subscribe( so_environment().stats_controller().mbox() )
+			.event( &test_agent::evt_quantity );
+	}
+
+	void
+	so_evt_start() override
+	{
+		so_5::send< msg_data >( m_test_mbox, 1 );
+		so_5::send< msg_data >( m_test_mbox, 2 );
+		so_5::send< msg_data >( m_test_mbox, 3 );
+	}
+
+private:
+	void
+	evt_data( mhood_t< msg_data > cmd )
+	{
+		m_trace += std::to_string( cmd->m_value ) + ";";
+
+		++m_received;
+		if( 3 == m_received )
+		{
+			auto & controller = so_environment().stats_controller();
+			controller.set_distribution_period( std::chrono::milliseconds(50) );
+			controller.turn_on();
+		}
+	}
+
+	void
+	evt_quantity( mhood_t< so_5::stats::messages::quantity< std::size_t > > cmd )
+	{
+		const std::string_view prefix{ cmd->m_prefix.c_str() };
+		if( prefix.substr( 0u, 13u ) != "test-metrics/" )
+			return;
+
+		const std::string_view suffix{ cmd->m_suffix.c_str() };
+		if( metrics_ns::suffixes::sends().c_str() == suffix )
+			m_sends = cmd->m_value;
+		else if( metrics_ns::suffixes::bytes().c_str() == suffix )
+			m_bytes = cmd->m_value;
+		else if( suffix == "/interarrival.inf" )
+		{
+			// The last value for the message type.
+			m_prefix = std::string{ prefix };
+			m_trace += "sends=" + std::to_string( m_sends )
+					+ ",bytes=" + std::to_string( m_bytes ) + ";";
+
+			so_deregister_agent_coop_normally();
+		}
+	}
+};
+
+class several_threads_agent final : public so_5::agent_t
+{
+	static constexpr int threads = 4;
+	static constexpr int messages_per_thread = 5;
+
+	std::string & m_trace;
+
+	const so_5::mbox_t m_test_mbox;
+
+	int m_received{ 0 };
+
+	std::size_t m_sends{ 0 };
+	std::size_t m_intervals{ 0 };
+
+public:
+	several_threads_agent( context_t ctx, std::string & trace )
+		:	so_5::agent_t{ std::move(ctx) }
+		,	m_trace{ trace }
+		,	m_test_mbox{
+				metrics_ns::make_mbox(
+						so_environment().create_mbox(),
+						"test-metrics" )
+			}
+	{}
+
+	void
+	so_define_agent() override
+	{
+		so_subscribe( m_test_mbox )
+			.event( &several_threads_agent::evt_data );
+
+		so_subscribe( so_environment().stats_controller().mbox() )
+			.event( &several_threads_agent::evt_quantity );
+	}
+
+	void
+	so_evt_start() override
+	{
+		// Blocks of those threads are removed when threads finish.
+		std::vector< std::thread > senders;
+		for( int t = 0; t != threads; ++t )
+			senders.emplace_back( [this] {
+					for( int i = 0; i != messages_per_thread; ++i )
+						so_5::send< msg_data >( m_test_mbox, i );
+				} );
+
+		for( auto & t : senders )
+			t.join();
+	}
+
+private:
+	void
+	evt_data( mhood_t< msg_data > )
+	{
+		++m_received;
+		if( threads * messages_per_thread == m_received )
+		{
+			auto & controller = so_environment().stats_controller();
+			controller.set_distribution_period( std::chrono::milliseconds(50) );
+			controller.turn_on();
+		}
+	}
+
+	void
+	evt_quantity( mhood_t< so_5::stats::messages::quantity< std::size_t > > cmd )
+	{
+		const std::string_view prefix{ cmd->m_prefix.c_str() };
+		if( prefix.substr( 0u, 13u ) != "test-metrics/" )
+			return;
+
+		const std::string_view suffix{ cmd->m_suffix.c_str() };
+		if( metrics_ns::suffixes::sends().c_str() == suffix )
+			m_sends = cmd->m_value;
+		else if( suffix.substr( 0u, 14u ) == "/interarrival." )
+		{
+			m_intervals += cmd->m_value;
+
+			if( suffix == "/interarrival.inf" )
+			{
+				// The last value for the message type.
+				// Intervals are measured between messages from all threads.
+				m_trace += "sends=" + std::to_string( m_sends )
+						+ ",intervals=" + std::to_string( m_intervals ) + ";";
+
+				so_deregister_agent_coop_normally();
+			}
+		}
+	}
+};
+
+TEST_CASE( "simple" )
+{
+	std::string trace;
+	std::string prefix;
+
+	run_with_time_limit( [&trace, &prefix] {
+			so_5::launch( [&trace, &prefix](so_5::environment_t & env) {
+						env.register_agent_as_coop(
+								env.make_agent< test_agent >( trace, prefix ) );
+					},
+					[](so_5::environment_params_t & params) {
+						params.message_delivery_tracer(
+								so_5::msg_tracing::std_cout_tracer() );
+					} );
+		},
+		5 );
+
+	REQUIRE( trace == "1;2;3;sends=3,bytes=30;" );
+#if defined(__GNUC__)
+	// The name of the type should be demangled.
+	REQUIRE( prefix == "test-metrics/msg_data" );
+#endif
+}
+
+TEST_CASE( "several threads" )
+{
+	std::string trace;
+
+	run_with_time_limit( [&trace] {
+			so_5::launch( [&trace](so_5::environment_t & env) {
+						env.register_agent_as_coop(
+								env.make_agent< several_threads_agent >( trace ) );
+					} );
+		},
+		5 );
+
+	REQUIRE( trace == "sends=20,intervals=19;" );
+}
@@ -0,0 +1,108 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include <so_5_extra/mboxes/sampling_tracer.hpp>
+
+#include <so_5/all.hpp>
+
+#include <test/3rd_party/various_helpers/time_limited_execution.hpp>
+
+namespace tracer_ns = so_5::extra::mboxes::sampling_tracer;
+
+struct msg_data final : public so_5::message_t
+{
+	int m_value;
+
+	explicit msg_data( int value ) : m_value{ value }
+	{}
+};
+
+struct msg_cancel final : public so_5::signal_t
+{};
+
+class test_agent final : public so_5::agent_t
+{
+	const tracer_ns::trace_buffer_shptr_t m_buffer;
+
+	const so_5::mbox_t m_test_mbox;
+
+	int m_received{ 0 };
+
+public:
+	test_agent(
+		context_t ctx,
+		tracer_ns::trace_buffer_shptr_t buffer )
+		:	so_5::agent_t{ std::move(ctx) }
+		,	m_buffer{ std::move(buffer) }
+		,	m_test_mbox{
+				tracer_ns::make_mbox(
+						so_environment().create_mbox(),
+						m_buffer,
+						tracer_ns::sampling_params_t{}
+							.every_nth( 5u )
+							.always_trace< msg_cancel >() )
+			}
+	{}
+
+	void
+	so_define_agent() override
+	{
+		so_subscribe( m_test_mbox )
+			.event( [this]( mhood_t<msg_data> ) {
+					++m_received;
+				} )
+			.event( [this]( mhood_t<msg_cancel> ) {
+					if( 10 != m_received )
+						throw std::runtime_error{
+								"unexpected m_received value: "
+								+ std::to_string( m_received )
+						};
+
+					so_deregister_agent_coop_normally();
+				} )
+			;
+	}
+
+	void
+	so_evt_start() override
+	{
+		for( int i = 0; i != 10; ++i )
+			so_5::send< msg_data >( m_test_mbox, i );
+		so_5::send< msg_cancel >( m_test_mbox );
+	}
+};
+
+TEST_CASE( "simple" )
+{
+	auto buffer = tracer_ns::make_trace_buffer( 16u );
+
+	run_with_time_limit( [buffer] {
+			so_5::launch( [buffer](so_5::environment_t & env) {
+						env.register_agent_as_coop(
+								env.make_agent< test_agent >( buffer ) );
+					} );
+		},
+		5 );
+
+	const auto records = buffer->dump();
+
+	std::string trace;
+	for( const auto & r : records )
+	{
+		if( typeid(msg_data) == r.m_msg_type )
+			trace += "data;";
+		else if( typeid(msg_cancel) == r.m_msg_type )
+			trace += "cancel;";
+		else
+			trace += "unknown;";
+	}
+
+	REQUIRE( trace == "data;data;cancel;" );
+}
+
+TEST_CASE( "invalid ring capacity" )
+{
+	REQUIRE_THROWS_AS(
+			tracer_ns::make_trace_buffer( 10u ),
+			so_5::exception_t );
+}
@@ -0,0 +1,106 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN 
+#include <doctest/doctest.h>
+
+#include <so_5_extra/mchains/asio_eventfd.hpp>
+#include <so_5_extra/mchains/segmented.hpp>
+
+#include <so_5/all.hpp>
+
+#include <test/3rd_party/various_helpers/time_limited_execution.hpp>
+
+namespace eventfd_ns = so_5::extra::mchains::asio_eventfd;
+
+using namespace std::chrono_literals;
+
+TEST_CASE( "drain on io_context" )
+{
+	run_with_time_limit( [] {
+			so_5::wrapped_env_t sobj;
+			asio::io_context io_ctx;
+
+			auto ch = eventfd_ns::make_channel(
+					sobj.environment(),
+					io_ctx,
+					so_5::make_unlimited_mchain_params() );
+
+			const auto main_thread_id = std::this_thread::get_id();
+
+			int expected = 0;
+			int strings = 0;
+			eventfd_ns::start_draining( ch, 8u,
+					[&]( int v ) {
+						REQUIRE( main_thread_id == std::this_thread::get_id() );
+						REQUIRE( expected == v );
+						++expected;
+					},
+					[&]( const std::string & ) { ++strings; } );
+
+			std::thread producer{ [ch] {
+					for( int i = 0; i != 1000; ++i )
+					{
+						so_5::send< int >( ch->chain(), i );
+						if( 0 == i % 100 )
+							std::this_thread::sleep_for( 1ms );
+					}
+					so_5::send< std::string >( ch->chain(), "last" );
+					ch->close();
+				} };
+
+			io_ctx.run();
+			producer.join();
+
+			REQUIRE( 1000 == expected );
+			REQUIRE( 1 == strings );
+		},
+		5 );
+}
+
+TEST_CASE( "custom mchain and old notificator" )
+{
+	run_with_time_limit( [] {
+			so_5::wrapped_env_t sobj;
+			asio::io_context io_ctx;
+
+			int notifications = 0;
+
+			auto params = so_5::make_unlimited_mchain_params();
+			params.not_empty_notificator( [&notifications] { ++notifications; } );
+
+			auto ch = eventfd_ns::make_channel(
+					io_ctx,
+					params,
+					[&sobj]( const so_5::mchain_params_t & p ) {
+						return so_5::extra::mchains::segmented::create_mchain< 4 >(
+								sobj.environment(), p );
+					} );
+
+			so_5::send< int >( ch->chain(), 0 );
+			so_5::send< int >( ch->chain(), 1 );
+			REQUIRE( 1 == notifications );
+
+			int handled = 0;
+			ch->async_wait( [&]( const asio::error_code & ec ) {
+					REQUIRE( !ec );
+					const auto r = so_5::receive(
+							so_5::from( ch->chain() ).handle_all().no_wait_on_empty(),
+							[&handled]( int ) { ++handled; } );
+					REQUIRE( 2u == r.handled() );
+				} );
+
+			io_ctx.run();
+			REQUIRE( 2 == handled );
+
+			// There is no messages, the handler should not be called.
+			bool called = false;
+			ch->async_wait( [&]( const asio::error_code & ) { called = true; } );
+			io_ctx.restart();
+			io_ctx.poll();
+			REQUIRE( !called );
+
+			ch->cancel();
+			io_ctx.run();
+			REQUIRE( called );
+		},
+		5 );
+}
+
@@ -5,4 +5,20 @@ MxxRu::Cpp::composite_target {
 	path = 'test/so_5_extra/mchains'
 
 	required_prj( "#{path}/fixed_size/build_tests.rb" )
+	required_prj( "#{path}/lock_free/build_tests.rb" )
+	required_prj( "#{path}/conflating/build_tests.rb" )
+	required_prj( "#{path}/priority/build_tests.rb" )
+	required_prj( "#{path}/segmented/build_tests.rb" )
+	required_prj( "#{path}/spin_wait/build_tests.rb" )
+
+	# POSIX shared memory isn't available on Windows.
+	if 'mswin' != toolset.tag( 'target_os' )
+		required_prj( "#{path}/shared_memory/build_tests.rb" )
+	end
+
+	# eventfd is available on Linux only.
+	if 'unix' == toolset.tag( 'target_os', 'undefined' ) &&
+			'linux' == toolset.tag( 'unix_port', 'undefined' )
+		required_prj( "#{path}/asio_eventfd/build_tests.rb" )
+	end
 }
@@ -0,0 +1,160 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN 
+#include <doctest/doctest.h>
+
+#include <so_5_extra/mchains/conflating.hpp>
+
+#include <so_5/all.hpp>
+
+#include <test/3rd_party/various_helpers/time_limited_execution.hpp>
+
+#include <map>
+
+namespace conflating_ns = so_5::extra::mchains::conflating;
+
+struct msg_quote final : public so_5::message_t
+{
+	std::string m_symbol;
+	int m_price;
+
+	msg_quote( std::string symbol, int price )
+		:	m_symbol{ std::move(symbol) }
+		,	m_price{ price }
+	{}
+};
+
+struct quote_key
+{
+	const std::string &
+	operator()( const msg_quote & q ) const { return q.m_symbol; }
+};
+
+// An extractor with a state: symbols are mapped to sequential ids.
+// Keys are different for different symbols only if the same instance
+// of the extractor is used for all messages.
+struct quote_id_key
+{
+	std::map< std::string, int > m_ids;
+
+	int
+	operator()( const msg_quote & q )
+	{
+		return m_ids.emplace( q.m_symbol, static_cast< int >( m_ids.size() ) )
+				.first->second;
+	}
+};
+
+TEST_CASE( "by type" )
+{
+	run_with_time_limit( [] {
+			so_5::launch( [&](so_5::environment_t & env) {
+					auto ch = conflating_ns::create_mchain( env );
+
+					so_5::send< int >( ch, 0 );
+					so_5::send< std::string >( ch, "first" );
+					so_5::send< int >( ch, 1 );
+					so_5::send< int >( ch, 2 );
+					so_5::send< std::string >( ch, "second" );
+					REQUIRE( 2u == ch->size() );
+
+					std::string trace;
+					so_5::receive( so_5::from(ch).handle_all().no_wait_on_empty(),
+						[&trace]( int v ) {
+							trace += "int:" + std::to_string( v ) + ";";
+						},
+						[&trace]( const std::string & v ) {
+							trace += "str:" + v + ";";
+						} );
+
+					REQUIRE( trace == "int:2;str:second;" );
+				},
+				[](so_5::environment_params_t & params) {
+					params.message_delivery_tracer(
+							so_5::msg_tracing::std_cout_tracer() );
+				} );
+		},
+		5 );
+}
+
+TEST_CASE( "by key" )
+{
+	run_with_time_limit( [] {
+			so_5::launch( [&](so_5::environment_t & env) {
+					auto ch = conflating_ns::create_mchain<
+							conflating_ns::by_key_t< msg_quote, quote_key > >( env );
+
+					so_5::send< msg_quote >( ch, "AAA", 1 );
+					so_5::send< msg_quote >( ch, "BBB", 2 );
+					so_5::send< int >( ch, 0 );
+					so_5::send< msg_quote >( ch, "AAA", 3 );
+					so_5::send< int >( ch, 1 );
+					so_5::send< msg_quote >( ch, "CCC", 4 );
+					REQUIRE( 4u == ch->size() );
+
+					std::string trace;
+					so_5::receive( so_5::from(ch).handle_all().no_wait_on_empty(),
+						[&trace]( so_5::mhood_t<msg_quote> cmd ) {
+							trace += cmd->m_symbol + ":"
+									+ std::to_string( cmd->m_price ) + ";";
+						},
+						[&trace]( int v ) {
+							trace += "int:" + std::to_string( v ) + ";";
+						} );
+
+					REQUIRE( trace == "AAA:3;BBB:2;int:1;CCC:4;" );
+
+					// The key can be used again after extraction.
+					so_5::send< msg_quote >( ch, "AAA", 5 );
+					REQUIRE( 1u == ch->size() );
+				} );
+		},
+		5 );
+}
+
+TEST_CASE( "stateful key extractor" )
+{
+	run_with_time_limit( [] {
+			so_5::launch( [&](so_5::environment_t & env) {
+					auto ch = conflating_ns::create_mchain<
+							conflating_ns::by_key_t< msg_quote, quote_id_key > >( env );
+
+					so_5::send< msg_quote >( ch, "AAA", 1 );
+					so_5::send< msg_quote >( ch, "BBB", 2 );
+					so_5::send< msg_quote >( ch, "AAA", 3 );
+					REQUIRE( 2u == ch->size() );
+
+					std::string trace;
+					so_5::receive( so_5::from(ch).handle_all().no_wait_on_empty(),
+						[&trace]( so_5::mhood_t<msg_quote> cmd ) {
+							trace += cmd->m_symbol + ":"
+									+ std::to_string( cmd->m_price ) + ";";
+						} );
+
+					REQUIRE( trace == "AAA:3;BBB:2;" );
+				} );
+		},
+		5 );
+}
+
+TEST_CASE( "limited capacity isn't supported" )
+{
+	run_with_time_limit( [] {
+			so_5::launch( [&](so_5::environment_t & env) {
+					try
+					{
+						auto ch = conflating_ns::create_mchain(
+								env,
+								so_5::make_limited_without_waiting_mchain_params(
+										16,
+										so_5::mchain_props::memory_usage_t::preallocated,
+										so_5::mchain_props::overflow_reaction_t::drop_newest ) );
+						FAIL( "an exception is expected" );
+					}
+					catch( const so_5::exception_t & x )
+					{
+						REQUIRE( conflating_ns::errors::rc_limited_capacity_not_supported
+								== x.error_code() );
+					}
+				} );
+		},
+		5 );
+}
@@ -0,0 +1,378 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include <so_5_extra/mchains/lock_free.hpp>
+
+#include <so_5/all.hpp>
+
+#include <test/3rd_party/various_helpers/time_limited_execution.hpp>
+
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace lf_ns = so_5::extra::mchains::lock_free;
+
+using so_5::mchain_props::extraction_status_t;
+
+struct item_t
+{
+	int m_producer;
+	int m_value;
+};
+
+template< lf_ns::producers_t Producers >
+void
+check_fill_and_drain()
+{
+	lf_ns::channel_t< item_t, 8, Producers > ch;
+
+	for( int i = 0; i != 8; ++i )
+		REQUIRE( ch.try_send( item_t{ 0, i } ) );
+	REQUIRE( !ch.try_send( item_t{ 0, 8 } ) );
+	REQUIRE( 8u == ch.size_approx() );
+
+	item_t item{};
+	for( int lap = 0; lap != 3; ++lap )
+		for( int i = 0; i != 8; ++i )
+		{
+			REQUIRE( ch.try_receive( item ) );
+			REQUIRE( lap * 8 + i == item.m_value );
+			REQUIRE( ch.try_send( item_t{ 0, lap * 8 + i + 8 } ) );
+		}
+
+	REQUIRE( 8u == ch.size_approx() );
+}
+
+TEST_CASE( "fill and drain" )
+{
+	check_fill_and_drain< lf_ns::producers_t::single >();
+	check_fill_and_drain< lf_ns::producers_t::multiple >();
+}
+
+TEST_CASE( "timeout and close" )
+{
+	lf_ns::channel_t< item_t, 4 > ch;
+
+	item_t item{};
+	REQUIRE( extraction_status_t::no_messages ==
+			ch.receive( item, std::chrono::milliseconds{ 20 } ) );
+
+	REQUIRE( ch.try_send( item_t{ 0, 1 } ) );
+	ch.close();
+	REQUIRE( ch.is_closed() );
+	REQUIRE( !ch.try_send( item_t{ 0, 2 } ) );
+
+	// The payload sent before close() is still available.
+	REQUIRE( extraction_status_t::msg_extracted ==
+			ch.receive( item, so_5::infinite_wait ) );
+	REQUIRE( 1 == item.m_value );
+	REQUIRE( extraction_status_t::chain_closed ==
+			ch.receive( item, so_5::infinite_wait ) );
+}
+
+TEST_CASE( "close wakes up the consumer" )
+{
+	run_with_time_limit( [] {
+			lf_ns::channel_t< item_t, 4 > ch;
+
+			std::thread closer{ [&ch] {
+					std::this_thread::sleep_for( std::chrono::milliseconds{ 50 } );
+					ch.close();
+				} };
+
+			item_t item{};
+			REQUIRE( extraction_status_t::chain_closed ==
+					ch.receive( item, so_5::infinite_wait ) );
+
+			closer.join();
+		},
+		5 );
+}
+
+TEST_CASE( "payloads left in the channel are destroyed" )
+{
+	auto payload = std::make_shared< int >( 42 );
+	{
+		lf_ns::channel_t< std::shared_ptr< int >, 4 > ch;
+		REQUIRE( ch.try_send( payload ) );
+		REQUIRE( ch.try_send( payload ) );
+		REQUIRE( 3 == payload.use_count() );
+	}
+	REQUIRE( 1 == payload.use_count() );
+}
+
+template< lf_ns::producers_t Producers >
+void
+check_bulk_receive()
+{
+	lf_ns::channel_t< item_t, 8, Producers > ch;
+
+	std::array< item_t, 5 > buffer{};
+	REQUIRE( 0u == ch.try_receive_bulk( buffer.begin(), buffer.size() ) );
+
+	for( int lap = 0; lap != 4; ++lap )
+	{
+		for( int i = 0; i != 7; ++i )
+			REQUIRE( ch.try_send( item_t{ lap, i } ) );
+
+		REQUIRE( 5u == ch.try_receive_bulk( buffer.begin(), buffer.size() ) );
+		for( int i = 0; i != 5; ++i )
+			REQUIRE( i == buffer[ i ].m_value );
+
+		std::vector< item_t > rest;
+		const auto r = ch.receive_bulk(
+				std::back_inserter( rest ), 100u, so_5::infinite_wait );
+		REQUIRE( extraction_status_t::msg_extracted == r.status() );
+		REQUIRE( 2u == r.extracted() );
+		REQUIRE( 2u == rest.size() );
+		REQUIRE( 5 == rest[ 0 ].m_value );
+		REQUIRE( 6 == rest[ 1 ].m_value );
+		REQUIRE( lap == rest[ 1 ].m_producer );
+	}
+
+	const auto r = ch.receive_bulk(
+			buffer.begin(), buffer.size(), std::chrono::milliseconds{ 20 } );
+	REQUIRE( extraction_status_t::no_messages == r.status() );
+	REQUIRE( 0u == r.extracted() );
+
+	REQUIRE( ch.try_send( item_t{ 0, 1 } ) );
+	ch.close();
+	REQUIRE( 1u == ch.receive_bulk(
+			buffer.begin(), buffer.size(), so_5::infinite_wait ).extracted() );
+	REQUIRE( extraction_status_t::chain_closed == ch.receive_bulk(
+			buffer.begin(), buffer.size(), so_5::infinite_wait ).status() );
+}
+
+TEST_CASE( "bulk receive" )
+{
+	check_bulk_receive< lf_ns::producers_t::single >();
+	check_bulk_receive< lf_ns::producers_t::multiple >();
+}
+
+TEST_CASE( "bulk receive with a throwing receiver" )
+{
+	struct throwing_it_t
+	{
+		int * m_assigned;
+
+		throwing_it_t & operator*() { return *this; }
+		throwing_it_t & operator++() { return *this; }
+		throwing_it_t &
+		operator=( item_t item )
+		{
+			if( 2 == item.m_value )
+				throw std::runtime_error{ "receiver failure" };
+			++(*m_assigned);
+			return *this;
+		}
+	};
+
+	lf_ns::channel_t< item_t, 4 > ch;
+	for( int i = 0; i != 4; ++i )
+		REQUIRE( ch.try_send( item_t{ 0, i } ) );
+
+	int assigned = 0;
+	REQUIRE_THROWS_AS(
+			ch.try_receive_bulk( throwing_it_t{ &assigned }, 4u ),
+			std::runtime_error );
+	REQUIRE( 2 == assigned );
+
+	// Extracted payloads are removed from the channel.
+	REQUIRE( 1u == ch.size_approx() );
+	item_t item{};
+	REQUIRE( ch.try_receive( item ) );
+	REQUIRE( 3 == item.m_value );
+}
+
+template< lf_ns::producers_t Producers >
+void
+check_bulk_send()
+{
+	using so_5::mchain_props::overflow_reaction_t;
+
+	lf_ns::channel_t< item_t, 8, Producers > ch;
+
+	std::vector< item_t > items;
+	for( int i = 0; i != 6; ++i )
+		items.push_back( item_t{ 0, i } );
+
+	REQUIRE( 0u == ch.send_bulk( items.begin(), items.begin(),
+			overflow_reaction_t::throw_exception ) );
+	REQUIRE( 6u == ch.send_bulk( items.begin(), items.end(),
+			overflow_reaction_t::throw_exception ) );
+
+	// There is no place for all items. Nothing is sent.
+	try
+	{
+		(void)ch.send_bulk( items.begin(), items.end(),
+				overflow_reaction_t::throw_exception );
+		FAIL( "an exception is expected" );
+	}
+	catch( const so_5::exception_t & x )
+	{
+		REQUIRE( lf_ns::errors::rc_channel_overflow == x.error_code() );
+	}
+	REQUIRE( 6u == ch.size_approx() );
+
+	REQUIRE_THROWS_AS(
+			ch.send_bulk( items.begin(), items.end(),
+					overflow_reaction_t::remove_oldest ),
+			so_5::exception_t );
+
+	// Only items those fit are sent.
+	REQUIRE( 2u == ch.send_bulk( items.begin(), items.end(),
+			overflow_reaction_t::drop_newest ) );
+	REQUIRE( 0u == ch.send_bulk( items.begin(), items.end(),
+			overflow_reaction_t::drop_newest ) );
+
+	// Items are received as separate payloads.
+	item_t item{};
+	for( int i = 0; i != 6; ++i )
+	{
+		REQUIRE( ch.try_receive( item ) );
+		REQUIRE( i == item.m_value );
+	}
+	for( int i = 0; i != 2; ++i )
+	{
+		REQUIRE( ch.try_receive( item ) );
+		REQUIRE( i == item.m_value );
+	}
+	REQUIRE( !ch.try_receive( item ) );
+
+	// Positions wrap around the end of the ring.
+	REQUIRE( 6u == ch.send_bulk( items.begin(), items.end(),
+			overflow_reaction_t::throw_exception ) );
+	for( int i = 0; i != 6; ++i )
+	{
+		REQUIRE( ch.try_receive( item ) );
+		REQUIRE( i == item.m_value );
+	}
+
+	ch.close();
+	REQUIRE( 0u == ch.send_bulk( items.begin(), items.end(),
+			overflow_reaction_t::throw_exception ) );
+}
+
+TEST_CASE( "bulk send" )
+{
+	check_bulk_send< lf_ns::producers_t::single >();
+	check_bulk_send< lf_ns::producers_t::multiple >();
+}
+
+TEST_CASE( "bulk send of movable payloads" )
+{
+	lf_ns::channel_t< std::unique_ptr< int >, 4 > ch;
+
+	std::vector< std::unique_ptr< int > > items;
+	items.push_back( std::make_unique< int >( 1 ) );
+	items.push_back( std::make_unique< int >( 2 ) );
+
+	REQUIRE( 2u == ch.send_bulk(
+			std::make_move_iterator( items.begin() ),
+			std::make_move_iterator( items.end() ),
+			so_5::mchain_props::overflow_reaction_t::throw_exception ) );
+	REQUIRE( !items[ 0 ] );
+
+	std::unique_ptr< int > item;
+	REQUIRE( ch.try_receive( item ) );
+	REQUIRE( 1 == *item );
+	REQUIRE( ch.try_receive( item ) );
+	REQUIRE( 2 == *item );
+}
+
+TEST_CASE( "single producer" )
+{
+	run_with_time_limit( [] {
+			lf_ns::channel_t< item_t, 64 > ch;
+
+			constexpr int items = 100000;
+
+			std::thread producer{ [&ch] {
+					for( int i = 0; i != items; )
+					{
+						if( ch.try_send( item_t{ 0, i } ) )
+							++i;
+						else
+							std::this_thread::yield();
+					}
+					ch.close();
+				} };
+
+			int expected = 0;
+			item_t item{};
+			while( extraction_status_t::chain_closed !=
+					ch.receive( item, so_5::infinite_wait ) )
+			{
+				REQUIRE( expected == item.m_value );
+				++expected;
+			}
+			REQUIRE( items == expected );
+
+			producer.join();
+		},
+		20 );
+}
+
+TEST_CASE( "several producers" )
+{
+	run_with_time_limit( [] {
+			lf_ns::channel_t< item_t, 64, lf_ns::producers_t::multiple > ch;
+
+			constexpr int producers = 3;
+			constexpr int items = 30000;
+
+			std::vector< std::thread > threads;
+			for( int p = 0; p != producers; ++p )
+				threads.emplace_back( [&ch, p] {
+						for( int i = 0; i != items; )
+						{
+							if( ch.try_send( item_t{ p, i } ) )
+								++i;
+							else
+								std::this_thread::yield();
+						}
+					} );
+			// This producer sends items in batches.
+			threads.emplace_back( [&ch] {
+					std::array< item_t, 7 > batch{};
+					for( int i = 0; i != items; )
+					{
+						const auto n = (std::min)( 7, items - i );
+						for( int j = 0; j != n; ++j )
+							batch[ j ] = item_t{ producers, i + j };
+
+						const auto sent = ch.send_bulk( batch.begin(), batch.begin() + n,
+								so_5::mchain_props::overflow_reaction_t::drop_newest );
+						if( sent )
+							i += static_cast< int >( sent );
+						else
+							std::this_thread::yield();
+					}
+				} );
+
+			std::array< int, producers + 1 > expected{};
+			std::array< item_t, 16 > buffer{};
+			for( int received = 0; received != (producers + 1) * items; )
+			{
+				const auto r = ch.receive_bulk(
+						buffer.begin(), buffer.size(), so_5::infinite_wait );
+				REQUIRE( extraction_status_t::msg_extracted == r.status() );
+				for( std::size_t i = 0u; i != r.extracted(); ++i )
+				{
+					const auto & item = buffer[ i ];
+					REQUIRE( expected[ item.m_producer ] == item.m_value );
+					++expected[ item.m_producer ];
+				}
+				received += static_cast< int >( r.extracted() );
+			}
+
+			for( auto & t : threads )
+				t.join();
+		},
+		20 );
+}
@@ -0,0 +1,114 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN 
+#include <doctest/doctest.h>
+
+#include <so_5_extra/mchains/priority.hpp>
+
+#include <so_5/all.hpp>
+
+#include <test/3rd_party/various_helpers/time_limited_execution.hpp>
+
+namespace priority_ns = so_5::extra::mchains::priority;
+
+struct msg_cancel final : public so_5::signal_t {};
+
+struct msg_config final : public so_5::message_t
+{
+	int m_value;
+
+	explicit msg_config( int value ) : m_value{ value } {}
+};
+
+TEST_CASE( "simple" )
+{
+	run_with_time_limit( [] {
+			so_5::launch( [&](so_5::environment_t & env) {
+					auto ch = priority_ns::create_mchain<
+							priority_ns::lane_t< msg_cancel >,
+							priority_ns::lane_t< so_5::mutable_msg< msg_config > >
+						>(
+							env,
+							so_5::make_unlimited_mchain_params() );
+
+					so_5::send< int >( ch, 0 );
+					so_5::send< int >( ch, 1 );
+					so_5::send< so_5::mutable_msg< msg_config > >( ch, 2 );
+					so_5::send< int >( ch, 3 );
+					so_5::send< msg_cancel >( ch );
+					so_5::send< so_5::mutable_msg< msg_config > >( ch, 4 );
+
+					std::string trace;
+					so_5::receive( so_5::from(ch).handle_all().no_wait_on_empty(),
+						[&trace]( so_5::mhood_t<msg_cancel> ) {
+							trace += "cancel;";
+						},
+						[&trace]( so_5::mutable_mhood_t<msg_config> cmd ) {
+							trace += "config:" + std::to_string( cmd->m_value ) + ";";
+						},
+						[&trace]( int v ) {
+							trace += "int:" + std::to_string( v ) + ";";
+						} );
+
+					REQUIRE( trace ==
+							"cancel;config:2;config:4;int:0;int:1;int:3;" );
+				},
+				[](so_5::environment_params_t & params) {
+					params.message_delivery_tracer(
+							so_5::msg_tracing::std_cout_tracer() );
+				} );
+		},
+		5 );
+}
+
+TEST_CASE( "limited capacity" )
+{
+	run_with_time_limit( [] {
+			so_5::launch( [&](so_5::environment_t & env) {
+					auto ch = priority_ns::create_mchain<
+							priority_ns::lane_t< msg_cancel >
+						>(
+							env,
+							so_5::make_limited_without_waiting_mchain_params(
+									3,
+									so_5::mchain_props::memory_usage_t::dynamic,
+									so_5::mchain_props::overflow_reaction_t::drop_newest ) );
+
+					so_5::send< int >( ch, 0 );
+					so_5::send< int >( ch, 1 );
+					so_5::send< msg_cancel >( ch );
+					// Should be dropped.
+					so_5::send< int >( ch, 2 );
+					REQUIRE( 3u == ch->size() );
+
+					std::string trace;
+					so_5::receive( so_5::from(ch).handle_all().no_wait_on_empty(),
+						[&trace]( so_5::mhood_t<msg_cancel> ) {
+							trace += "cancel;";
+						},
+						[&trace]( int v ) {
+							trace += "int:" + std::to_string( v ) + ";";
+						} );
+
+					REQUIRE( trace == "cancel;int:0;int:1;" );
+				} );
+		},
+		5 );
+}
+
+TEST_CASE( "remove_oldest is rejected" )
+{
+	run_with_time_limit( [] {
+			so_5::launch( [&](so_5::environment_t & env) {
+					REQUIRE_THROWS_AS(
+							priority_ns::create_mchain<
+									priority_ns::lane_t< msg_cancel >
+								>(
+									env,
+									so_5::make_limited_without_waiting_mchain_params(
+											3,
+											so_5::mchain_props::memory_usage_t::dynamic,
+											so_5::mchain_props::overflow_reaction_t::remove_oldest ) ),
+							so_5::exception_t );
+				} );
+		},
+		5 );
+}
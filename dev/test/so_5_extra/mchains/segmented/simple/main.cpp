@@ -0,0 +1,91 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN 
+#include <doctest/doctest.h>
+
+#include <so_5_extra/mchains/segmented.hpp>
+
+#include <so_5/all.hpp>
+
+#include <test/3rd_party/various_helpers/time_limited_execution.hpp>
+
+namespace segmented_ns = so_5::extra::mchains::segmented;
+
+using namespace std::chrono_literals;
+
+TEST_CASE( "queue" )
+{
+	using queue_t = segmented_ns::details::demand_queue_t< 4u, 1u >;
+
+	queue_t queue{ so_5::mchain_props::capacity_t::make_unlimited() };
+
+	REQUIRE( queue.is_empty() );
+	REQUIRE( 0u == queue.allocated_chunks() );
+
+	for( int i = 0; i != 10; ++i )
+		queue.push_back( so_5::mchain_props::demand_t{} );
+
+	REQUIRE( 10u == queue.size() );
+	REQUIRE( !queue.is_full() );
+	REQUIRE( 3u == queue.allocated_chunks() );
+
+	for( int i = 0; i != 9; ++i )
+		queue.pop_front();
+
+	// The last chunk is in use, one chunk is kept as spare.
+	REQUIRE( 1u == queue.size() );
+	REQUIRE( 2u == queue.allocated_chunks() );
+
+	queue.pop_front();
+	REQUIRE( queue.is_empty() );
+	REQUIRE( 2u == queue.allocated_chunks() );
+}
+
+TEST_CASE( "unlimited mchain" )
+{
+	run_with_time_limit( [] {
+			so_5::launch( [&](so_5::environment_t & env) {
+					auto ch = segmented_ns::create_mchain< 4u >( env );
+
+					for( int i = 0; i != 100; ++i )
+						so_5::send< int >( ch, i );
+					REQUIRE( 100u == ch->size() );
+
+					int expected = 0;
+					so_5::receive( so_5::from(ch).handle_all().no_wait_on_empty(),
+						[&expected](int v) { REQUIRE( expected == v ); ++expected; } );
+
+					REQUIRE( 100 == expected );
+					REQUIRE( 0u == ch->size() );
+				},
+				[](so_5::environment_params_t & params) {
+					params.message_delivery_tracer(
+							so_5::msg_tracing::std_cout_tracer() );
+				} );
+		},
+		5 );
+}
+
+TEST_CASE( "limited mchain" )
+{
+	run_with_time_limit( [] {
+			so_5::launch( [&](so_5::environment_t & env) {
+					auto ch = segmented_ns::create_mchain< 2u >(
+							env,
+							so_5::make_limited_without_waiting_mchain_params(
+									5,
+									so_5::mchain_props::memory_usage_t::dynamic,
+									so_5::mchain_props::overflow_reaction_t::remove_oldest ) );
+
+					for( int i = 0; i != 8; ++i )
+						so_5::send< int >( ch, i );
+					REQUIRE( 5u == ch->size() );
+
+					int expected = 3;
+					so_5::receive( so_5::from(ch).handle_all().no_wait_on_empty(),
+						[&expected](int v) { REQUIRE( expected == v ); ++expected; } );
+
+					REQUIRE( 8 == expected );
+				} );
+		},
+		5 );
+}
+
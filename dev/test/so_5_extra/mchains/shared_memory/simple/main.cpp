@@ -0,0 +1,226 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN 
+#include <doctest/doctest.h>
+
+#include <so_5_extra/mchains/shared_memory.hpp>
+
+#include <so_5/all.hpp>
+
+#include <test/3rd_party/various_helpers/time_limited_execution.hpp>
+
+#include <sys/wait.h>
+
+namespace shm_ns = so_5::extra::mchains::shared_memory;
+
+struct item_t
+{
+	int m_producer;
+	int m_value;
+};
+
+using channel_t = shm_ns::channel_t< item_t, 64 >;
+
+// A payload without the default constructor.
+struct point_t
+{
+	int m_x;
+	int m_y;
+
+	point_t( int x, int y ) : m_x{ x }, m_y{ y } {}
+};
+
+using points_channel_t = shm_ns::channel_t< point_t, 16 >;
+
+// Run a function in a child process and return the child's exit code.
+template< typename F >
+[[nodiscard]] int
+run_in_child( F && f )
+{
+	const pid_t pid = ::fork();
+	REQUIRE( -1 != pid );
+	if( 0 == pid )
+	{
+		// Destructors and doctest's handlers must not be called in the child.
+		int code = 1;
+		try
+		{
+			code = f();
+		}
+		catch( ... )
+		{}
+		::_exit( code );
+	}
+
+	int status = 0;
+	REQUIRE( pid == ::waitpid( pid, &status, 0 ) );
+	REQUIRE( WIFEXITED( status ) );
+	return WEXITSTATUS( status );
+}
+
+[[nodiscard]] std::string
+make_name( const char * suffix )
+{
+	return "/so5extra_test_shm_" + std::to_string( ::getpid() ) + suffix;
+}
+
+TEST_CASE( "open checks" )
+{
+	const auto name = make_name( "_open" );
+
+	REQUIRE_THROWS_AS( channel_t::open( name ), so_5::exception_t );
+
+	{
+		auto consumer = channel_t::create( name );
+
+		REQUIRE_THROWS_AS( channel_t::create( name ), so_5::exception_t );
+		REQUIRE_THROWS_AS(
+				(shm_ns::channel_t< item_t, 128 >::open( name )),
+				so_5::exception_t );
+
+		auto producer = channel_t::open( name );
+		REQUIRE( producer.try_send( item_t{ 0, 1 } ) );
+		REQUIRE( 1u == consumer.size_approx() );
+
+		item_t item{};
+		REQUIRE( consumer.try_receive( item ) );
+		REQUIRE( 1 == item.m_value );
+		REQUIRE( !consumer.try_receive( item ) );
+	}
+
+	// The object is removed by the creator.
+	REQUIRE_THROWS_AS( channel_t::open( name ), so_5::exception_t );
+}
+
+TEST_CASE( "full channel" )
+{
+	auto consumer = channel_t::create( make_name( "_full" ) );
+
+	for( int i = 0; i != 64; ++i )
+		REQUIRE( consumer.try_send( item_t{ 0, i } ) );
+	REQUIRE( !consumer.try_send( item_t{ 0, 64 } ) );
+
+	item_t item{};
+	REQUIRE( consumer.try_receive( item ) );
+	REQUIRE( 0 == item.m_value );
+	REQUIRE( consumer.try_send( item_t{ 0, 64 } ) );
+}
+
+TEST_CASE( "dispatch from several producers" )
+{
+	run_with_time_limit( [] {
+			so_5::wrapped_env_t sobj;
+
+			const auto name = make_name( "_dispatch" );
+			auto consumer = channel_t::create( name );
+			auto ch = so_5::create_mchain( sobj );
+
+			constexpr int producers = 3;
+			constexpr int items = 10000;
+
+			std::vector< std::thread > threads;
+			for( int p = 0; p != producers; ++p )
+				threads.emplace_back( [&name, p] {
+						auto producer = channel_t::open( name );
+						for( int i = 0; i != items; )
+						{
+							if( producer.try_send( item_t{ p, i } ) )
+								++i;
+							else
+								std::this_thread::yield();
+						}
+					} );
+
+			std::array< int, producers > expected{};
+			int received = 0;
+			while( received != producers * items )
+			{
+				shm_ns::dispatch( consumer, ch, 32u );
+				received += static_cast< int >( so_5::receive(
+						so_5::from( ch ).handle_all().no_wait_on_empty(),
+						[&expected]( const item_t & item ) {
+							REQUIRE( expected[ item.m_producer ] == item.m_value );
+							++expected[ item.m_producer ];
+						} ).handled() );
+			}
+
+			for( auto & t : threads )
+				t.join();
+		},
+		10 );
+}
+
+TEST_CASE( "producer in another process" )
+{
+	const auto name = make_name( "_fork" );
+	auto consumer = channel_t::create( name );
+
+	REQUIRE( 0 == run_in_child( [&name] {
+			auto producer = channel_t::open( name );
+			for( int i = 0; i != 10; ++i )
+				if( !producer.try_send( item_t{ 1, i } ) )
+					return 2;
+			return 0;
+		} ) );
+
+	item_t item{};
+	for( int i = 0; i != 10; ++i )
+	{
+		REQUIRE( consumer.try_receive( item ) );
+		REQUIRE( 1 == item.m_producer );
+		REQUIRE( i == item.m_value );
+	}
+	REQUIRE( !consumer.try_receive( item ) );
+}
+
+TEST_CASE( "crashed creator" )
+{
+	const auto name = make_name( "_crash" );
+
+	// The child creates the channel and exits without its destruction.
+	REQUIRE( 0 == run_in_child( [&name]() -> int {
+			auto creator = channel_t::create( name );
+			(void)creator.try_send( item_t{ 0, 42 } );
+			::_exit( 0 );
+		} ) );
+
+	// The object is still available for producers...
+	{
+		auto producer = channel_t::open( name );
+		REQUIRE( 1u == producer.size_approx() );
+	}
+
+	// ...but a new channel with the same name can't be created.
+	try
+	{
+		auto consumer = channel_t::create( name );
+		FAIL( "an exception is expected" );
+	}
+	catch( const so_5::exception_t & x )
+	{
+		REQUIRE( shm_ns::errors::rc_shm_already_exists == x.error_code() );
+	}
+
+	REQUIRE( channel_t::remove( name ) );
+	REQUIRE( !channel_t::remove( name ) );
+
+	auto consumer = channel_t::create( name );
+	REQUIRE( 0u == consumer.size_approx() );
+}
+
+TEST_CASE( "dispatch of not default constructible payload" )
+{
+	run_with_time_limit( [] {
+			so_5::wrapped_env_t sobj;
+
+			auto consumer = points_channel_t::create( make_name( "_points" ) );
+			auto ch = so_5::create_mchain( sobj );
+
+			REQUIRE( consumer.try_send( point_t{ 1, 2 } ) );
+			REQUIRE( 1u == shm_ns::dispatch( consumer, ch, 8u ) );
+
+			int sum = 0;
+			so_5::receive( so_5::from( ch ).handle_all().no_wait_on_empty(),
+					[&sum]( const point_t & p ) { sum = p.m_x + p.m_y; } );
+			REQUIRE( 3 == sum );
+		},
+		5 );
+}
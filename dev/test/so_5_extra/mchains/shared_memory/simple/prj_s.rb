@@ -0,0 +1,16 @@
+require 'mxx_ru/cpp'
+
+MxxRu::Cpp::exe_target {
+
+	required_prj 'so_5/prj_s.rb'
+
+	target '_unit.test.so_5_extra.mchains.shared_memory.simple_s'
+
+	cpp_source 'main.cpp'
+
+	# shm_open is in librt for older versions of glibc.
+	if 'linux' == toolset.tag( 'unix_port', 'undefined' )
+		lib 'rt'
+	end
+}
+
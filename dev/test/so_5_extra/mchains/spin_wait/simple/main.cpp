@@ -0,0 +1,172 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN 
+#include <doctest/doctest.h>
+
+#include <so_5_extra/mchains/spin_wait.hpp>
+#include <so_5_extra/mchains/fixed_size.hpp>
+
+#include <so_5/all.hpp>
+
+#include <test/3rd_party/various_helpers/time_limited_execution.hpp>
+
+namespace spin_ns = so_5::extra::mchains::spin_wait;
+
+using namespace std::chrono_literals;
+
+TEST_CASE( "spin then park" )
+{
+	run_with_time_limit( [] {
+			so_5::wrapped_env_t sobj;
+
+			spin_ns::waiter_t waiter{
+					spin_ns::strategy_t{}.spins( 10000u ).yields( 100u ) };
+
+			auto ch = spin_ns::create_mchain(
+					sobj.environment(),
+					waiter,
+					so_5::make_unlimited_mchain_params() );
+
+			// There is no messages yet.
+			REQUIRE( !waiter.wait_not_empty( ch ) );
+
+			std::thread producer{ [ch] {
+					for( int i = 0; i != 100; ++i )
+					{
+						so_5::send< int >( ch, i );
+						if( 0 == i % 10 )
+							std::this_thread::sleep_for( 1ms );
+					}
+				} };
+
+			int expected = 0;
+			while( expected != 100 )
+			{
+				const auto r = waiter.receive(
+						so_5::from(ch).handle_n( 1u ).empty_timeout( 1s ),
+						[&expected]( int v ) {
+							REQUIRE( expected == v );
+							++expected;
+						} );
+				REQUIRE( 1u == r.handled() );
+			}
+
+			producer.join();
+		},
+		5 );
+}
+
+TEST_CASE( "handle_all until close" )
+{
+	run_with_time_limit( [] {
+			so_5::wrapped_env_t sobj;
+
+			spin_ns::waiter_t waiter{
+					spin_ns::strategy_t{}.spins( 1000u ).yields( 10u ) };
+
+			auto ch = spin_ns::create_mchain(
+					sobj.environment(),
+					waiter,
+					so_5::make_unlimited_mchain_params() );
+
+			std::thread producer{ [ch] {
+					for( int i = 0; i != 1000; ++i )
+					{
+						so_5::send< int >( ch, i );
+						if( 0 == i % 50 )
+							std::this_thread::sleep_for( 1ms );
+					}
+					so_5::close_retain_content( so_5::exceptions_enabled, ch );
+				} };
+
+			// Messages arrive in several portions, all of them should be
+			// handled by one call.
+			int expected = 0;
+			const auto r = waiter.receive(
+					so_5::from(ch).handle_all(),
+					[&expected]( int v ) {
+						REQUIRE( expected == v );
+						++expected;
+					} );
+
+			producer.join();
+
+			REQUIRE( 1000u == r.handled() );
+			REQUIRE( so_5::mchain_props::extraction_status_t::chain_closed ==
+					r.status() );
+		},
+		5 );
+}
+
+TEST_CASE( "handle_n and empty_timeout" )
+{
+	run_with_time_limit( [] {
+			so_5::wrapped_env_t sobj;
+
+			spin_ns::waiter_t waiter{ spin_ns::strategy_t{}.spins( 1000u ) };
+
+			auto ch = spin_ns::create_mchain(
+					sobj.environment(),
+					waiter,
+					so_5::make_unlimited_mchain_params() );
+
+			std::thread producer{ [ch] {
+					for( int i = 0; i != 100; ++i )
+					{
+						so_5::send< int >( ch, i );
+						if( 0 == i % 10 )
+							std::this_thread::sleep_for( 2ms );
+					}
+				} };
+
+			auto r = waiter.receive(
+					so_5::from(ch).handle_n( 60u ).empty_timeout( 1s ),
+					[]( int ) {} );
+			REQUIRE( 60u == r.handled() );
+
+			producer.join();
+
+			r = waiter.receive(
+					so_5::from(ch).handle_all().empty_timeout( 20ms ),
+					[]( int ) {} );
+			REQUIRE( 40u == r.handled() );
+
+			// There is no more messages.
+			r = waiter.receive(
+					so_5::from(ch).handle_all().empty_timeout( 20ms ),
+					[]( int ) {} );
+			REQUIRE( 0u == r.handled() );
+			REQUIRE( so_5::mchain_props::extraction_status_t::no_messages ==
+					r.status() );
+		},
+		5 );
+}
+
+TEST_CASE( "old notificator is kept" )
+{
+	run_with_time_limit( [] {
+			so_5::wrapped_env_t sobj;
+
+			spin_ns::waiter_t waiter{ spin_ns::strategy_t{}.spins( 100u ) };
+
+			int notifications = 0;
+
+			auto params = so_5::make_limited_without_waiting_mchain_params(
+					4, // Will be ignored.
+					so_5::mchain_props::memory_usage_t::preallocated, // Will be ignored.
+					so_5::mchain_props::overflow_reaction_t::drop_newest );
+			params.not_empty_notificator( [&notifications] { ++notifications; } );
+
+			auto ch = so_5::extra::mchains::fixed_size::create_mchain<4>(
+					sobj.environment(),
+					waiter.tune( params ) );
+
+			so_5::send< int >( ch, 0 );
+			REQUIRE( 1 == notifications );
+			REQUIRE( waiter.wait_not_empty( ch ) );
+
+			so_5::receive( so_5::from(ch).handle_all().no_wait_on_empty(),
+					[]( int ) {} );
+			REQUIRE( !waiter.wait_not_empty( ch ) );
+		},
+		5 );
+}
+
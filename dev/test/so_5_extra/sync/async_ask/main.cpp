@@ -0,0 +1,125 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN 
+#include <doctest/doctest.h>
+
+#include <so_5_extra/sync/async_ask.hpp>
+
+#include <so_5/all.hpp>
+
+#include <test/3rd_party/various_helpers/time_limited_execution.hpp>
+
+namespace sync_ns = so_5::extra::sync;
+
+using namespace std::chrono_literals;
+
+using ask_t = sync_ns::request_reply_t<int, std::string>;
+
+class service_t final : public so_5::agent_t
+	{
+		//! Requests that won't be replied.
+		std::vector< ask_t::holder_t > m_ignored;
+
+	public :
+		service_t( context_t ctx ) : so_5::agent_t{ std::move(ctx) }
+			{
+				so_subscribe_self().event( &service_t::on_request );
+			}
+
+	private :
+		void
+		on_request( ask_t::request_mhood_t cmd )
+			{
+				if( 0 == cmd->request() )
+					m_ignored.push_back( cmd.make_holder() );
+				else
+					cmd->make_reply( std::to_string( cmd->request() ) );
+			}
+	};
+
+class client_t final : public so_5::agent_t
+	{
+		struct check_cancelled final : public so_5::signal_t {};
+
+		const so_5::mbox_t m_service;
+		std::vector< std::string > & m_results;
+
+		void
+		store( std::optional< std::string > r )
+			{
+				m_results.push_back( r ? *r : std::string{ "<none>" } );
+			}
+
+	public :
+		client_t(
+			context_t ctx,
+			so_5::mbox_t service,
+			std::vector< std::string > & results )
+			:	so_5::agent_t{ std::move(ctx) }
+			,	m_service{ std::move(service) }
+			,	m_results{ results }
+			{
+				so_subscribe_self().event( [this]( mhood_t< check_cancelled > ) {
+						so_deregister_agent_coop_normally();
+					} );
+			}
+
+		void
+		so_evt_start() override
+			{
+				// NOTE: the client and the service work on the same thread.
+				// A blocking request would lead to a deadlock.
+				sync_ns::async_ask< int, std::string >(
+						*this, m_service, 5s,
+						[this]( std::optional< std::string > r ) {
+							store( std::move(r) );
+							on_first_reply();
+						},
+						1 );
+			}
+
+	private :
+		void
+		on_first_reply()
+			{
+				sync_ns::async_ask< int, std::string >(
+						*this, so_default_state(), m_service, 100ms,
+						[this]( std::optional< std::string > r ) {
+							store( std::move(r) );
+							on_timeout();
+						},
+						0 );
+			}
+
+		void
+		on_timeout()
+			{
+				auto cp = sync_ns::async_ask< int, std::string >(
+						*this, m_service, 5s,
+						[this]( std::optional< std::string > r ) {
+							store( std::move(r) );
+						},
+						3 );
+				cp.cancel();
+
+				// The reply (if any) will be handled before this signal.
+				so_5::send_delayed< check_cancelled >( *this, 50ms );
+			}
+	};
+
+TEST_CASE( "async_ask" )
+{
+	std::vector< std::string > results;
+
+	run_with_time_limit( [&results] {
+			so_5::launch( [&results]( so_5::environment_t & env ) {
+					env.introduce_coop( [&results]( so_5::coop_t & coop ) {
+							auto svc = coop.make_agent< service_t >();
+							coop.make_agent< client_t >(
+									svc->so_direct_mbox(), results );
+						} );
+				} );
+		},
+		5 );
+
+	REQUIRE( std::vector< std::string >{ "1", "<none>" } == results );
+}
+
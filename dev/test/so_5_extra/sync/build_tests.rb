@@ -25,6 +25,18 @@ MxxRu::Cpp::composite_target {
 	required_prj( "#{path}/reply_timeout/prj.ut.rb" )
 	required_prj( "#{path}/reply_timeout/prj_s.ut.rb" )
 
+	required_prj( "#{path}/reply_slot_cache/prj.ut.rb" )
+	required_prj( "#{path}/reply_slot_cache/prj_s.ut.rb" )
+
+	required_prj( "#{path}/reply_slot/prj.ut.rb" )
+	required_prj( "#{path}/reply_slot/prj_s.ut.rb" )
+
+	required_prj( "#{path}/async_ask/prj.ut.rb" )
+	required_prj( "#{path}/async_ask/prj_s.ut.rb" )
+
+	required_prj( "#{path}/gather/prj.ut.rb" )
+	required_prj( "#{path}/gather/prj_s.ut.rb" )
+
 	required_prj( "#{path}/reply_to_mbox/prj.ut.rb" )
 	required_prj( "#{path}/reply_to_mbox/prj_s.ut.rb" )
 
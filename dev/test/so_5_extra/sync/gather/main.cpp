@@ -0,0 +1,159 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN 
+#include <doctest/doctest.h>
+
+#include <so_5_extra/sync/pub.hpp>
+
+#include <so_5/all.hpp>
+
+#include <test/3rd_party/various_helpers/time_limited_execution.hpp>
+
+#include <algorithm>
+
+namespace sync_ns = so_5::extra::sync;
+
+using namespace std::chrono_literals;
+
+using ask_t = sync_ns::request_reply_t<int, int>;
+
+class service_t final : public so_5::agent_t
+	{
+		const int m_id;
+
+	public :
+		service_t( context_t ctx, int id )
+			:	so_5::agent_t{ std::move(ctx) }
+			,	m_id{ id }
+			{
+				so_subscribe_self().event( &service_t::on_request );
+			}
+
+	private :
+		void
+		on_request( ask_t::request_mhood_t cmd )
+			{
+				// Negative id means that the request should be ignored.
+				if( m_id > 0 )
+					cmd->make_reply( cmd->request() + m_id );
+			}
+	};
+
+[[nodiscard]]
+std::vector< so_5::mbox_t >
+make_services(
+	so_5::environment_t & env,
+	std::initializer_list< int > ids )
+	{
+		return env.introduce_coop(
+				so_5::disp::active_obj::make_dispatcher( env ).binder(),
+				[ids]( so_5::coop_t & coop ) {
+					std::vector< so_5::mbox_t > result;
+					for( const int id : ids )
+						result.push_back(
+								coop.make_agent< service_t >( id )->so_direct_mbox() );
+					return result;
+				} );
+	}
+
+TEST_CASE( "the first reply is returned" )
+{
+	run_with_time_limit( [] {
+			so_5::wrapped_env_t sobj;
+
+			auto fast = so_5::create_mchain( sobj );
+			auto slow = so_5::create_mchain( sobj );
+
+			std::thread slow_replier{ [slow] {
+					so_5::receive( so_5::from( slow ).handle_n( 1 ),
+							[]( ask_t::request_mhood_t cmd ) {
+								auto holder = cmd.make_holder();
+								std::this_thread::sleep_for( 200ms );
+								// This reply is discarded.
+								holder->make_reply( 2 );
+							} );
+				} };
+
+			std::thread fast_replier{ [fast] {
+					so_5::receive( so_5::from( fast ).handle_n( 1 ),
+							[]( ask_t::request_mhood_t cmd ) {
+								cmd->make_reply( 1 );
+							} );
+				} };
+
+			const std::vector< so_5::mchain_t > targets{ slow, fast };
+			auto r = ask_t::ask_first_opt_value( targets, 5s, 0 );
+
+			fast_replier.join();
+			slow_replier.join();
+
+			REQUIRE( r );
+			REQUIRE( 1 == *r );
+		},
+		5 );
+}
+
+TEST_CASE( "no first reply" )
+{
+	run_with_time_limit( [] {
+			so_5::wrapped_env_t sobj;
+
+			const auto targets = make_services( sobj.environment(), { -1, -2 } );
+
+			// All requests are ignored, so there is no need to wait
+			// for the timeout.
+			auto r = sync_ns::request_first_opt_reply< int, int >(
+					targets, 1h, 0 );
+
+			REQUIRE( !r );
+		},
+		5 );
+}
+
+TEST_CASE( "all replies are collected" )
+{
+	run_with_time_limit( [] {
+			so_5::wrapped_env_t sobj;
+
+			const auto targets = make_services(
+					sobj.environment(), { 1, -1, 2, 3 } );
+
+			// The ignored request doesn't prolong the waiting.
+			auto r = sync_ns::request_all_replies< int, int >(
+					targets, 1h, 10 );
+
+			std::sort( r.begin(), r.end() );
+			REQUIRE( std::vector< int >{ 11, 12, 13 } == r );
+		},
+		5 );
+}
+
+TEST_CASE( "replies until the deadline" )
+{
+	run_with_time_limit( [] {
+			so_5::wrapped_env_t sobj;
+
+			// Nobody reads from that chain.
+			auto silent = so_5::create_mchain( sobj );
+			auto svc = make_services( sobj.environment(), { 1 } ).front();
+
+			const so_5::mbox_t targets[] = { svc, silent->as_mbox() };
+			auto r = ask_t::ask_all_values( targets, 100ms, 1 );
+
+			REQUIRE( std::vector< int >{ 2 } == r );
+
+			// The late reply is discarded.
+			so_5::receive( so_5::from( silent ).handle_n( 1 ).no_wait_on_empty(),
+					[]( ask_t::request_mhood_t cmd ) {
+						cmd->make_reply( 0 );
+					} );
+		},
+		5 );
+}
+
+TEST_CASE( "empty list of targets" )
+{
+	const std::vector< so_5::mbox_t > targets;
+
+	REQUIRE( !ask_t::ask_first_opt_value( targets, 1h, 0 ) );
+	REQUIRE( ask_t::ask_all_values( targets, 1h, 0 ).empty() );
+}
+
@@ -0,0 +1,90 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN 
+#include <doctest/doctest.h>
+
+#include <so_5_extra/sync/pub.hpp>
+
+#include <so_5/all.hpp>
+
+#include <test/3rd_party/various_helpers/time_limited_execution.hpp>
+
+namespace sync_ns = so_5::extra::sync;
+
+using namespace std::chrono_literals;
+
+using ask_t = sync_ns::request_reply_t<int, std::unique_ptr<int>>;
+
+class service_t final : public so_5::agent_t
+	{
+	public :
+		service_t( context_t ctx ) : so_5::agent_t{ std::move(ctx) }
+			{
+				so_subscribe_self().event( &service_t::on_request );
+			}
+
+	private :
+		void
+		on_request( ask_t::request_mhood_t cmd )
+			{
+				cmd->make_reply( std::make_unique<int>( cmd->request() * 2 ) );
+
+				// The second reply is prohibited.
+				REQUIRE_THROWS_AS(
+						cmd->make_reply( std::make_unique<int>( 0 ) ),
+						so_5::exception_t );
+			}
+	};
+
+TEST_CASE( "many requests from several threads" )
+{
+	run_with_time_limit( [] {
+			so_5::wrapped_env_t sobj;
+
+			auto svc = sobj.environment().introduce_coop(
+					[]( so_5::coop_t & coop ) {
+						return coop.make_agent< service_t >()->so_direct_mbox();
+					} );
+
+			std::vector< std::thread > threads;
+			for( int t = 0; t != 4; ++t )
+				threads.emplace_back( [svc, t] {
+						for( int i = 0; i != 1000; ++i )
+							{
+								const int v = t * 1000 + i;
+								auto r = ask_t::ask_value( svc, 5s, v );
+								REQUIRE( r );
+								REQUIRE( v * 2 == *r );
+							}
+					} );
+
+			for( auto & t : threads )
+				t.join();
+		},
+		20 );
+}
+
+TEST_CASE( "reply from another thread" )
+{
+	run_with_time_limit( [] {
+			so_5::wrapped_env_t sobj;
+
+			auto ch = so_5::create_mchain( sobj );
+
+			std::thread replier{ [ch] {
+					so_5::receive( so_5::from( ch ).handle_n( 1 ),
+							[]( ask_t::request_mhood_t cmd ) {
+								auto holder = cmd.make_holder();
+								std::this_thread::sleep_for( 50ms );
+								holder->make_reply( std::make_unique<int>( 42 ) );
+							} );
+				} };
+
+			auto r = ask_t::ask_opt_value( ch, 5s, 0 );
+			replier.join();
+
+			REQUIRE( r );
+			REQUIRE( *r );
+			REQUIRE( 42 == **r );
+		},
+		5 );
+}
+
@@ -0,0 +1,170 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN 
+#include <doctest/doctest.h>
+
+#include <so_5_extra/sync/pub.hpp>
+
+#include <so_5/all.hpp>
+
+#include <test/3rd_party/various_helpers/time_limited_execution.hpp>
+
+namespace sync_ns = so_5::extra::sync;
+
+using namespace std::chrono_literals;
+
+using ask_t = sync_ns::request_reply_t<int, int>;
+using ask_length_t = sync_ns::request_reply_t<std::string, std::size_t>;
+
+class service_t final : public so_5::agent_t
+	{
+		struct delayed_request final : public so_5::message_t
+			{
+				ask_t::holder_t m_request;
+
+				delayed_request( ask_t::holder_t request )
+					:	m_request{ std::move(request) }
+				{}
+			};
+
+	public :
+		service_t( context_t ctx ) : so_5::agent_t{ std::move(ctx) }
+			{
+				so_subscribe_self()
+					.event( &service_t::on_request )
+					.event( &service_t::on_length_request )
+					.event( &service_t::on_delayed_request );
+			}
+
+	private :
+		void
+		on_request( ask_t::request_mhood_t cmd )
+			{
+				const int v = cmd->request();
+				if( v < 0 )
+					// The request will be destroyed without a reply.
+					return;
+
+				if( 0 == v )
+					so_5::send_delayed< so_5::mutable_msg< delayed_request > >(
+							*this,
+							200ms,
+							cmd.make_holder() );
+				else
+					cmd->make_reply( v * 2 );
+			}
+
+		void
+		on_length_request( ask_length_t::request_mhood_t cmd )
+			{
+				cmd->make_reply( cmd->request().size() );
+			}
+
+		void
+		on_delayed_request( mutable_mhood_t< delayed_request > cmd )
+			{
+				cmd->m_request->make_reply( -1 );
+			}
+	};
+
+TEST_CASE( "reuse of reply slots" )
+{
+	run_with_time_limit( [] {
+			so_5::wrapped_env_t sobj;
+
+			auto svc = sobj.environment().introduce_coop(
+					[]( so_5::coop_t & coop ) {
+						return coop.make_agent< service_t >()->so_direct_mbox();
+					} );
+
+			sync_ns::reply_slot_cache_t cache;
+
+			for( int i = 1; i != 100; ++i )
+				{
+					REQUIRE( i * 2 == ask_t::ask_value( cache, svc, 5s, i ) );
+					REQUIRE( 1u == cache.size() );
+				}
+
+			REQUIRE( 6 == sync_ns::request_reply< int, int >( cache, svc, 5s, 3 ) );
+			REQUIRE( 1u == cache.size() );
+		},
+		5 );
+}
+
+TEST_CASE( "request without reply" )
+{
+	run_with_time_limit( [] {
+			so_5::wrapped_env_t sobj;
+
+			auto svc = sobj.environment().introduce_coop(
+					[]( so_5::coop_t & coop ) {
+						return coop.make_agent< service_t >()->so_direct_mbox();
+					} );
+
+			sync_ns::reply_slot_cache_t cache;
+
+			// The waiting should be finished before the timeout.
+			REQUIRE( !ask_t::ask_opt_value( cache, svc, 1h, -1 ) );
+			// The slot was abandoned by the request and can be reused.
+			REQUIRE( 1u == cache.size() );
+
+			REQUIRE( 4 == ask_t::ask_value( cache, svc, 5s, 2 ) );
+			REQUIRE( 1u == cache.size() );
+		},
+		5 );
+}
+
+TEST_CASE( "late reply is not leaked" )
+{
+	run_with_time_limit( [] {
+			so_5::wrapped_env_t sobj;
+
+			auto svc = sobj.environment().introduce_coop(
+					[]( so_5::coop_t & coop ) {
+						return coop.make_agent< service_t >()->so_direct_mbox();
+					} );
+
+			sync_ns::reply_slot_cache_t cache;
+
+			// The reply will be sent after 200ms.
+			REQUIRE( !ask_t::ask_opt_value( cache, svc, 50ms, 0 ) );
+			// The slot can't be reused.
+			REQUIRE( 0u == cache.size() );
+
+			REQUIRE( 2 == ask_t::ask_value( cache, svc, 5s, 1 ) );
+
+			// Wait for the late reply.
+			std::this_thread::sleep_for( 300ms );
+
+			REQUIRE( 10 == ask_t::ask_value( cache, svc, 5s, 5 ) );
+			REQUIRE( 1u == cache.size() );
+		},
+		5 );
+}
+
+
+TEST_CASE( "different types of replies" )
+{
+	run_with_time_limit( [] {
+			so_5::wrapped_env_t sobj;
+
+			auto svc = sobj.environment().introduce_coop(
+					[]( so_5::coop_t & coop ) {
+						return coop.make_agent< service_t >()->so_direct_mbox();
+					} );
+
+			sync_ns::reply_slot_cache_t cache;
+
+			REQUIRE( 2 == ask_t::ask_value( cache, svc, 5s, 1 ) );
+			REQUIRE( 1u == cache.size() );
+
+			// A slot for int can't be used for std::size_t.
+			REQUIRE( 3u == ask_length_t::ask_value(
+					cache, svc, 5s, std::string{ "abc" } ) );
+			REQUIRE( 2u == cache.size() );
+
+			REQUIRE( 4 == ask_t::ask_value( cache, svc, 5s, 2 ) );
+			REQUIRE( 5u == ask_length_t::ask_value(
+					cache, svc, 5s, std::string{ "abcde" } ) );
+			REQUIRE( 2u == cache.size() );
+		},
+		5 );
+}